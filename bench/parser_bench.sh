@@ -0,0 +1,49 @@
+#!/bin/sh
+# Parser benchmark: generates sources with very long expressions and long
+# argument lists, then times lexing + parsing only (--parse-only).
+# Usage: sh bench/parser_bench.sh [path/to/morphc] [terms]
+
+MORPHC=${1:-./morphc}
+TERMS=${2:-200000}
+TMP=${TMPDIR:-/tmp}/morph_bench_$$
+mkdir -p "$TMP"
+trap 'rm -rf "$TMP"' EXIT
+
+# One expression: 1 + 2 * 3 - 4 ... mixing precedence levels
+awk -v n="$TERMS" 'BEGIN {
+    printf "biar x = 0";
+    for (i = 1; i <= n; i++) printf " %s %d", substr("+-*/<>", (i % 6) + 1, 1), i;
+    print "";
+}' > "$TMP/long_expr.fox"
+
+# Left-associative chain of a single operator: a + a + a ...
+awk -v n="$TERMS" 'BEGIN {
+    printf "biar y = a";
+    for (i = 1; i <= n; i++) printf " + a";
+    print "";
+}' > "$TMP/long_chain.fox"
+
+# Call with a very long argument list
+awk -v n="$TERMS" 'BEGIN {
+    printf "f(0";
+    for (i = 1; i <= n; i++) printf ", %d", i;
+    print ")";
+}' > "$TMP/long_args.fox"
+
+# Deeply parenthesized prefix (grouping recurses once per level)
+awk -v n=2000 'BEGIN {
+    printf "biar z = ";
+    for (i = 0; i < n; i++) printf "(";
+    printf "1";
+    for (i = 0; i < n; i++) printf " + 1)";
+    print "";
+}' > "$TMP/nested.fox"
+
+for f in long_expr long_chain long_args nested; do
+    size=$(wc -c < "$TMP/$f.fox")
+    start=$(date +%s.%N)
+    "$MORPHC" --parse-only "$TMP/$f.fox" || { echo "$f: GAGAL"; continue; }
+    end=$(date +%s.%N)
+    awk -v f="$f" -v size="$size" -v s="$start" -v e="$end" \
+        'BEGIN { printf "%-10s %9d byte  %.3f s\n", f, size, e - s }'
+done
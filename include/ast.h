@@ -1,29 +1,65 @@
 #ifndef AST_H
 #define AST_H
 
+#include <stdint.h>
 #include "lexer.h"
 
+struct ObjString; // Pinned runtime constant for string literals (gc.h)
+struct Value;     // Runtime value (env.h)
+struct NativeDef; // Registered C function (builtins.h)
+struct Code;      // Closure-compiled form (compiler.h)
+struct JitCode;   // Native code for hot functions (jit.h)
+
 typedef enum {
     NODE_PROGRAM,
     NODE_BLOCK,
     NODE_VAR_DECL,
     NODE_PRINT,
     NODE_IF,
+    NODE_REPEAT,  // ulang i dari a sampai b maka ... akhir
+    NODE_WHILE,   // selama cond maka ... akhir
 
     // Expressions
     NODE_LITERAL,
     NODE_VAR_ACCESS,
     NODE_BINARY_EXPR,
     NODE_CALL_EXPR,
+    NODE_LIST,    // [a, b, c]
+    NODE_MAP,     // {k: v, ...}
+    NODE_INDEX,   // xs[i], m[k]
+    NODE_INTERP,  // "teks {expr} teks"
 
     // Functions
     NODE_FUNC_DECL,
     NODE_RETURN
 } NodeType;
 
+// Result of static type inference (infer.h). STATIC_INT expressions are
+// proven to always yield a number: an integer unless arithmetic overflowed
+// into a decimal. Engines may evaluate them unboxed, on raw Nums (num.h).
+typedef enum {
+    STATIC_UNKNOWN,
+    STATIC_INT
+} StaticType;
+
+// Specialized forms the tree walker rewrites a node into once it has seen
+// it run (evaluator.c). 'type' and the generic fields stay as parsed, so
+// every other pass ignores these, and a failed guard just sets the node back
+// to QUICK_NONE.
+typedef enum {
+    QUICK_NONE,
+    QUICK_INT_BINARY, // BinaryExpr that has only seen integer operands
+    QUICK_GLOBAL,     // VarAccess bound to a global slot
+    QUICK_CALL,       // CallExpr to the user function in a global slot
+    QUICK_CALL_NATIVE // CallExpr to the native in a global slot
+} QuickKind;
+
 typedef struct ASTNode {
     NodeType type;
     struct ASTNode *next;
+    unsigned char static_type; // StaticType, set by infer_types()
+    unsigned char quick;       // QuickKind
+    unsigned char deopts;      // Guard failures so far
 } ASTNode;
 
 // --- Expressions ---
@@ -32,12 +68,15 @@ typedef struct {
     ASTNode base;
     TokenType type;
     char *string_val;
-    int int_val;
+    struct ObjString *string_obj; // Shared by every evaluation of this literal
+    int64_t int_val;
+    double decimal_val;           // TOKEN_DECIMAL
 } LiteralNode;
 
 typedef struct {
     ASTNode base;
     char *name;
+    struct Value *global; // QUICK_GLOBAL
 } VarAccessNode;
 
 typedef struct {
@@ -51,8 +90,34 @@ typedef struct {
     ASTNode base;
     char *callee;
     ASTNode *arguments; // Linked list of expressions
+    struct Value *global;             // QUICK_CALL and QUICK_CALL_NATIVE: the callee's slot
+    struct ASTNode *target;           // QUICK_CALL: FuncDeclNode it held
+    const struct NativeDef *native;   // QUICK_CALL_NATIVE: native it held
+    int argc;                         // QUICK_CALL: arguments passed, clamped to the parameters
 } CallExprNode;
 
+typedef struct {
+    ASTNode base;
+    ASTNode *elements; // Linked list of expressions
+} ListNode;
+
+typedef struct {
+    ASTNode base;
+    ASTNode *keys;   // Parallel linked lists, in source order
+    ASTNode *values;
+} MapNode;
+
+typedef struct {
+    ASTNode base;
+    ASTNode *target;
+    ASTNode *index;
+} IndexNode;
+
+typedef struct {
+    ASTNode base;
+    ASTNode *parts; // Linked list: string literals and embedded expressions, in order
+} InterpNode;
+
 // --- Statements ---
 
 typedef struct {
@@ -82,6 +147,20 @@ typedef struct {
     ASTNode *then_branch;
 } IfNode;
 
+typedef struct {
+    ASTNode base;
+    char *var_name;
+    ASTNode *start;
+    ASTNode *end;    // Inclusive, evaluated once before the first iteration
+    ASTNode *body;   // BlockNode
+} RepeatNode;
+
+typedef struct {
+    ASTNode base;
+    ASTNode *condition;
+    ASTNode *body;   // BlockNode
+} WhileNode;
+
 // --- Functions ---
 
 typedef struct {
@@ -89,6 +168,19 @@ typedef struct {
     char *name;
     ASTNode *params; // Linked list of VarAccessNode (abusing it for param names) or similar
     ASTNode *body;   // BlockNode
+    struct Code *compiled; // Cached by the closure engine on first call
+    int call_count;        // JIT hotness counter
+    int jit_state;         // JitState
+    int deopt_count;
+    struct JitCode *jit;
+    const unsigned char *image_body; // Still encoded in a snapshot image (snapshot.h)
+    const char *lazy_body;           // Source of a body not parsed yet (parser.h)
+    size_t lazy_length;
+    int lazy_line;
+    char **lazy_uses;      // Names that body mentions, sorted, for optimize.c
+    int lazy_use_count;
+    char **captures;       // Variables of enclosing functions it uses (resolve.h)
+    int capture_count;
 } FuncDeclNode;
 
 typedef struct {
@@ -103,13 +195,20 @@ ASTNode* new_block(ASTNode *stmts);
 ASTNode* new_var_decl(const char *name, ASTNode *val);
 ASTNode* new_print(ASTNode *expr);
 ASTNode* new_if(ASTNode *cond, ASTNode *then_block);
+ASTNode* new_repeat(const char *var_name, ASTNode *start, ASTNode *end, ASTNode *body);
+ASTNode* new_while(ASTNode *cond, ASTNode *body);
 
 ASTNode* new_literal_string(const char *val);
-ASTNode* new_literal_number(int val);
+ASTNode* new_literal_number(int64_t val);
+ASTNode* new_literal_decimal(double val);
 ASTNode* new_var_access(const char *name);
 
 ASTNode* new_binary_expr(ASTNode *left, TokenType op, ASTNode *right);
 ASTNode* new_call_expr(const char *callee, ASTNode *args);
+ASTNode* new_list(ASTNode *elements);
+ASTNode* new_map(ASTNode *keys, ASTNode *values);
+ASTNode* new_index(ASTNode *target, ASTNode *index);
+ASTNode* new_interp(ASTNode *parts);
 
 ASTNode* new_func_decl(const char *name, ASTNode *params, ASTNode *body);
 ASTNode* new_return(ASTNode *val);
@@ -117,6 +216,63 @@ ASTNode* new_return(ASTNode *val);
 // Helpers
 ASTNode* append_node(ASTNode *head, ASTNode *node); // Helper to append to linked list
 
+// List builder that keeps a tail pointer, so each append is O(1)
+typedef struct {
+    ASTNode *head;
+    ASTNode *tail;
+} NodeList;
+
+void node_list_push(NodeList *list, ASTNode *node); // NULL nodes are ignored
+
 void free_ast(ASTNode *node);
 
+// Calls 'visit' once for every node reachable from 'root' (its successors,
+// function bodies and parameters included), in no particular order
+typedef void (*VisitFn)(void *ctx, ASTNode *node);
+void ast_visit(ASTNode *root, VisitFn visit, void *ctx);
+
+// --- Bindings ---
+
+// Calls 'bind' for each name a statement list binds, in source order: 'biar',
+// function declarations and loop variables, in nested blocks too since
+// blocks do not open scopes, but not inside function bodies. 'binder' is the
+// VarDeclNode, FuncDeclNode or RepeatNode that binds it.
+typedef void (*BindingFn)(void *ctx, ASTNode *binder, const char *name);
+void walk_bindings(ASTNode *stmts, BindingFn bind, void *ctx);
+
+// Unordered names without duplicates, for the bindings of one function body
+typedef struct {
+    const char **items;
+    int count;
+    int capacity;
+} NameSet;
+
+int name_set_has(const NameSet *set, const char *name);
+void name_set_add(NameSet *set, const char *name);
+void name_set_collect(NameSet *set, ASTNode *stmts); // Everything 'stmts' binds
+
+// Sorted, deduplicated names with a count each, for whole-program questions
+// ("how often is this bound / used") on programs with many functions
+typedef struct {
+    const char *name;
+    int count;
+} NameCount;
+
+typedef struct {
+    NameCount *items;
+    int count;
+    int capacity;
+} NameTable;
+
+void name_table_push(NameTable *t, const char *name);
+void name_table_finish(NameTable *t); // Sorts and merges duplicates into counts
+NameCount* name_table_find(const NameTable *t, const char *name);
+int name_table_count(const NameTable *t, const char *name);
+void name_table_collect(NameTable *t, ASTNode *stmts); // Once per binding in 'stmts'
+// Once per use as a call target or a value, function bodies included (a
+// lazy one by the names the parser saw in it). Uses of 'self' are left out
+// unless it is NULL.
+void name_table_collect_uses(NameTable *t, ASTNode *stmts, const char *self);
+void name_table_collect_function_uses(NameTable *t, FuncDeclNode *f, const char *self);
+
 #endif
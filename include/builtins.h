@@ -0,0 +1,24 @@
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include "env.h"
+
+// Functions implemented in C, exposed to Morph as VAL_NATIVE values bound in
+// the global environment (so a user 'fungsi' or 'biar' of the same name
+// shadows them). A call passes the evaluated, GC-rooted arguments as a plain
+// array: no Environment is created. Returns 0 after reporting a runtime error.
+typedef int (*NativeFn)(Value *args, int argc, Value *out);
+
+typedef struct NativeDef {
+    const char *name;
+    NativeFn fn;
+} NativeDef;
+
+// Extension point for library modules, called from their init function in
+// builtins.c's module list. Returns 0 when the table is full.
+int native_register(const char *name, NativeFn fn);
+
+void natives_install(Environment *env); // Binds every registered native
+const NativeDef* native_lookup(const char *name);
+
+#endif
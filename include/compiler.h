@@ -0,0 +1,21 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include "ast.h"
+#include "env.h"
+
+// Closure-compilation engine: every AST node is converted once into a Code
+// node holding a C function pointer and its pre-decoded operands, so running
+// a program is a chain of direct calls with no dispatch on node->type.
+
+typedef struct Code Code;
+
+Code* compile_program(ASTNode *program);
+void run_compiled(Code *code, Environment *env);
+
+// Calls a user function on evaluated arguments, which the caller keeps rooted
+// along with 'closure' (NULL for a plain function)
+void compiled_call(FuncDeclNode *decl, struct ObjClosure *closure, Value *args, int argc, Value *out);
+void cleanup_compiler();
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef EMIT_C_H
+#define EMIT_C_H
+
+#include <stdio.h>
+#include "ast.h"
+
+// Ahead-of-time translation of a parsed program into a standalone C file
+// that links against runtime/morph_rt.c. All names are resolved statically,
+// so the output performs no environment lookups; functions that only ever
+// compute on integers additionally get a plain 'int' C twin.
+// Returns 0 on success, non-zero if the program uses an unsupported construct.
+int emit_c(ASTNode *program, FILE *out);
+
+#endif
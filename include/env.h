@@ -2,21 +2,49 @@
 #define ENV_H
 
 #include <stdlib.h>
+#include <stdint.h>
 
 typedef enum {
     VAL_NUMBER,
     VAL_STRING,
     VAL_FUNCTION, // New: Function Value
-    VAL_NULL
+    VAL_LIST,
+    VAL_MAP,
+    VAL_NATIVE,   // C function (builtins.h)
+    VAL_READER,   // Line reader over stdin or a file
+    VAL_NULL,
+    VAL_CLOSURE,  // Function with captured variables (ObjClosure)
+    VAL_DECIMAL,  // Double: decimal literals, and integer results that overflowed (num.h)
+    VAL_UNBOUND   // Left in an entry by env_unbind, never seen by programs
 } ValueType;
 
 struct ASTNode; // Forward declaration
+struct ObjString; // GC-managed string (gc.h)
+struct ObjList;   // GC-managed list (gc.h)
+struct ObjMap;    // GC-managed hash map (gc.h)
+struct NativeDef; // Registered C function (builtins.h)
+struct ObjReader; // GC-managed line reader (gc.h)
+struct ObjClosure; // GC-managed function + captured values (gc.h)
+
+// Strings up to VALUE_INLINE_MAX bytes are stored inside the Value itself:
+// their bytes start at inline_chars and run on into 'as', so building one
+// allocates nothing. Longer strings (and views) live in an ObjString.
+// Read string bytes through string_chars()/string_length() (gc.h).
+#define VALUE_INLINE_MAX 14
 
 typedef struct Value {
-    ValueType type;
+    unsigned char type;         // ValueType, a byte so short strings fit beside it
+    unsigned char inline_len;   // VAL_STRING: length + 1 when inline, 0 for an ObjString
+    char inline_chars[6];
     union {
-        int number;
-        char *string;
+        int64_t number;
+        double decimal;
+        struct ObjString *string;
+        struct ObjList *list;
+        struct ObjMap *map;
+        const struct NativeDef *native; // Static storage, not GC-managed
+        struct ObjReader *reader;
+        struct ObjClosure *closure;
         struct { // Function closure/pointer
             struct ASTNode *declaration; // Point to FuncDeclNode
         } function;
@@ -32,6 +60,8 @@ typedef struct Entry {
 typedef struct Environment {
     Entry *head;
     struct Environment *parent; // Parent Scope
+    struct Environment *prev_live; // Live list, traced as GC roots
+    struct Environment *next_live;
 } Environment;
 
 // Environment functions
@@ -39,12 +69,32 @@ Environment* env_create(Environment *parent);
 void env_free(Environment *env);
 void env_set(Environment *env, const char *key, Value value);
 int env_get(Environment *env, const char *key, Value *out_value);
+int env_get_local(Environment *env, const char *key, Value *out_value); // This scope only
+// Storage of the nearest binding and the scope holding it, NULL if unbound;
+// stable until that scope's env_free
+Value* env_find(Environment *env, const char *key, Environment **owner);
+Value* env_slot(Environment *env, const char *key); // Own-scope storage, stable until env_free
+void env_push(Environment *env, const char *key, Value value); // No existing-key scan: shadows an older binding
+// Lookups find no binding until the next env_set. The entry stays, so
+// storage already handed out stays valid and reads VAL_UNBOUND.
+void env_unbind(Environment *env, const char *key);
+void env_mark_live(); // Marks every value held by a live environment
+Environment* env_live_list(void); // This thread's live environments, for a GC safepoint
+void env_mark_list(Environment *list); // Same as env_mark_live for another thread's list
 
 // Value helpers
-Value make_number(int n);
+Value make_number(int64_t n);
+Value make_decimal(double d);
 Value make_string(const char *s);
+Value make_string_obj(struct ObjString *s);
+Value make_string_n(const char *chars, size_t length); // Inline when short, else copied to the heap
+Value make_string_slice(struct ObjString *source, size_t offset, size_t length); // Inline or a view
+Value make_list(struct ObjList *l);
+Value make_map(struct ObjMap *m);
 Value make_function(struct ASTNode *decl);
+Value make_native(const struct NativeDef *def);
+Value make_reader(struct ObjReader *r);
+Value make_closure(struct ObjClosure *c);
 Value make_null();
-void free_value(Value v);
 
 #endif
@@ -1,10 +1,61 @@
 #ifndef EVALUATOR_H
 #define EVALUATOR_H
 
+#include <stdio.h>
 #include "ast.h"
+#include "env.h"
+
+typedef enum {
+    ENGINE_TREE,    // Switch-based tree walker (default)
+    ENGINE_CLOSURE  // Pre-resolved closure tree (compiler.c)
+} EngineKind;
 
 void init_evaluator();
+void set_engine(EngineKind kind);
+void evaluator_set_quickening(int enabled); // Self-specializing tree-walker nodes, on by default
 void evaluate(ASTNode *node);
 void cleanup_evaluator();
 
+// Runtime shared by every engine
+Environment* evaluator_global_env();
+Value eval_binary_op(Value left, TokenType op, Value right);
+int value_is_truthy(Value v);
+void print_value(Value v);
+void write_value(Value v, FILE *out); // Literal form, no newline
+int index_value(Value target, Value index, Value *out); // 0 after reporting an error
+Value join_values(const Value *parts, int count); // Interpolated string from rooted parts
+
+// Calls a function or native value on evaluated, rooted arguments; extra
+// arguments are ignored. Returns 0 after reporting an error.
+int evaluator_call_value(Value callee, Value *args, int argc, Value *out_val);
+
+// Closures: the value a 'fungsi' statement binds in 'env'. A function with
+// captures (resolve.h) copies their current values out of env's own frame;
+// one naming a later 'fungsi' of the same block gets it once that is bound.
+Value evaluator_make_function(FuncDeclNode *decl, Environment *env);
+void evaluator_bind_captures(Environment *func_env, struct ObjClosure *closure);
+
+// Sets up a parallel worker thread: its own return state, tree walker only
+void evaluator_init_worker(void);
+
+// Registers the task natives (jalankan, serahkan, tunggu); see builtins.c
+void evaluator_register_natives(void);
+
+// Blocking input calls this first. While tasks are alive it parks the caller
+// until 'fd' is readable and runs the others meanwhile; otherwise it returns
+// at once and the read simply blocks.
+void evaluator_wait_readable(int fd);
+
+// Before statements are freed while other code lives on (repl.c): release
+// drops what engines built for their functions, and forget makes the calls
+// in 'stmts' stop comparing against declarations by address, which a new
+// declaration could now reuse
+void evaluator_release_code(ASTNode *stmts);
+void evaluator_forget_targets(ASTNode *stmts);
+
+// Tree-walker fallbacks for nodes an engine does not specialize.
+// evaluator_exec_node returns 1 and fills ret_val when a 'kembali' fired.
+int evaluator_eval_node(ASTNode *node, Environment *env, Value *out_val);
+int evaluator_exec_node(ASTNode *node, Environment *env, Value *ret_val);
+
 #endif
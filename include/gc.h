@@ -0,0 +1,179 @@
+#ifndef GC_H
+#define GC_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "env.h"
+
+// Heap objects. Every runtime value that owns memory lives behind an Obj
+// header and is reclaimed by the mark-sweep collector; Values only hold
+// borrowed pointers, so copying a Value never copies its payload.
+
+typedef enum {
+    OBJ_STRING,
+    OBJ_LIST,
+    OBJ_MAP,
+    OBJ_READER,
+    OBJ_CLOSURE
+} ObjType;
+
+typedef struct Obj {
+    ObjType type;
+    unsigned char marked;
+    unsigned char pinned;   // Owned by the AST (e.g. string literals), never swept
+    struct Obj *next;       // All objects are threaded through the heap list
+} Obj;
+
+// A string either owns its bytes (stored inline right after the header and
+// NUL-terminated) or is a view: a slice of another string's bytes, kept
+// alive through 'owner'. Views are not NUL-terminated, so always use length.
+typedef struct ObjString {
+    Obj obj;
+    size_t length;
+    unsigned hash;   // Computed on first use as a map key, 0 = not yet
+    char *chars;
+    struct ObjString *owner; // NULL unless this is a view
+} ObjString;
+
+// Growable contiguous list. While every element is an integer the payload
+// is an unboxed int64_t array, so bulk builtins run as plain loops over it;
+// the first other value (decimals included) converts it to boxed Values for
+// good.
+typedef struct ObjList {
+    Obj obj;
+    int count;
+    int capacity;
+    int numeric;
+    union {
+        int64_t *numbers;
+        Value *items;
+    } as;
+} ObjList;
+
+// Open-addressing hash map. Entries are stored densely in insertion order
+// and carry their hash; the index table is a power-of-two array of entry
+// positions probed linearly, so a lookup touches one int array and then a
+// single entry. Deleted entries keep their key set to null until the next
+// rebuild compacts them away.
+typedef struct {
+    Value key;
+    Value value;
+    unsigned hash;
+} MapEntry;
+
+typedef struct ObjMap {
+    Obj obj;
+    int count;          // Live entries
+    int entry_count;    // Used entry slots, including deleted ones
+    int entry_capacity;
+    MapEntry *entries;
+    int index_capacity; // Power of two, at least 2 * entry_capacity
+    int *index;         // -1 = empty, otherwise a position in entries
+} ObjMap;
+
+// Line reader over a FILE. Input is read into large chunk strings and lines
+// are returned as views into them, so reading a line copies no bytes; a
+// chunk is freed by the GC once no line from it is reachable.
+typedef struct ObjReader {
+    Obj obj;
+    FILE *file;        // NULL once closed
+    int owns_file;     // 0 for stdin
+    int eof;
+    ObjString *chunk;  // Current buffer, NULL before the first read
+    size_t pos;        // Next unread byte in chunk
+    size_t end;        // Valid bytes in chunk
+} ObjReader;
+
+// A function declared inside another one, with the values of the
+// variables it captures (names in declaration->captures, same order). They
+// are copied when the 'fungsi' statement runs, so the enclosing call's
+// environment is not kept alive.
+typedef struct ObjClosure {
+    Obj obj;
+    struct ASTNode *declaration; // FuncDeclNode
+    int count;
+    Value captured[];
+} ObjClosure;
+
+// String values, inline or heap
+static inline const char* string_chars(const Value *v) {
+    // Addressed from the whole Value: the bytes continue past inline_chars
+    return v->inline_len ? (const char*)v + offsetof(Value, inline_chars) : v->as.string->chars;
+}
+
+static inline size_t string_length(const Value *v) {
+    return v->inline_len ? (size_t)(v->inline_len - 1) : v->as.string->length;
+}
+
+// Allocation
+ObjString* gc_new_string(const char *chars, size_t length);
+ObjString* gc_alloc_string(size_t length); // chars left uninitialized, NUL-terminated
+ObjString* gc_new_view(ObjString *source, size_t offset, size_t length);
+ObjList* gc_new_list(int capacity, int numeric);
+ObjMap* gc_new_map(void); // Empty, storage is reserved by map.c
+ObjReader* gc_new_reader(FILE *file, int owns_file);
+ObjClosure* gc_new_closure(struct ASTNode *declaration, int count); // Captures start null
+void gc_account(long delta); // Out-of-line payload growth (e.g. list arrays)
+
+void gc_pin(Obj *obj);
+void gc_unpin(Obj *obj);
+
+// Roots
+void gc_add_root(Value *slot);      // Long-lived slot such as last_return_value
+void gc_push_root(Value value);     // Evaluation stack for in-flight temporaries
+void gc_pop_roots(int count);
+
+// Coroutines: every task owns an evaluation stack. The scheduler swaps the
+// active one on each switch ('save' receives the outgoing stack) and marks
+// the stacks of suspended tasks from a root marker.
+typedef struct GcRootStack {
+    Value *values;
+    int count;
+    int capacity;
+} GcRootStack;
+
+void gc_swap_root_stack(GcRootStack *save, const GcRootStack *load);
+void gc_add_root_marker(void (*mark)(void)); // Called at the start of every collection
+
+// Parallel regions (parallel.c, parser.c). Between begin and end, called on
+// the main thread while the workers are idle, any thread may allocate:
+// allocation never collects and new objects go to a per-thread list, which
+// gc_parallel_flush hands to the heap. It returns 1 once the heap has
+// crossed the collection threshold.
+//
+// A region can still collect at a safepoint: every other thread flushes,
+// publishes its roots with gc_parallel_publish and stops, then the main
+// thread calls gc_parallel_collect. Both are called under the caller's
+// safepoint lock.
+typedef struct GcThreadRoots {
+    Value *values;              // The thread's evaluation stack
+    int count;
+    Environment *envs;          // and its live environments
+    struct GcThreadRoots *next;
+} GcThreadRoots;
+
+void gc_parallel_begin(void);
+int gc_parallel_flush(void);
+int gc_parallel_flush_due(void); // This thread's private list has outgrown its budget
+void gc_parallel_publish(GcThreadRoots *roots); // 'roots' must stay put until the collection
+void gc_parallel_collect(void); // Main thread, with every published thread stopped
+void gc_parallel_end(void);
+void gc_thread_shutdown(void); // Frees a worker thread's evaluation stack
+
+// Marking (used by root providers)
+void gc_mark_value(Value value);
+void gc_mark_object(Obj *obj);
+
+// Collection
+void gc_collect(void);
+// Collects, calling 'found' with the declaration of every function value
+// and closure still reachable, possibly more than once each (repl.c frees
+// replaced code nothing refers to any more)
+void gc_find_declarations(void (*found)(void *ctx, struct ASTNode *decl), void *ctx);
+void gc_shutdown(void);
+
+// Tuning & statistics
+void gc_set_growth_factor(double factor);
+void gc_print_stats(FILE *out);
+
+#endif
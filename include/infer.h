@@ -0,0 +1,21 @@
+#ifndef INFER_H
+#define INFER_H
+
+#include <stdio.h>
+#include "ast.h"
+#include "env.h"
+
+// Whole-program static type inference. Proves which expressions always
+// evaluate to a number and marks them STATIC_INT, so the tree walker and the
+// closure engine compute them unboxed: no Value per operand, no tag check,
+// no eval_binary_op dispatch. Parameters are typed from every call site of a
+// function that is bound once and never used as a value; everything the
+// analysis cannot see (natives, escaping functions, globals loaded from an
+// image) stays unknown, and while some function body is not parsed yet
+// (parser.h) its calls are unseen, so no parameter is typed. 'globals' is
+// the environment the program will start in; a native is trusted only if it
+// is still bound there under its name.
+// When 'dump' is non-NULL the specialized expressions are listed there.
+void infer_types(ASTNode *program, Environment *globals, FILE *dump);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "ast.h"
+#include "env.h"
+
+// Baseline JIT for hot integer functions (x86-64 Linux only).
+//
+// Every interpreted call to a FuncDeclNode is counted. Once a function has
+// been called JIT_HOT_THRESHOLD times, always with integer arguments, and its
+// body only uses parameters, arithmetic, comparisons, 'jika', 'kembali' and
+// calls to itself, it is compiled to native code in mmap'd executable memory.
+// Guards (argument types, 64-bit overflow, division by zero, falling off the
+// end) bail out and the call is re-run by the interpreter; such bodies are
+// side-effect free.
+
+#define JIT_HOT_THRESHOLD 100
+#define JIT_MAX_PARAMS 6
+#define JIT_MAX_DEOPTS 16 // Give up on a function that keeps bailing out
+
+typedef enum {
+    JIT_COLD,       // Still counting calls
+    JIT_COMPILED,
+    JIT_REJECTED    // Unsupported body, type-unstable, or deoptimized too often
+} JitState;
+
+typedef struct JitCode JitCode;
+
+void jit_set_enabled(int enabled);
+// For parallel worker threads: call counters, compilation and the bailout
+// flag belong to the main thread, so workers always interpret
+void jit_disable_thread(void);
+void jit_set_dump(int dump);
+
+// Counts the call and runs native code when available. Returns 1 and fills
+// out_val on success; 0 means the caller must interpret the call with the
+// same (already evaluated) arguments.
+int jit_try_call(FuncDeclNode *decl, Value *args, int argc, Value *out_val);
+
+void jit_release(FuncDeclNode *decl); // Before the declaration is freed
+void cleanup_jit();
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <stddef.h>
+
 typedef enum {
     TOKEN_EOF,
 
@@ -14,10 +16,13 @@ typedef enum {
     TOKEN_KEMBALI,
     TOKEN_DAN,
     TOKEN_ATAU,
+    TOKEN_ULANG,
+    TOKEN_SELAMA,
 
     // Literals
     TOKEN_STRING,
     TOKEN_NUMBER,
+    TOKEN_DECIMAL,   // 1.5
     TOKEN_IDENTIFIER,
 
     // Operators & Punctuation
@@ -29,6 +34,11 @@ typedef enum {
     TOKEN_LPAREN,    // (
     TOKEN_RPAREN,    // )
     TOKEN_COMMA,     // ,
+    TOKEN_LBRACKET,  // [
+    TOKEN_RBRACKET,  // ]
+    TOKEN_LBRACE,    // {
+    TOKEN_RBRACE,    // }
+    TOKEN_COLON,     // :
 
     // Comparison
     TOKEN_EQ_EQ,     // ==
@@ -47,8 +57,28 @@ typedef struct {
     int line;
 } Token;
 
+// Everything the lexer is in the middle of, so it can lex another source
+// (an interpolated '{...}') and then resume
+typedef struct {
+    const char *src;
+    size_t src_len;
+    int pos;
+    int line;
+    Token current_token;
+    int token_consumed;
+} LexerState;
+
 void init_lexer(const char *source);
+void init_lexer_at(const char *source, int line); // Numbers lines from 'line'
+void init_lexer_span(const char *source, size_t length, int line); // Only source[0, length)
+void lexer_save(LexerState *state);
+void lexer_restore(const LexerState *state);
 Token next_token();
 Token peek_token();
+TokenType skip_token(); // next_token without copying the text
+// skip_token that also points 'text' at the token's source (a string
+// literal without its quotes, not NUL-terminated); only with no token peeked
+TokenType skip_token_text(const char **text, int *length);
+const char* lexer_mark(int *line); // Where scanning resumes; only with no token peeked
 
 #endif
@@ -0,0 +1,14 @@
+#ifndef LIST_H
+#define LIST_H
+
+#include "gc.h"
+
+// Operations on ObjList. None of these allocate GC objects, so callers only
+// need to root the list itself across allocations they make in between.
+
+ObjList* list_new(int capacity);                 // Empty, unboxed (numeric) storage
+void list_append(ObjList *list, Value value);    // Boxes the storage on the first non-number
+int list_get(ObjList *list, int64_t index, Value *out); // 0 when out of range
+Value* list_boxed_items(ObjList *list);          // Forces boxed storage
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef MAP_H
+#define MAP_H
+
+#include "gc.h"
+
+// Operations on ObjMap. Keys are numbers or strings (compared by content).
+// None of these allocate GC objects.
+
+ObjMap* map_new(int capacity);
+int map_valid_key(Value key);
+int map_get(ObjMap *map, Value key, Value *out);     // 0 when absent
+void map_set(ObjMap *map, Value key, Value value);   // Key must be valid
+int map_delete(ObjMap *map, Value key);              // 0 when absent
+
+#endif
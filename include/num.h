@@ -0,0 +1,140 @@
+#ifndef NUM_H
+#define NUM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "env.h"
+#include "lexer.h"
+
+// Numeric tower: 64-bit integers (VAL_NUMBER) and decimals (VAL_DECIMAL,
+// doubles). Integer arithmetic is exact or not done at all: when the result
+// does not fit in 64 bits the operation yields the decimal result instead of
+// wrapping. A decimal operand makes the operation decimal. Integer '/'
+// truncates toward zero; dividing by zero is an error. Comparisons give the
+// integers 0 or 1.
+//
+// These helpers are shared by every engine. Raw paths that never box keep a
+// Num plus the NumKind saying which member is live.
+
+typedef union {
+    int64_t i;
+    double d;
+} Num;
+
+typedef enum {
+    NUM_FAIL,    // Error, already reported
+    NUM_INT,
+    NUM_DECIMAL,
+    NUM_NULL     // No number (a reported error left null): boxes as null
+} NumKind;
+
+static inline void num_report_division_by_zero(void) {
+    fprintf(stderr, "Runtime Error: Pembagian dengan nol.\n");
+}
+
+static inline NumKind num_int_op(int64_t l, TokenType op, int64_t r, Num *out) {
+    switch (op) {
+        case TOKEN_PLUS:
+            if (!__builtin_add_overflow(l, r, &out->i)) return NUM_INT;
+            out->d = (double)l + (double)r;
+            return NUM_DECIMAL;
+        case TOKEN_MINUS:
+            if (!__builtin_sub_overflow(l, r, &out->i)) return NUM_INT;
+            out->d = (double)l - (double)r;
+            return NUM_DECIMAL;
+        case TOKEN_STAR:
+            if (!__builtin_mul_overflow(l, r, &out->i)) return NUM_INT;
+            out->d = (double)l * (double)r;
+            return NUM_DECIMAL;
+        case TOKEN_SLASH:
+            if (r == 0) {
+                num_report_division_by_zero();
+                return NUM_FAIL;
+            }
+            if (l == INT64_MIN && r == -1) {
+                out->d = -(double)l;
+                return NUM_DECIMAL;
+            }
+            out->i = l / r;
+            return NUM_INT;
+        case TOKEN_LT: out->i = l < r; return NUM_INT;
+        case TOKEN_GT: out->i = l > r; return NUM_INT;
+        case TOKEN_LT_EQ: out->i = l <= r; return NUM_INT;
+        case TOKEN_GT_EQ: out->i = l >= r; return NUM_INT;
+        case TOKEN_EQ_EQ: out->i = l == r; return NUM_INT;
+        case TOKEN_BANG_EQ: out->i = l != r; return NUM_INT;
+        default:
+            out->i = 0;
+            return NUM_INT;
+    }
+}
+
+static inline NumKind num_decimal_op(double l, TokenType op, double r, Num *out) {
+    switch (op) {
+        case TOKEN_PLUS: out->d = l + r; return NUM_DECIMAL;
+        case TOKEN_MINUS: out->d = l - r; return NUM_DECIMAL;
+        case TOKEN_STAR: out->d = l * r; return NUM_DECIMAL;
+        case TOKEN_SLASH:
+            if (r == 0) {
+                num_report_division_by_zero();
+                return NUM_FAIL;
+            }
+            out->d = l / r;
+            return NUM_DECIMAL;
+        case TOKEN_LT: out->i = l < r; return NUM_INT;
+        case TOKEN_GT: out->i = l > r; return NUM_INT;
+        case TOKEN_LT_EQ: out->i = l <= r; return NUM_INT;
+        case TOKEN_GT_EQ: out->i = l >= r; return NUM_INT;
+        case TOKEN_EQ_EQ: out->i = l == r; return NUM_INT;
+        case TOKEN_BANG_EQ: out->i = l != r; return NUM_INT;
+        default:
+            out->i = 0;
+            return NUM_INT;
+    }
+}
+
+static inline double num_as_double(NumKind kind, Num n) {
+    return kind == NUM_INT ? (double)n.i : n.d;
+}
+
+// Integer operands take the exact path, anything else the decimal one
+static inline NumKind num_op(NumKind lk, Num l, TokenType op, NumKind rk, Num r, Num *out) {
+    if (lk == NUM_INT && rk == NUM_INT) return num_int_op(l.i, op, r.i, out);
+    return num_decimal_op(num_as_double(lk, l), op, num_as_double(rk, r), out);
+}
+
+// Unboxes a value known to be a number. The null left by an already
+// reported error has a zeroed payload and reads as the integer 0.
+static inline NumKind num_from_value(Value v, Num *out) {
+    if (v.type == VAL_DECIMAL) {
+        out->d = v.as.decimal;
+        return NUM_DECIMAL;
+    }
+    out->i = v.as.number;
+    return NUM_INT;
+}
+
+static inline Value num_to_value(NumKind kind, Num n) {
+    if (kind == NUM_NULL) return make_null();
+    return kind == NUM_DECIMAL ? make_decimal(n.d) : make_number(n.i);
+}
+
+static inline int num_truthy(NumKind kind, Num n) {
+    return kind == NUM_DECIMAL ? n.d != 0 : n.i != 0;
+}
+
+// Shortest text that reads back as the same double, always marked as a
+// decimal ("3.0", not "3"). Returns the length; 'size' of 32 always suffices.
+static inline int format_decimal(double d, char *buf, size_t size) {
+    int length = 0;
+    for (int precision = 15; precision <= 17; precision++) {
+        length = snprintf(buf, size, "%.*g", precision, d);
+        if (strtod(buf, NULL) == d) break;
+    }
+    if (!strpbrk(buf, ".eni")) length += snprintf(buf + length, size - length, ".0"); // Not inf/nan
+    return length;
+}
+
+#endif
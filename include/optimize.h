@@ -0,0 +1,25 @@
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include <stdio.h>
+#include "ast.h"
+
+// AST optimization pass, run after resolve_program() and before anything
+// executes or translates the tree:
+//  - Inlines calls to small top-level functions whose body is a single
+//    'kembali <expr>', so 'tambah(a, b)' becomes 'a + b' with no environment
+//    created for the call. Only functions bound once, declared before the
+//    call site and not calling themselves qualify, and only where the
+//    substitution keeps argument evaluation order and the meaning of every
+//    name in the expression.
+//  - Removes statements after 'kembali' in the same list and expression
+//    statements that cannot have an effect (a bare '1+1').
+//  - With 'drop_unused', removes top-level functions whose name is never
+//    used. Off when the globals must survive, as for --snapshot.
+// Bodies left lazy by the parser are not touched; for removal their uses
+// are the names the parser saw while skipping them.
+// When 'report' is non-NULL every inlined call and removed function is
+// listed there.
+void optimize_program(ASTNode *program, int drop_unused, FILE *report);
+
+#endif
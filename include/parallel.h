@@ -0,0 +1,18 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+// Data-parallel builtins on a fixed pool of worker threads:
+//   peta_paralel(f, xs)          -> [f(x) for x in xs], in order
+//   reduksi_paralel(f, xs, awal) -> f(...f(f(awal, x0), x1)..., xn); f must be associative
+// The input is cut into chunks spread over per-worker deques; a worker that
+// runs out steals from the others. Workers run user functions on the tree
+// walker with their own evaluation state, reading globals but never writing
+// them, so f must not modify lists or maps it shares with other calls.
+
+void parallel_init(void);             // Registers the natives; see builtins.c
+void parallel_set_threads(int count); // Workers including the main thread; 0 = one per CPU
+int parallel_thread_count(void);      // What that setting resolves to
+int parallel_active(void);            // 1 while a parallel call is running
+void parallel_shutdown(void);         // Joins the pool
+
+#endif
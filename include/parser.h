@@ -1,9 +1,49 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stddef.h>
 #include "ast.h"
 
 void init_parser(const char *source);
 ASTNode* parse();
 
+// A piece of source holding whole top-level statements
+typedef struct {
+    const char *start;
+    size_t length;
+    int line; // Of its first byte
+} SourceSpan;
+
+// Cuts source[0, length) into spans at top-level statements, found by a
+// cheap scan that copies no token text: at the first statement keyword at
+// or past each multiple of 'share' bytes, or at every one when 'share' is
+// 0. An expression statement stays in the span before it. Fills a malloc'd
+// array and returns its length (at least 1). Uses the calling thread's
+// lexer.
+int parser_split(const char *source, size_t length, size_t share, SourceSpan **spans);
+
+// Parses source[0, length), lines numbered from 'line', into a statement
+// list without making a program of it; bodies are never left lazy. On a
+// syntax error the message is printed and 0 returned, where parse() would
+// exit.
+int parse_statements(const char *source, size_t length, int line, ASTNode **out);
+
+// Same result as init_parser + parse, on up to 'threads' threads: a cheap
+// scan cuts the source at top-level statements into even chunks, each
+// parsed by its own lexer, and the statement lists are joined in source
+// order. Line numbers count from the start of the source; diagnostics are
+// printed in source order, up to the first chunk that failed.
+ASTNode* parse_parallel(const char *source, int threads);
+
+// Lazy parsing. With it on, parse() only pre-parses the bodies of top-level
+// functions: it matches block keywords against 'akhir' to find where each
+// ends and records the span (decl->lazy_body, body NULL). The body is parsed
+// on the first call, so syntax errors inside it are only reported then.
+// The source must outlive the program.
+void parser_set_lazy(int enabled);
+void parser_materialize(FuncDeclNode *decl);
+void parser_materialize_all(void); // Before threads may call any of them
+// Lists again the lazy functions left in 'program', after some were removed
+void parser_track_lazy(ASTNode *program);
+
 #endif
@@ -0,0 +1,20 @@
+#ifndef READER_H
+#define READER_H
+
+#include "gc.h"
+
+#define READER_CHUNK (1024 * 1024)
+
+ObjReader* reader_open(const char *path); // NULL if the file cannot be opened
+ObjReader* reader_stdin(void);
+
+// Next line without its terminator ("\n" or "\r\n") as a view into the
+// current chunk. Returns 0 at end of input. The reader must be rooted.
+int reader_next_line(ObjReader *reader, Value *out);
+
+// Consumes the rest of the input and returns how many lines it held
+long long reader_count_lines(ObjReader *reader);
+
+void reader_close(ObjReader *reader);
+
+#endif
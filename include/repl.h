@@ -0,0 +1,26 @@
+#ifndef REPL_H
+#define REPL_H
+
+// Interactive modes. Both run against the evaluator's global environment
+// (init_evaluator first), which persists between runs, and keep every AST
+// they parsed until they return, since function values point into them.
+// Neither runs the optimizer or type inference: what they inline or
+// specialize would go stale at the next change.
+
+// Runs the file at 'path', then runs it again whenever it changes (its size
+// and modification time are polled) until interrupted. A change is diffed
+// against the previous source at top-level statements: unchanged
+// statements keep their AST and only the changed ones are parsed. Top-level functions that are
+// unchanged and still bound by nothing else keep their binding from the
+// previous run and are not re-run; all other statements run again in
+// order. Names no longer bound anywhere in the file are reset. A syntax
+// error leaves the previous version in place.
+// Returns 0, or 1 when the file cannot be read at the start.
+int watch_run(const char *path);
+
+// Reads statements from stdin and runs each entry once its blocks are
+// closed; an expression entry other than a call prints its value. Returns
+// at end of input.
+void repl_run(void);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef RESOLVE_H
+#define RESOLVE_H
+
+#include "ast.h"
+
+// Closure resolution. For every function declared inside another function,
+// records in decl->captures the names it uses that belong to an enclosing
+// function (its parameters, 'biar' and 'ulang' variables and nested
+// 'fungsi'), unless it has certainly bound the name itself where it reads
+// it. Names bound in none of them are globals and are looked up at run
+// time as before. A function also captures what its nested functions
+// need from further out, so each closure copies only from its direct parent.
+void resolve_program(ASTNode *program);
+
+// The same for a top-level function whose body was parsed later
+// (parser_materialize); the program pass skips bodies not parsed yet.
+void resolve_function(FuncDeclNode *decl);
+
+#endif
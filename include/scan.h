@@ -0,0 +1,25 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stddef.h>
+
+// Block scanners used by the lexer. Each one starts at src[pos], never reads
+// at or past src[len], and returns the position of the first byte that
+// stops the scan (or len). Newlines crossed are added to *lines.
+// Wide blocks use AVX2 when the CPU has it, SSE2 otherwise, and a scalar
+// loop for the tail and on other architectures.
+
+void scan_init(void); // Picks the widest supported implementation
+
+size_t scan_whitespace(const char *src, size_t pos, size_t len, int *lines);
+size_t scan_identifier(const char *src, size_t pos, size_t len);  // [A-Za-z0-9_]*
+size_t scan_string_body(const char *src, size_t pos, size_t len, int *lines); // Up to '"'
+size_t scan_digits(const char *src, size_t pos, size_t len);
+
+// Kernels for the text builtins (text.h), on the same implementations.
+// scan_find returns where needle[0, n) first occurs in src[pos, len), or
+// len. scan_equal_fold compares a and b ignoring ASCII letter case.
+size_t scan_find(const char *src, size_t pos, size_t len, const char *needle, size_t n);
+int scan_equal_fold(const char *a, const char *b, size_t len);
+
+#endif
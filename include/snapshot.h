@@ -0,0 +1,24 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "ast.h"
+#include "env.h"
+
+// Heap snapshot images. After a prelude has run, snapshot_save writes every
+// global binding (numbers, strings, lists, maps and functions with their
+// AST) to a file. snapshot_load maps such a file and binds the same globals
+// into a fresh environment. Function bodies stay encoded in the mapping until
+// their first call, so loading costs one small record per global instead of
+// re-parsing and re-running the prelude.
+// Both return 0 on success and report errors themselves.
+int snapshot_save(Environment *globals, const char *path);
+int snapshot_load(Environment *globals, const char *path);
+
+// Decodes a function body still held in the image (decl->image_body)
+void snapshot_materialize(FuncDeclNode *decl);
+void snapshot_materialize_all(void); // Before threads may call any of them
+
+// Frees loaded functions and unmaps the image; call before the heap goes
+void snapshot_close(void);
+
+#endif
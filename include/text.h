@@ -0,0 +1,17 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+// String builtins, searching with the SIMD kernels in scan.h:
+//   cari(s, t)            -> index of the first t in s, or -1
+//   hitung_teks(s, t)     -> non-overlapping occurrences of t in s
+//   pisah(s, d)           -> list of the fields between delimiters d
+//   ganti(s, lama, baru)  -> s with every 'lama' replaced by 'baru'
+//   pangkas(s)            -> s without leading and trailing whitespace
+//   diawali(s, t), diakhiri(s, t) -> 1 if s starts/ends with t
+//   setara(a, b)          -> 1 if equal ignoring ASCII letter case
+// Results that are part of s (fields, trimmed text, or s itself when
+// nothing was replaced) are views or inline copies, never heap copies.
+
+void text_init(void); // Registers the natives; see builtins.c
+
+#endif
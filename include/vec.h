@@ -0,0 +1,19 @@
+#ifndef VEC_H
+#define VEC_H
+
+#include <stdint.h>
+
+// Bulk kernels over unboxed int64_t storage. They are written as plain
+// counted loops with no early exits or aliasing so the compiler can
+// vectorize them (vec.c is built with -O3, see the Makefile). Like the
+// interpreter's integer operations they never wrap: a result that does not
+// fit in 64 bits is reported, and the caller produces a decimal instead.
+
+int vec_sum(const int64_t *xs, int n, int64_t *out, double *approx); // 0: only *approx is set
+int64_t vec_min(const int64_t *xs, int n);   // n > 0
+int64_t vec_max(const int64_t *xs, int n);   // n > 0
+int vec_count_eq(const int64_t *xs, int n, int64_t value);
+int vec_scale(int64_t *restrict dst, const int64_t *restrict src, int n, int64_t factor); // 0 on overflow
+int vec_dot(const int64_t *xs, const int64_t *ys, int n, int64_t *out); // 0 on overflow
+
+#endif
@@ -0,0 +1,315 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include "morph_rt.h"
+
+int mrt_bailout = 0;
+
+// Same semantics as eval_binary_op: numeric operators on two numbers,
+// '+' also concatenates two strings and '=='/'!=' compare two strings by
+// content, anything else yields null. Integer results that overflow become
+// decimals, a decimal operand makes the operation decimal, and dividing by
+// zero is an error.
+
+static int is_numeric(MrtValue v) {
+    return v.type == MRT_NUMBER || v.type == MRT_DECIMAL;
+}
+
+static double as_double(MrtValue v) {
+    return v.type == MRT_DECIMAL ? v.as.decimal : (double)v.as.number;
+}
+
+#define MRT_ARITH_OP(name, checked, op)                              \
+    MrtValue name(MrtValue a, MrtValue b) {                          \
+        long long r;                                                 \
+        if (a.type == MRT_NUMBER && b.type == MRT_NUMBER &&          \
+            !checked(a.as.number, b.as.number, &r)) {                \
+            return mrt_number(r);                                    \
+        }                                                            \
+        if (is_numeric(a) && is_numeric(b)) {                        \
+            return mrt_decimal(as_double(a) op as_double(b));        \
+        }                                                            \
+        return mrt_null();                                           \
+    }
+
+#define MRT_COMPARE_OP(name, op)                                     \
+    MrtValue name(MrtValue a, MrtValue b) {                          \
+        if (a.type == MRT_NUMBER && b.type == MRT_NUMBER) {          \
+            return mrt_number(a.as.number op b.as.number);           \
+        }                                                            \
+        if (is_numeric(a) && is_numeric(b)) {                        \
+            return mrt_number(as_double(a) op as_double(b));         \
+        }                                                            \
+        return mrt_null();                                           \
+    }
+
+MrtValue mrt_add(MrtValue a, MrtValue b) {
+    if (a.type == MRT_NUMBER && b.type == MRT_NUMBER) {
+        long long r;
+        if (!__builtin_add_overflow(a.as.number, b.as.number, &r)) return mrt_number(r);
+    }
+    if (is_numeric(a) && is_numeric(b)) {
+        return mrt_decimal(as_double(a) + as_double(b));
+    }
+    if (a.type == MRT_STRING && b.type == MRT_STRING) {
+        size_t la = strlen(a.as.string);
+        size_t lb = strlen(b.as.string);
+        char *s = malloc(la + lb + 1);
+        if (!s) {
+            fprintf(stderr, "Runtime Error: Kehabisan memori.\n");
+            exit(1);
+        }
+        memcpy(s, a.as.string, la);
+        memcpy(s + la, b.as.string, lb + 1);
+        return mrt_str(s);
+    }
+    return mrt_null();
+}
+
+MRT_ARITH_OP(mrt_sub, __builtin_sub_overflow, -)
+MRT_ARITH_OP(mrt_mul, __builtin_mul_overflow, *)
+MRT_COMPARE_OP(mrt_lt, <)
+MRT_COMPARE_OP(mrt_gt, >)
+MRT_COMPARE_OP(mrt_le, <=)
+MRT_COMPARE_OP(mrt_ge, >=)
+MRT_COMPARE_OP(mrt_numbers_eq, ==)
+
+MrtValue mrt_div(MrtValue a, MrtValue b) {
+    if (!is_numeric(a) || !is_numeric(b)) return mrt_null();
+    if (b.type == MRT_NUMBER ? b.as.number == 0 : b.as.decimal == 0) {
+        fprintf(stderr, "Runtime Error: Pembagian dengan nol.\n");
+        return mrt_null();
+    }
+    if (a.type == MRT_NUMBER && b.type == MRT_NUMBER &&
+        !(a.as.number == LLONG_MIN && b.as.number == -1)) {
+        return mrt_number(a.as.number / b.as.number);
+    }
+    return mrt_decimal(as_double(a) / as_double(b));
+}
+
+MrtValue mrt_eq(MrtValue a, MrtValue b) {
+    if (a.type == MRT_STRING && b.type == MRT_STRING) {
+        return mrt_number(strcmp(a.as.string, b.as.string) == 0);
+    }
+    return mrt_numbers_eq(a, b);
+}
+
+MrtValue mrt_ne(MrtValue a, MrtValue b) {
+    MrtValue eq = mrt_eq(a, b);
+    return eq.type == MRT_NUMBER ? mrt_number(!eq.as.number) : eq;
+}
+
+// Shortest text that reads back the same, always with a '.', as the
+// interpreter prints. 'buf' holds 32 bytes.
+static void format_decimal(double d, char *buf) {
+    for (int precision = 15; precision <= 17; precision++) {
+        snprintf(buf, 32, "%.*g", precision, d);
+        if (strtod(buf, NULL) == d) break;
+    }
+    if (!strpbrk(buf, ".eni")) strcat(buf, ".0");
+}
+
+void mrt_print(MrtValue v) {
+    if (v.type == MRT_STRING) {
+        printf("%s\n", v.as.string);
+    } else if (v.type == MRT_NUMBER) {
+        printf("%lld\n", v.as.number);
+    } else if (v.type == MRT_DECIMAL) {
+        char buf[32];
+        format_decimal(v.as.decimal, buf);
+        printf("%s\n", buf);
+    }
+}
+
+// Text of one interpolated part; numbers are formatted into 'buf'
+static const char* part_text(MrtValue v, char *buf) {
+    switch (v.type) {
+        case MRT_STRING: return v.as.string;
+        case MRT_NUMBER: snprintf(buf, 32, "%lld", v.as.number); return buf;
+        case MRT_DECIMAL: format_decimal(v.as.decimal, buf); return buf;
+        case MRT_FUNCTION: return "<fungsi>";
+        default: return "kosong";
+    }
+}
+
+MrtValue mrt_join(int count, const MrtValue *parts) {
+    char buf[32];
+    size_t total = 0;
+    for (int i = 0; i < count; i++) total += strlen(part_text(parts[i], buf));
+
+    char *s = malloc(total + 1);
+    if (!s) {
+        fprintf(stderr, "Runtime Error: Kehabisan memori.\n");
+        exit(1);
+    }
+    char *dst = s;
+    for (int i = 0; i < count; i++) {
+        const char *text = part_text(parts[i], buf);
+        size_t length = strlen(text);
+        memcpy(dst, text, length);
+        dst += length;
+    }
+    *dst = '\0';
+    return mrt_str(s);
+}
+
+int mrt_range_ok(MrtValue start, MrtValue end) {
+    if (start.type != MRT_NUMBER || end.type != MRT_NUMBER) {
+        fprintf(stderr, "Runtime Error: 'ulang' bounds must be integers.\n");
+        return 0;
+    }
+    return 1;
+}
+
+MrtValue mrt_call(MrtValue callee, const char *name, int argc, MrtValue *argv) {
+    if (callee.type != MRT_FUNCTION) {
+        fprintf(stderr, "Runtime Error: '%s' is not a function.\n", name);
+        return mrt_null();
+    }
+    return callee.as.function(argc, argv);
+}
+
+// --- Natives ---
+
+static int expect_args(const char *name, int argc, int expected) {
+    if (argc != expected) {
+        fprintf(stderr, "Runtime Error: '%s' expects %d argument(s), got %d.\n", name, expected, argc);
+        return 0;
+    }
+    return 1;
+}
+
+static int expect_number(const char *name, MrtValue v) {
+    if (!is_numeric(v)) {
+        fprintf(stderr, "Runtime Error: '%s' expects a number.\n", name);
+        return 0;
+    }
+    return 1;
+}
+
+// Bytes of a string; lists and maps do not exist here
+MrtValue mrt_native_panjang(int argc, MrtValue *argv) {
+    if (!expect_args("panjang", argc, 1)) return mrt_null();
+    if (argv[0].type != MRT_STRING) {
+        fprintf(stderr, "Runtime Error: 'panjang' expects a list.\n");
+        return mrt_null();
+    }
+    return mrt_number((long long)strlen(argv[0].as.string));
+}
+
+MrtValue mrt_native_tipe(int argc, MrtValue *argv) {
+    if (!expect_args("tipe", argc, 1)) return mrt_null();
+    switch (argv[0].type) {
+        case MRT_NUMBER: return mrt_str("angka");
+        case MRT_DECIMAL: return mrt_str("desimal");
+        case MRT_STRING: return mrt_str("teks");
+        case MRT_FUNCTION: return mrt_str("fungsi");
+        default: return mrt_str("kosong");
+    }
+}
+
+MrtValue mrt_native_teks(int argc, MrtValue *argv) {
+    if (!expect_args("teks", argc, 1)) return mrt_null();
+    if (argv[0].type == MRT_STRING) return argv[0];
+    if (!expect_number("teks", argv[0])) return mrt_null();
+    char buf[32];
+    if (argv[0].type == MRT_DECIMAL) format_decimal(argv[0].as.decimal, buf);
+    else snprintf(buf, sizeof(buf), "%lld", argv[0].as.number);
+    char *s = strdup(buf);
+    if (!s) {
+        fprintf(stderr, "Runtime Error: Kehabisan memori.\n");
+        exit(1);
+    }
+    return mrt_str(s);
+}
+
+// An integer or a decimal, null if the text is neither; as bi_angka
+MrtValue mrt_native_angka(int argc, MrtValue *argv) {
+    if (!expect_args("angka", argc, 1)) return mrt_null();
+    if (is_numeric(argv[0])) return argv[0];
+    if (argv[0].type != MRT_STRING) {
+        fprintf(stderr, "Runtime Error: 'angka' expects a string.\n");
+        return mrt_null();
+    }
+
+    const char *text = argv[0].as.string;
+    if (strlen(text) >= 64) return mrt_null();
+    char *end;
+    errno = 0;
+    long long n = strtoll(text, &end, 10);
+    if (end != text && *end == '\0' && errno != ERANGE) return mrt_number(n);
+    const char *digits = text + (text[0] == '-' || text[0] == '+');
+    int plain = strspn(digits, "0123456789.") == strlen(digits);
+    double d = strtod(text, &end);
+    if (plain && end != text && *end == '\0' && isfinite(d)) return mrt_decimal(d);
+    return mrt_null();
+}
+
+MrtValue mrt_native_waktu(int argc, MrtValue *argv) {
+    (void)argv;
+    if (!expect_args("waktu", argc, 0)) return mrt_null();
+    return mrt_number((long long)time(NULL));
+}
+
+MrtValue mrt_native_waktu_ms(int argc, MrtValue *argv) {
+    (void)argv;
+    if (!expect_args("waktu_ms", argc, 0)) return mrt_null();
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return mrt_number((long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+MrtValue mrt_native_mutlak(int argc, MrtValue *argv) {
+    if (!expect_args("mutlak", argc, 1) || !expect_number("mutlak", argv[0])) return mrt_null();
+    if (argv[0].type == MRT_DECIMAL) return mrt_decimal(fabs(argv[0].as.decimal));
+    long long n = argv[0].as.number;
+    if (n == LLONG_MIN) return mrt_decimal(-(double)n);
+    return mrt_number(n < 0 ? -n : n);
+}
+
+// Integer square root rounded down for integers, as bi_akar
+MrtValue mrt_native_akar(int argc, MrtValue *argv) {
+    if (!expect_args("akar", argc, 1) || !expect_number("akar", argv[0])) return mrt_null();
+    if (argv[0].type == MRT_DECIMAL ? argv[0].as.decimal < 0 : argv[0].as.number < 0) {
+        fprintf(stderr, "Runtime Error: 'akar' of a negative number.\n");
+        return mrt_null();
+    }
+    if (argv[0].type == MRT_DECIMAL) return mrt_decimal(sqrt(argv[0].as.decimal));
+    long long n = argv[0].as.number;
+    long long x = n;
+    long long y = n / 2 + n % 2;
+    while (y < x) {
+        x = y;
+        y = (x + n / x) / 2;
+    }
+    return mrt_number(x);
+}
+
+MrtValue mrt_native_pangkat(int argc, MrtValue *argv) {
+    if (!expect_args("pangkat", argc, 2) || !expect_number("pangkat", argv[0])) return mrt_null();
+    if (argv[1].type != MRT_NUMBER) {
+        fprintf(stderr, "Runtime Error: 'pangkat' expects an integer.\n");
+        return mrt_null();
+    }
+    long long exp = argv[1].as.number;
+    if (exp < 0) {
+        fprintf(stderr, "Runtime Error: 'pangkat' expects a non-negative exponent.\n");
+        return mrt_null();
+    }
+    if (argv[0].type == MRT_NUMBER) {
+        long long base = argv[0].as.number;
+        long long result = 1;
+        long long e = exp;
+        int overflow = 0;
+        while (e > 0 && !overflow) {
+            if (e & 1) overflow |= __builtin_mul_overflow(result, base, &result);
+            e >>= 1;
+            if (e > 0) overflow |= __builtin_mul_overflow(base, base, &base);
+        }
+        if (!overflow) return mrt_number(result);
+    }
+    return mrt_decimal(pow(as_double(argv[0]), (double)exp));
+}
@@ -0,0 +1,133 @@
+#ifndef MORPH_RT_H
+#define MORPH_RT_H
+
+// Minimal runtime for C programs produced by `morphc --emit-c`.
+// Build: cc -Iruntime program.c runtime/morph_rt.c -lm -o program
+//
+// Values mirror the interpreter's Value. Strings are immutable; literals
+// point at static data and concatenation results live until exit, which
+// suits the short-lived batch scripts this mode targets.
+
+#include <limits.h>
+
+typedef enum {
+    MRT_NUMBER,
+    MRT_DECIMAL,
+    MRT_STRING,
+    MRT_FUNCTION,
+    MRT_NULL
+} MrtType;
+
+typedef struct MrtValue MrtValue;
+typedef MrtValue (*MrtFn)(int argc, MrtValue *argv);
+
+struct MrtValue {
+    MrtType type;
+    union {
+        long long number;
+        double decimal;
+        const char *string;
+        MrtFn function;
+    } as;
+};
+
+static inline MrtValue mrt_number(long long n) {
+    MrtValue v;
+    v.type = MRT_NUMBER;
+    v.as.number = n;
+    return v;
+}
+
+static inline MrtValue mrt_decimal(double d) {
+    MrtValue v;
+    v.type = MRT_DECIMAL;
+    v.as.decimal = d;
+    return v;
+}
+
+static inline MrtValue mrt_str(const char *s) {
+    MrtValue v;
+    v.type = MRT_STRING;
+    v.as.string = s;
+    return v;
+}
+
+static inline MrtValue mrt_function(MrtFn fn) {
+    MrtValue v;
+    v.type = MRT_FUNCTION;
+    v.as.function = fn;
+    return v;
+}
+
+static inline MrtValue mrt_null(void) {
+    MrtValue v;
+    v.type = MRT_NULL;
+    v.as.number = 0;
+    return v;
+}
+
+static inline int mrt_truthy(MrtValue v) {
+    if (v.type == MRT_DECIMAL) return v.as.decimal != 0;
+    return v.type == MRT_NUMBER ? v.as.number != 0 : 1;
+}
+
+// Integer twins run on plain long longs. Where the interpreter would promote
+// to a decimal (overflow) or report an error (division by zero) these set
+// mrt_bailout instead, and the caller re-runs the generic MrtValue body.
+extern int mrt_bailout;
+
+static inline long long mrt_ibail(void) {
+    mrt_bailout = 1;
+    return 0;
+}
+
+static inline long long mrt_iadd(long long a, long long b) {
+    long long r;
+    return __builtin_add_overflow(a, b, &r) ? mrt_ibail() : r;
+}
+
+static inline long long mrt_isub(long long a, long long b) {
+    long long r;
+    return __builtin_sub_overflow(a, b, &r) ? mrt_ibail() : r;
+}
+
+static inline long long mrt_imul(long long a, long long b) {
+    long long r;
+    return __builtin_mul_overflow(a, b, &r) ? mrt_ibail() : r;
+}
+
+static inline long long mrt_idiv(long long a, long long b) {
+    if (b == 0 || (a == LLONG_MIN && b == -1)) return mrt_ibail();
+    return a / b;
+}
+
+MrtValue mrt_add(MrtValue a, MrtValue b);
+MrtValue mrt_sub(MrtValue a, MrtValue b);
+MrtValue mrt_mul(MrtValue a, MrtValue b);
+MrtValue mrt_div(MrtValue a, MrtValue b);
+MrtValue mrt_lt(MrtValue a, MrtValue b);
+MrtValue mrt_gt(MrtValue a, MrtValue b);
+MrtValue mrt_le(MrtValue a, MrtValue b);
+MrtValue mrt_ge(MrtValue a, MrtValue b);
+MrtValue mrt_eq(MrtValue a, MrtValue b);
+MrtValue mrt_ne(MrtValue a, MrtValue b);
+
+void mrt_print(MrtValue v);
+MrtValue mrt_join(int count, const MrtValue *parts); // Interpolated string, as join_values
+int mrt_range_ok(MrtValue start, MrtValue end); // 'ulang' bounds check
+MrtValue mrt_call(MrtValue callee, const char *name, int argc, MrtValue *argv);
+
+// Natives of the interpreter that need nothing beyond these values, with
+// its messages; list, map and reader arguments cannot occur here. Shaped
+// as MrtFn so a program can pass them around like its own functions.
+MrtValue mrt_native_panjang(int argc, MrtValue *argv);
+MrtValue mrt_native_tipe(int argc, MrtValue *argv);
+MrtValue mrt_native_teks(int argc, MrtValue *argv);
+MrtValue mrt_native_angka(int argc, MrtValue *argv);
+MrtValue mrt_native_waktu(int argc, MrtValue *argv);
+MrtValue mrt_native_waktu_ms(int argc, MrtValue *argv);
+MrtValue mrt_native_mutlak(int argc, MrtValue *argv);
+MrtValue mrt_native_akar(int argc, MrtValue *argv);
+MrtValue mrt_native_pangkat(int argc, MrtValue *argv);
+
+#endif
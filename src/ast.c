@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ast.h"
+#include "gc.h"
 
 static void* alloc_node(size_t size, NodeType type) {
     ASTNode *node = calloc(1, size);
@@ -19,6 +20,13 @@ ASTNode* append_node(ASTNode *head, ASTNode *node) {
     return head;
 }
 
+void node_list_push(NodeList *list, ASTNode *node) {
+    if (!node) return;
+    if (list->tail) list->tail->next = node;
+    else list->head = node;
+    list->tail = node;
+}
+
 ASTNode* new_program(ASTNode *stmts) {
     ProgramNode *node = alloc_node(sizeof(ProgramNode), NODE_PROGRAM);
     node->statements = stmts;
@@ -51,20 +59,45 @@ ASTNode* new_if(ASTNode *cond, ASTNode *then_block) {
     return (ASTNode*)node;
 }
 
+ASTNode* new_repeat(const char *var_name, ASTNode *start, ASTNode *end, ASTNode *body) {
+    RepeatNode *node = alloc_node(sizeof(RepeatNode), NODE_REPEAT);
+    node->var_name = strdup(var_name);
+    node->start = start;
+    node->end = end;
+    node->body = body;
+    return (ASTNode*)node;
+}
+
+ASTNode* new_while(ASTNode *cond, ASTNode *body) {
+    WhileNode *node = alloc_node(sizeof(WhileNode), NODE_WHILE);
+    node->condition = cond;
+    node->body = body;
+    return (ASTNode*)node;
+}
+
 ASTNode* new_literal_string(const char *val) {
     LiteralNode *node = alloc_node(sizeof(LiteralNode), NODE_LITERAL);
     node->type = TOKEN_STRING;
     node->string_val = strdup(val);
+    node->string_obj = gc_new_string(val, strlen(val));
+    gc_pin((Obj*)node->string_obj);
     return (ASTNode*)node;
 }
 
-ASTNode* new_literal_number(int val) {
+ASTNode* new_literal_number(int64_t val) {
     LiteralNode *node = alloc_node(sizeof(LiteralNode), NODE_LITERAL);
     node->type = TOKEN_NUMBER;
     node->int_val = val;
     return (ASTNode*)node;
 }
 
+ASTNode* new_literal_decimal(double val) {
+    LiteralNode *node = alloc_node(sizeof(LiteralNode), NODE_LITERAL);
+    node->type = TOKEN_DECIMAL;
+    node->decimal_val = val;
+    return (ASTNode*)node;
+}
+
 ASTNode* new_var_access(const char *name) {
     VarAccessNode *node = alloc_node(sizeof(VarAccessNode), NODE_VAR_ACCESS);
     node->name = strdup(name);
@@ -86,6 +119,32 @@ ASTNode* new_call_expr(const char *callee, ASTNode *args) {
     return (ASTNode*)node;
 }
 
+ASTNode* new_list(ASTNode *elements) {
+    ListNode *node = alloc_node(sizeof(ListNode), NODE_LIST);
+    node->elements = elements;
+    return (ASTNode*)node;
+}
+
+ASTNode* new_map(ASTNode *keys, ASTNode *values) {
+    MapNode *node = alloc_node(sizeof(MapNode), NODE_MAP);
+    node->keys = keys;
+    node->values = values;
+    return (ASTNode*)node;
+}
+
+ASTNode* new_index(ASTNode *target, ASTNode *index) {
+    IndexNode *node = alloc_node(sizeof(IndexNode), NODE_INDEX);
+    node->target = target;
+    node->index = index;
+    return (ASTNode*)node;
+}
+
+ASTNode* new_interp(ASTNode *parts) {
+    InterpNode *node = alloc_node(sizeof(InterpNode), NODE_INTERP);
+    node->parts = parts;
+    return (ASTNode*)node;
+}
+
 ASTNode* new_func_decl(const char *name, ASTNode *params, ASTNode *body) {
     FuncDeclNode *node = alloc_node(sizeof(FuncDeclNode), NODE_FUNC_DECL);
     node->name = strdup(name);
@@ -100,73 +159,300 @@ ASTNode* new_return(ASTNode *val) {
     return (ASTNode*)node;
 }
 
-void free_ast(ASTNode *node) {
+// Walks iteratively with an explicit stack: long statement lists and long
+// operator chains would otherwise recurse once per node.
+typedef struct {
+    ASTNode **items;
+    int count;
+    int capacity;
+} NodeStack;
+
+static void push_node(NodeStack *stack, ASTNode *node) {
     if (!node) return;
+    if (stack->count >= stack->capacity) {
+        stack->capacity = stack->capacity < 64 ? 64 : stack->capacity * 2;
+        stack->items = realloc(stack->items, sizeof(ASTNode*) * stack->capacity);
+    }
+    stack->items[stack->count++] = node;
+}
 
-    free_ast(node->next);
+// The nodes 'node' links to, its successor included
+static void push_children(NodeStack *stack, ASTNode *node) {
+    push_node(stack, node->next);
 
     switch (node->type) {
-        case NODE_PROGRAM: {
-            ProgramNode *n = (ProgramNode*)node;
-            free_ast(n->statements);
-            break;
-        }
-        case NODE_BLOCK: {
-            BlockNode *n = (BlockNode*)node;
-            free_ast(n->statements);
+        case NODE_PROGRAM: push_node(stack, ((ProgramNode*)node)->statements); break;
+        case NODE_BLOCK: push_node(stack, ((BlockNode*)node)->statements); break;
+        case NODE_VAR_DECL: push_node(stack, ((VarDeclNode*)node)->value); break;
+        case NODE_PRINT: push_node(stack, ((PrintNode*)node)->expression); break;
+        case NODE_IF: {
+            IfNode *n = (IfNode*)node;
+            push_node(stack, n->condition);
+            push_node(stack, n->then_branch);
             break;
         }
-        case NODE_VAR_DECL: {
-            VarDeclNode *n = (VarDeclNode*)node;
-            free(n->name);
-            free_ast(n->value);
+        case NODE_REPEAT: {
+            RepeatNode *n = (RepeatNode*)node;
+            push_node(stack, n->start);
+            push_node(stack, n->end);
+            push_node(stack, n->body);
             break;
         }
-        case NODE_PRINT: {
-            PrintNode *n = (PrintNode*)node;
-            free_ast(n->expression);
+        case NODE_WHILE: {
+            WhileNode *n = (WhileNode*)node;
+            push_node(stack, n->condition);
+            push_node(stack, n->body);
             break;
         }
-        case NODE_IF: {
-            IfNode *n = (IfNode*)node;
-            free_ast(n->condition);
-            free_ast(n->then_branch);
+        case NODE_LITERAL: break;
+        case NODE_VAR_ACCESS: break;
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *n = (BinaryExprNode*)node;
+            push_node(stack, n->left);
+            push_node(stack, n->right);
             break;
         }
-        case NODE_LITERAL: {
-            LiteralNode *n = (LiteralNode*)node;
-            if (n->type == TOKEN_STRING) free(n->string_val);
+        case NODE_CALL_EXPR: push_node(stack, ((CallExprNode*)node)->arguments); break;
+        case NODE_LIST: push_node(stack, ((ListNode*)node)->elements); break;
+        case NODE_MAP: {
+            MapNode *n = (MapNode*)node;
+            push_node(stack, n->keys);
+            push_node(stack, n->values);
             break;
         }
-        case NODE_VAR_ACCESS: {
-            VarAccessNode *n = (VarAccessNode*)node;
-            free(n->name);
+        case NODE_INDEX: {
+            IndexNode *n = (IndexNode*)node;
+            push_node(stack, n->target);
+            push_node(stack, n->index);
             break;
         }
-        case NODE_BINARY_EXPR: {
-            BinaryExprNode *n = (BinaryExprNode*)node;
-            free_ast(n->left);
-            free_ast(n->right);
+        case NODE_INTERP: push_node(stack, ((InterpNode*)node)->parts); break;
+        case NODE_FUNC_DECL: {
+            FuncDeclNode *n = (FuncDeclNode*)node;
+            push_node(stack, n->params);
+            push_node(stack, n->body);
             break;
         }
-        case NODE_CALL_EXPR: {
-            CallExprNode *n = (CallExprNode*)node;
-            free(n->callee);
-            free_ast(n->arguments);
+        case NODE_RETURN: push_node(stack, ((ReturnNode*)node)->value); break;
+    }
+}
+
+void ast_visit(ASTNode *root, VisitFn visit, void *ctx) {
+    NodeStack stack = {NULL, 0, 0};
+    push_node(&stack, root);
+    while (stack.count > 0) {
+        ASTNode *node = stack.items[--stack.count];
+        push_children(&stack, node);
+        visit(ctx, node);
+    }
+    free(stack.items);
+}
+
+// What a node owns besides its children
+static void free_fields(ASTNode *node) {
+    switch (node->type) {
+        case NODE_VAR_DECL: free(((VarDeclNode*)node)->name); break;
+        case NODE_REPEAT: free(((RepeatNode*)node)->var_name); break;
+        case NODE_LITERAL: {
+            LiteralNode *n = (LiteralNode*)node;
+            if (n->type == TOKEN_STRING) {
+                free(n->string_val);
+                gc_unpin((Obj*)n->string_obj); // Values may still share it; the GC decides
+            }
             break;
         }
+        case NODE_VAR_ACCESS: free(((VarAccessNode*)node)->name); break;
+        case NODE_CALL_EXPR: free(((CallExprNode*)node)->callee); break;
         case NODE_FUNC_DECL: {
             FuncDeclNode *n = (FuncDeclNode*)node;
             free(n->name);
-            free_ast(n->params);
-            free_ast(n->body);
+            for (int i = 0; i < n->capture_count; i++) free(n->captures[i]);
+            free(n->captures);
+            for (int i = 0; i < n->lazy_use_count; i++) free(n->lazy_uses[i]);
+            free(n->lazy_uses);
             break;
         }
-        case NODE_RETURN: {
-            ReturnNode *n = (ReturnNode*)node;
-            free_ast(n->value);
-            break;
+        default: break;
+    }
+}
+
+static void free_node(void *ctx, ASTNode *node) {
+    (void)ctx;
+    free_fields(node);
+    free(node); // Its children are already on the walk's stack
+}
+
+void free_ast(ASTNode *root) {
+    ast_visit(root, free_node, NULL);
+}
+
+// --- Bindings ---
+
+void walk_bindings(ASTNode *stmts, BindingFn bind, void *ctx) {
+    for (ASTNode *n = stmts; n; n = n->next) {
+        switch (n->type) {
+            case NODE_VAR_DECL: bind(ctx, n, ((VarDeclNode*)n)->name); break;
+            case NODE_FUNC_DECL: bind(ctx, n, ((FuncDeclNode*)n)->name); break;
+            case NODE_BLOCK: walk_bindings(((BlockNode*)n)->statements, bind, ctx); break;
+            case NODE_IF:
+                walk_bindings(((BlockNode*)((IfNode*)n)->then_branch)->statements, bind, ctx);
+                break;
+            case NODE_REPEAT: {
+                RepeatNode *r = (RepeatNode*)n;
+                bind(ctx, n, r->var_name);
+                walk_bindings(((BlockNode*)r->body)->statements, bind, ctx);
+                break;
+            }
+            case NODE_WHILE:
+                walk_bindings(((BlockNode*)((WhileNode*)n)->body)->statements, bind, ctx);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+int name_set_has(const NameSet *set, const char *name) {
+    for (int i = 0; i < set->count; i++) {
+        if (strcmp(set->items[i], name) == 0) return 1;
+    }
+    return 0;
+}
+
+void name_set_add(NameSet *set, const char *name) {
+    if (name_set_has(set, name)) return;
+    if (set->count >= set->capacity) {
+        set->capacity = set->capacity < 8 ? 8 : set->capacity * 2;
+        set->items = realloc(set->items, sizeof(char*) * set->capacity);
+    }
+    set->items[set->count++] = name;
+}
+
+static void set_binding(void *ctx, ASTNode *binder, const char *name) {
+    (void)binder;
+    name_set_add(ctx, name);
+}
+
+void name_set_collect(NameSet *set, ASTNode *stmts) {
+    walk_bindings(stmts, set_binding, set);
+}
+
+void name_table_push(NameTable *t, const char *name) {
+    if (t->count >= t->capacity) {
+        t->capacity = t->capacity < 16 ? 16 : t->capacity * 2;
+        t->items = realloc(t->items, sizeof(NameCount) * t->capacity);
+    }
+    t->items[t->count].name = name;
+    t->items[t->count].count = 1;
+    t->count++;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(((const NameCount*)a)->name, ((const NameCount*)b)->name);
+}
+
+void name_table_finish(NameTable *t) {
+    if (t->count == 0) return;
+    qsort(t->items, t->count, sizeof(NameCount), compare_names);
+    int out = 0;
+    for (int i = 1; i < t->count; i++) {
+        if (strcmp(t->items[i].name, t->items[out].name) == 0) t->items[out].count++;
+        else t->items[++out] = t->items[i];
+    }
+    t->count = out + 1;
+}
+
+NameCount* name_table_find(const NameTable *t, const char *name) {
+    if (t->count == 0) return NULL;
+    NameCount key = {name, 0};
+    return bsearch(&key, t->items, t->count, sizeof(NameCount), compare_names);
+}
+
+int name_table_count(const NameTable *t, const char *name) {
+    NameCount *e = name_table_find(t, name);
+    return e ? e->count : 0;
+}
+
+static void table_binding(void *ctx, ASTNode *binder, const char *name) {
+    (void)binder;
+    name_table_push(ctx, name);
+}
+
+void name_table_collect(NameTable *t, ASTNode *stmts) {
+    walk_bindings(stmts, table_binding, t);
+}
+
+static void collect_function_uses(NameTable *t, FuncDeclNode *f, const char *self);
+
+static void collect_uses(NameTable *t, ASTNode *node, const char *self) {
+    for (; node; node = node->next) {
+        switch (node->type) {
+            case NODE_PROGRAM: collect_uses(t, ((ProgramNode*)node)->statements, self); break;
+            case NODE_BLOCK: collect_uses(t, ((BlockNode*)node)->statements, self); break;
+            case NODE_VAR_DECL: collect_uses(t, ((VarDeclNode*)node)->value, self); break;
+            case NODE_PRINT: collect_uses(t, ((PrintNode*)node)->expression, self); break;
+            case NODE_IF:
+                collect_uses(t, ((IfNode*)node)->condition, self);
+                collect_uses(t, ((IfNode*)node)->then_branch, self);
+                break;
+            case NODE_REPEAT: {
+                RepeatNode *r = (RepeatNode*)node;
+                collect_uses(t, r->start, self);
+                collect_uses(t, r->end, self);
+                collect_uses(t, r->body, self);
+                break;
+            }
+            case NODE_WHILE:
+                collect_uses(t, ((WhileNode*)node)->condition, self);
+                collect_uses(t, ((WhileNode*)node)->body, self);
+                break;
+            case NODE_LITERAL: break;
+            case NODE_VAR_ACCESS: {
+                const char *name = ((VarAccessNode*)node)->name;
+                if (!self || strcmp(name, self) != 0) name_table_push(t, name);
+                break;
+            }
+            case NODE_BINARY_EXPR:
+                collect_uses(t, ((BinaryExprNode*)node)->left, self);
+                collect_uses(t, ((BinaryExprNode*)node)->right, self);
+                break;
+            case NODE_CALL_EXPR: {
+                CallExprNode *c = (CallExprNode*)node;
+                if (!self || strcmp(c->callee, self) != 0) name_table_push(t, c->callee);
+                collect_uses(t, c->arguments, self);
+                break;
+            }
+            case NODE_LIST: collect_uses(t, ((ListNode*)node)->elements, self); break;
+            case NODE_MAP:
+                collect_uses(t, ((MapNode*)node)->keys, self);
+                collect_uses(t, ((MapNode*)node)->values, self);
+                break;
+            case NODE_INDEX:
+                collect_uses(t, ((IndexNode*)node)->target, self);
+                collect_uses(t, ((IndexNode*)node)->index, self);
+                break;
+            case NODE_INTERP: collect_uses(t, ((InterpNode*)node)->parts, self); break;
+            case NODE_FUNC_DECL: collect_function_uses(t, (FuncDeclNode*)node, self); break;
+            case NODE_RETURN: collect_uses(t, ((ReturnNode*)node)->value, self); break;
         }
     }
-    free(node);
+}
+
+// A lazy body is known by the names the parser saw in it
+static void collect_function_uses(NameTable *t, FuncDeclNode *f, const char *self) {
+    if (f->body) {
+        collect_uses(t, f->body, self);
+        return;
+    }
+    for (int i = 0; i < f->lazy_use_count; i++) {
+        if (!self || strcmp(f->lazy_uses[i], self) != 0) name_table_push(t, f->lazy_uses[i]);
+    }
+}
+
+void name_table_collect_uses(NameTable *t, ASTNode *stmts, const char *self) {
+    collect_uses(t, stmts, self);
+}
+
+void name_table_collect_function_uses(NameTable *t, FuncDeclNode *f, const char *self) {
+    collect_function_uses(t, f, self);
 }
@@ -0,0 +1,697 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include "builtins.h"
+#include "gc.h"
+#include "list.h"
+#include "map.h"
+#include "reader.h"
+#include "vec.h"
+#include "num.h"
+#include "evaluator.h"
+#include "parallel.h"
+#include "text.h"
+
+// --- Argument checks ---
+
+static int expect_args(const char *name, int argc, int expected) {
+    if (argc != expected) {
+        fprintf(stderr, "Runtime Error: '%s' expects %d argument(s), got %d.\n", name, expected, argc);
+        return 0;
+    }
+    return 1;
+}
+
+static ObjList* expect_list(const char *name, Value v) {
+    if (v.type != VAL_LIST) {
+        fprintf(stderr, "Runtime Error: '%s' expects a list.\n", name);
+        return NULL;
+    }
+    return v.as.list;
+}
+
+static int is_number(Value v) {
+    return v.type == VAL_NUMBER || v.type == VAL_DECIMAL;
+}
+
+// Bulk kernels run on unboxed (all-integer) storage; a boxed list is still
+// accepted when every element is a number, and goes through num.h one by one
+static ObjList* expect_numeric_list(const char *name, Value v) {
+    ObjList *list = expect_list(name, v);
+    if (!list || list->numeric) return list;
+    for (int i = 0; i < list->count; i++) {
+        if (!is_number(list->as.items[i])) {
+            fprintf(stderr, "Runtime Error: '%s' expects a list of numbers.\n", name);
+            return NULL;
+        }
+    }
+    return list;
+}
+
+static NumKind list_num(ObjList *list, int i, Num *out) {
+    if (list->numeric) {
+        out->i = list->as.numbers[i];
+        return NUM_INT;
+    }
+    return num_from_value(list->as.items[i], out);
+}
+
+static ObjMap* expect_map(const char *name, Value v) {
+    if (v.type != VAL_MAP) {
+        fprintf(stderr, "Runtime Error: '%s' expects a map.\n", name);
+        return NULL;
+    }
+    return v.as.map;
+}
+
+static int expect_key(const char *name, Value v) {
+    if (!map_valid_key(v)) {
+        fprintf(stderr, "Runtime Error: '%s' expects a number or string key.\n", name);
+        return 0;
+    }
+    return 1;
+}
+
+static int expect_number(const char *name, Value v) {
+    if (!is_number(v)) {
+        fprintf(stderr, "Runtime Error: '%s' expects a number.\n", name);
+        return 0;
+    }
+    return 1;
+}
+
+static int expect_integer(const char *name, Value v) {
+    if (v.type != VAL_NUMBER) {
+        fprintf(stderr, "Runtime Error: '%s' expects an integer.\n", name);
+        return 0;
+    }
+    return 1;
+}
+
+// Numbers compare by value across integers and decimals, as '==' does
+static int values_equal(Value a, Value b) {
+    if (a.type != b.type) {
+        if (!is_number(a) || !is_number(b)) return 0;
+        Num l, r, eq;
+        NumKind lk = num_from_value(a, &l);
+        NumKind rk = num_from_value(b, &r);
+        num_op(lk, l, TOKEN_EQ_EQ, rk, r, &eq);
+        return (int)eq.i;
+    }
+    switch (a.type) {
+        case VAL_NUMBER: return a.as.number == b.as.number;
+        case VAL_DECIMAL: return a.as.decimal == b.as.decimal;
+        case VAL_STRING:
+            return string_length(&a) == string_length(&b) &&
+                   memcmp(string_chars(&a), string_chars(&b), string_length(&a)) == 0;
+        case VAL_LIST: return a.as.list == b.as.list;
+        case VAL_MAP: return a.as.map == b.as.map;
+        case VAL_NATIVE: return a.as.native == b.as.native;
+        case VAL_READER: return a.as.reader == b.as.reader;
+        case VAL_FUNCTION: return a.as.function.declaration == b.as.function.declaration;
+        case VAL_CLOSURE: return a.as.closure == b.as.closure;
+        case VAL_NULL: return 1;
+    }
+    return 0;
+}
+
+// --- Builtins ---
+
+// panjang(xs): number of elements or entries, or bytes for a string
+static int bi_panjang(Value *args, int argc, Value *out) {
+    if (!expect_args("panjang", argc, 1)) return 0;
+    if (args[0].type == VAL_STRING) {
+        *out = make_number((int)string_length(&args[0]));
+        return 1;
+    }
+    if (args[0].type == VAL_MAP) {
+        *out = make_number(args[0].as.map->count);
+        return 1;
+    }
+    ObjList *list = expect_list("panjang", args[0]);
+    if (!list) return 0;
+    *out = make_number(list->count);
+    return 1;
+}
+
+static int bi_jumlah(Value *args, int argc, Value *out) {
+    if (!expect_args("jumlah", argc, 1)) return 0;
+    ObjList *list = expect_numeric_list("jumlah", args[0]);
+    if (!list) return 0;
+    if (list->numeric) {
+        int64_t sum;
+        double approx;
+        *out = vec_sum(list->as.numbers, list->count, &sum, &approx) ? make_number(sum)
+                                                                    : make_decimal(approx);
+        return 1;
+    }
+    Num acc = {.i = 0};
+    NumKind kind = NUM_INT;
+    for (int i = 0; i < list->count; i++) {
+        Num x;
+        NumKind xk = list_num(list, i, &x);
+        kind = num_op(kind, acc, TOKEN_PLUS, xk, x, &acc);
+    }
+    *out = num_to_value(kind, acc);
+    return 1;
+}
+
+// Smallest (less = TOKEN_LT) or largest (TOKEN_GT) element, null when empty
+static int list_extreme(const char *name, Value *args, int argc, Value *out, TokenType better) {
+    if (!expect_args(name, argc, 1)) return 0;
+    ObjList *list = expect_numeric_list(name, args[0]);
+    if (!list) return 0;
+    if (list->count == 0) {
+        *out = make_null();
+    } else if (list->numeric) {
+        *out = make_number(better == TOKEN_LT ? vec_min(list->as.numbers, list->count)
+                                              : vec_max(list->as.numbers, list->count));
+    } else {
+        Value best = list->as.items[0];
+        for (int i = 1; i < list->count; i++) {
+            Num x, b, wins;
+            NumKind xk = num_from_value(list->as.items[i], &x);
+            NumKind bk = num_from_value(best, &b);
+            num_op(xk, x, better, bk, b, &wins);
+            if (wins.i) best = list->as.items[i];
+        }
+        *out = best;
+    }
+    return 1;
+}
+
+static int bi_minimum(Value *args, int argc, Value *out) {
+    return list_extreme("minimum", args, argc, out, TOKEN_LT);
+}
+
+static int bi_maksimum(Value *args, int argc, Value *out) {
+    return list_extreme("maksimum", args, argc, out, TOKEN_GT);
+}
+
+// hitung(xs, v): occurrences of v
+static int bi_hitung(Value *args, int argc, Value *out) {
+    if (!expect_args("hitung", argc, 2)) return 0;
+    ObjList *list = expect_list("hitung", args[0]);
+    if (!list) return 0;
+
+    if (list->numeric) {
+        int count = 0;
+        if (args[1].type == VAL_NUMBER) {
+            count = vec_count_eq(list->as.numbers, list->count, args[1].as.number);
+        } else if (args[1].type == VAL_DECIMAL) {
+            for (int i = 0; i < list->count; i++) {
+                count += values_equal(make_number(list->as.numbers[i]), args[1]);
+            }
+        }
+        *out = make_number(count);
+        return 1;
+    }
+    int count = 0;
+    for (int i = 0; i < list->count; i++) {
+        count += values_equal(list->as.items[i], args[1]);
+    }
+    *out = make_number(count);
+    return 1;
+}
+
+// skala(xs, k): new list with every element multiplied by k
+static int bi_skala(Value *args, int argc, Value *out) {
+    if (!expect_args("skala", argc, 2)) return 0;
+    ObjList *src = expect_numeric_list("skala", args[0]);
+    if (!src || !expect_number("skala", args[1])) return 0;
+
+    ObjList *dst = list_new(src->count); // args[] stays rooted, so src survives
+    if (src->numeric && args[1].type == VAL_NUMBER &&
+        vec_scale(dst->as.numbers, src->as.numbers, src->count, args[1].as.number)) {
+        dst->count = src->count;
+        *out = make_list(dst);
+        return 1;
+    }
+
+    // Decimals involved or a product overflowed: element by element
+    Num k;
+    NumKind kk = num_from_value(args[1], &k);
+    for (int i = 0; i < src->count; i++) {
+        Num x, product;
+        NumKind xk = list_num(src, i, &x);
+        NumKind pk = num_op(xk, x, TOKEN_STAR, kk, k, &product);
+        list_append(dst, num_to_value(pk, product));
+    }
+    *out = make_list(dst);
+    return 1;
+}
+
+static int bi_dot(Value *args, int argc, Value *out) {
+    if (!expect_args("dot", argc, 2)) return 0;
+    ObjList *xs = expect_numeric_list("dot", args[0]);
+    ObjList *ys = xs ? expect_numeric_list("dot", args[1]) : NULL;
+    if (!ys) return 0;
+    if (xs->count != ys->count) {
+        fprintf(stderr, "Runtime Error: 'dot' expects lists of equal length.\n");
+        return 0;
+    }
+    int64_t dot;
+    if (xs->numeric && ys->numeric && vec_dot(xs->as.numbers, ys->as.numbers, xs->count, &dot)) {
+        *out = make_number(dot);
+        return 1;
+    }
+
+    // Decimals involved or the integer result overflowed: element by element
+    Num acc = {.i = 0};
+    NumKind kind = NUM_INT;
+    for (int i = 0; i < xs->count; i++) {
+        Num x, y, product;
+        NumKind xk = list_num(xs, i, &x);
+        NumKind yk = list_num(ys, i, &y);
+        NumKind pk = num_op(xk, x, TOKEN_STAR, yk, y, &product);
+        kind = num_op(kind, acc, TOKEN_PLUS, pk, product, &acc);
+    }
+    *out = num_to_value(kind, acc);
+    return 1;
+}
+
+// rentang(a, b): [a, a+1, ..., b]
+static int bi_rentang(Value *args, int argc, Value *out) {
+    if (!expect_args("rentang", argc, 2)) return 0;
+    if (!expect_integer("rentang", args[0]) || !expect_integer("rentang", args[1])) return 0;
+
+    int64_t from = args[0].as.number;
+    int64_t to = args[1].as.number;
+    if (to >= from && (uint64_t)to - (uint64_t)from >= INT_MAX) {
+        fprintf(stderr, "Runtime Error: 'rentang' terlalu besar.\n");
+        return 0;
+    }
+    int count = to >= from ? (int)(to - from + 1) : 0;
+    ObjList *list = list_new(count);
+    for (int i = 0; i < count; i++) {
+        list->as.numbers[i] = from + i;
+    }
+    list->count = count;
+    *out = make_list(list);
+    return 1;
+}
+
+// tambahkan(xs, v): appends in place and returns xs
+static int bi_tambahkan(Value *args, int argc, Value *out) {
+    if (!expect_args("tambahkan", argc, 2)) return 0;
+    ObjList *list = expect_list("tambahkan", args[0]);
+    if (!list) return 0;
+    list_append(list, args[1]);
+    *out = args[0];
+    return 1;
+}
+
+// ambil(m, k) or ambil(m, k, default): missing keys give null or the default
+static int bi_ambil(Value *args, int argc, Value *out) {
+    if (argc != 3 && !expect_args("ambil", argc, 2)) return 0;
+    ObjMap *map = expect_map("ambil", args[0]);
+    if (!map || !expect_key("ambil", args[1])) return 0;
+    if (!map_get(map, args[1], out)) {
+        *out = argc == 3 ? args[2] : make_null();
+    }
+    return 1;
+}
+
+// atur(m, k, v): inserts or overwrites in place and returns m
+static int bi_atur(Value *args, int argc, Value *out) {
+    if (!expect_args("atur", argc, 3)) return 0;
+    ObjMap *map = expect_map("atur", args[0]);
+    if (!map || !expect_key("atur", args[1])) return 0;
+    map_set(map, args[1], args[2]);
+    *out = args[0];
+    return 1;
+}
+
+static int bi_punya(Value *args, int argc, Value *out) {
+    if (!expect_args("punya", argc, 2)) return 0;
+    ObjMap *map = expect_map("punya", args[0]);
+    if (!map) return 0;
+    Value ignored;
+    *out = make_number(map_get(map, args[1], &ignored));
+    return 1;
+}
+
+// hapus(m, k): 1 if the key was present
+static int bi_hapus(Value *args, int argc, Value *out) {
+    if (!expect_args("hapus", argc, 2)) return 0;
+    ObjMap *map = expect_map("hapus", args[0]);
+    if (!map) return 0;
+    *out = make_number(map_delete(map, args[1]));
+    return 1;
+}
+
+// kunci(m) / nilai(m): keys or values as a list, in insertion order
+static int map_column(const char *name, Value *args, int argc, Value *out, int want_keys) {
+    if (!expect_args(name, argc, 1)) return 0;
+    ObjMap *map = expect_map(name, args[0]);
+    if (!map) return 0;
+
+    ObjList *list = list_new(map->count); // The map stays rooted through args[]
+    for (int i = 0; i < map->entry_count; i++) {
+        MapEntry *e = &map->entries[i];
+        if (e->key.type == VAL_NULL) continue;
+        list_append(list, want_keys ? e->key : e->value);
+    }
+    *out = make_list(list);
+    return 1;
+}
+
+static int bi_kunci(Value *args, int argc, Value *out) {
+    return map_column("kunci", args, argc, out, 1);
+}
+
+static int bi_nilai(Value *args, int argc, Value *out) {
+    return map_column("nilai", args, argc, out, 0);
+}
+
+// --- Conversion ---
+
+// tipe(x): type name as a string
+static int bi_tipe(Value *args, int argc, Value *out) {
+    if (!expect_args("tipe", argc, 1)) return 0;
+    const char *name = "kosong";
+    switch (args[0].type) {
+        case VAL_NUMBER: name = "angka"; break;
+        case VAL_DECIMAL: name = "desimal"; break;
+        case VAL_STRING: name = "teks"; break;
+        case VAL_FUNCTION:
+        case VAL_CLOSURE:
+        case VAL_NATIVE: name = "fungsi"; break;
+        case VAL_LIST: name = "list"; break;
+        case VAL_MAP: name = "map"; break;
+        case VAL_READER: name = "pembaca"; break;
+        case VAL_NULL: break;
+    }
+    *out = make_string(name);
+    return 1;
+}
+
+// teks(x): decimal text of a number; strings pass through
+static int bi_teks(Value *args, int argc, Value *out) {
+    if (!expect_args("teks", argc, 1)) return 0;
+    if (args[0].type == VAL_STRING) {
+        *out = args[0];
+        return 1;
+    }
+    if (!expect_number("teks", args[0])) return 0;
+    char buf[32];
+    int len = args[0].type == VAL_DECIMAL
+            ? format_decimal(args[0].as.decimal, buf, sizeof(buf))
+            : snprintf(buf, sizeof(buf), "%lld", (long long)args[0].as.number);
+    *out = make_string_n(buf, len);
+    return 1;
+}
+
+// angka(s): parses an integer or a decimal, null if the text is neither.
+// Integers too large for 64 bits come back as decimals, as literals do.
+static int bi_angka(Value *args, int argc, Value *out) {
+    if (!expect_args("angka", argc, 1)) return 0;
+    if (is_number(args[0])) {
+        *out = args[0];
+        return 1;
+    }
+    if (args[0].type != VAL_STRING) {
+        fprintf(stderr, "Runtime Error: 'angka' expects a string.\n");
+        return 0;
+    }
+
+    // Strings are not NUL-terminated; anything longer than this is out of range anyway
+    size_t length = string_length(&args[0]);
+    char text[64];
+    if (length >= sizeof(text)) {
+        *out = make_null();
+        return 1;
+    }
+    memcpy(text, string_chars(&args[0]), length);
+    text[length] = '\0';
+
+    char *end;
+    errno = 0;
+    long long n = strtoll(text, &end, 10);
+    if (end != text && *end == '\0' && errno != ERANGE) {
+        *out = make_number(n);
+        return 1;
+    }
+    // strtod also takes hex, exponents, "inf" and "nan"; only digits and '.' count here
+    const char *digits = text + (text[0] == '-' || text[0] == '+');
+    int plain = strspn(digits, "0123456789.") == strlen(digits);
+    double d = strtod(text, &end);
+    if (plain && end != text && *end == '\0' && isfinite(d)) {
+        *out = make_decimal(d);
+    } else {
+        *out = make_null();
+    }
+    return 1;
+}
+
+// --- Input ---
+
+// Stdin is shared by every masukan() call so buffered input is never lost
+static Value stdin_reader;
+
+static ObjReader* expect_reader(const char *name, Value v) {
+    if (v.type != VAL_READER) {
+        fprintf(stderr, "Runtime Error: '%s' expects a reader.\n", name);
+        return NULL;
+    }
+    return v.as.reader;
+}
+
+// masukan(): reader over standard input
+static int bi_masukan(Value *args, int argc, Value *out) {
+    (void)args;
+    if (!expect_args("masukan", argc, 0)) return 0;
+    if (stdin_reader.type != VAL_READER) stdin_reader = make_reader(reader_stdin());
+    *out = stdin_reader;
+    return 1;
+}
+
+// buka(path): reader over a file, null if it cannot be opened
+static int bi_buka(Value *args, int argc, Value *out) {
+    if (!expect_args("buka", argc, 1)) return 0;
+    if (args[0].type != VAL_STRING) {
+        fprintf(stderr, "Runtime Error: 'buka' expects a path string.\n");
+        return 0;
+    }
+    size_t length = string_length(&args[0]);
+    char *path = malloc(length + 1); // Not NUL-terminated in the Value
+    memcpy(path, string_chars(&args[0]), length);
+    path[length] = '\0';
+
+    ObjReader *reader = reader_open(path);
+    free(path);
+    *out = reader ? make_reader(reader) : make_null();
+    return 1;
+}
+
+// baca_baris(r): next line, or null at end of input
+static int bi_baca_baris(Value *args, int argc, Value *out) {
+    if (!expect_args("baca_baris", argc, 1)) return 0;
+    ObjReader *reader = expect_reader("baca_baris", args[0]);
+    if (!reader) return 0;
+    if (!reader_next_line(reader, out)) *out = make_null();
+    return 1;
+}
+
+// hitung_baris(r): counts (and consumes) the remaining lines
+static int bi_hitung_baris(Value *args, int argc, Value *out) {
+    if (!expect_args("hitung_baris", argc, 1)) return 0;
+    ObjReader *reader = expect_reader("hitung_baris", args[0]);
+    if (!reader) return 0;
+    *out = make_number((int64_t)reader_count_lines(reader));
+    return 1;
+}
+
+static int bi_tutup(Value *args, int argc, Value *out) {
+    if (!expect_args("tutup", argc, 1)) return 0;
+    ObjReader *reader = expect_reader("tutup", args[0]);
+    if (!reader) return 0;
+    reader_close(reader);
+    *out = make_null();
+    return 1;
+}
+
+// --- Time ---
+
+// waktu(): seconds since the Unix epoch
+static int bi_waktu(Value *args, int argc, Value *out) {
+    (void)args;
+    if (!expect_args("waktu", argc, 0)) return 0;
+    *out = make_number((int64_t)time(NULL));
+    return 1;
+}
+
+// waktu_ms(): monotonic milliseconds, for measuring durations
+static int bi_waktu_ms(Value *args, int argc, Value *out) {
+    (void)args;
+    if (!expect_args("waktu_ms", argc, 0)) return 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    *out = make_number((int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+    return 1;
+}
+
+// --- Math ---
+
+static int bi_mutlak(Value *args, int argc, Value *out) {
+    if (!expect_args("mutlak", argc, 1) || !expect_number("mutlak", args[0])) return 0;
+    if (args[0].type == VAL_DECIMAL) {
+        *out = make_decimal(fabs(args[0].as.decimal));
+        return 1;
+    }
+    int64_t n = args[0].as.number;
+    if (n == INT64_MIN) *out = make_decimal(-(double)n); // The one integer without a negation
+    else *out = make_number(n < 0 ? -n : n);
+    return 1;
+}
+
+// akar(n): integer square root rounded down for integers, sqrt for decimals
+static int bi_akar(Value *args, int argc, Value *out) {
+    if (!expect_args("akar", argc, 1) || !expect_number("akar", args[0])) return 0;
+    if (args[0].type == VAL_DECIMAL ? args[0].as.decimal < 0 : args[0].as.number < 0) {
+        fprintf(stderr, "Runtime Error: 'akar' of a negative number.\n");
+        return 0;
+    }
+    if (args[0].type == VAL_DECIMAL) {
+        *out = make_decimal(sqrt(args[0].as.decimal));
+        return 1;
+    }
+    // Newton's iteration from above converges monotonically to floor(sqrt(n));
+    // the first step is ceil(n / 2) written so it cannot overflow
+    int64_t n = args[0].as.number;
+    int64_t x = n;
+    int64_t y = n / 2 + n % 2;
+    while (y < x) {
+        x = y;
+        y = (x + n / x) / 2;
+    }
+    *out = make_number(x);
+    return 1;
+}
+
+// pangkat(a, b): a to the integer power b >= 0. An integer result that
+// overflows becomes a decimal, like '*'.
+static int bi_pangkat(Value *args, int argc, Value *out) {
+    if (!expect_args("pangkat", argc, 2)) return 0;
+    if (!expect_number("pangkat", args[0]) || !expect_integer("pangkat", args[1])) return 0;
+    int64_t exp = args[1].as.number;
+    if (exp < 0) {
+        fprintf(stderr, "Runtime Error: 'pangkat' expects a non-negative exponent.\n");
+        return 0;
+    }
+    if (args[0].type == VAL_NUMBER) {
+        int64_t base = args[0].as.number;
+        int64_t result = 1;
+        int64_t e = exp;
+        int overflow = 0;
+        while (e > 0 && !overflow) {
+            if (e & 1) overflow |= __builtin_mul_overflow(result, base, &result);
+            e >>= 1;
+            if (e > 0) overflow |= __builtin_mul_overflow(base, base, &base);
+        }
+        if (!overflow) {
+            *out = make_number(result);
+            return 1;
+        }
+    }
+    Num base;
+    NumKind kind = num_from_value(args[0], &base);
+    *out = make_decimal(pow(num_as_double(kind, base), (double)exp));
+    return 1;
+}
+
+// --- Registry ---
+
+#define MAX_NATIVES 256
+
+// Fixed storage: installed Values point into this table
+static NativeDef natives[MAX_NATIVES];
+static int native_count = 0;
+static int natives_registered = 0;
+
+static const NativeDef core_natives[] = {
+    // Lists
+    {"panjang", bi_panjang},
+    {"jumlah", bi_jumlah},
+    {"minimum", bi_minimum},
+    {"maksimum", bi_maksimum},
+    {"hitung", bi_hitung},
+    {"skala", bi_skala},
+    {"dot", bi_dot},
+    {"rentang", bi_rentang},
+    {"tambahkan", bi_tambahkan},
+    // Maps
+    {"ambil", bi_ambil},
+    {"atur", bi_atur},
+    {"punya", bi_punya},
+    {"hapus", bi_hapus},
+    {"kunci", bi_kunci},
+    {"nilai", bi_nilai},
+    // Conversion
+    {"tipe", bi_tipe},
+    {"teks", bi_teks},
+    {"angka", bi_angka},
+    // Input
+    {"masukan", bi_masukan},
+    {"buka", bi_buka},
+    {"baca_baris", bi_baca_baris},
+    {"hitung_baris", bi_hitung_baris},
+    {"tutup", bi_tutup},
+    // Time
+    {"waktu", bi_waktu},
+    {"waktu_ms", bi_waktu_ms},
+    // Math
+    {"mutlak", bi_mutlak},
+    {"akar", bi_akar},
+    {"pangkat", bi_pangkat},
+    {NULL, NULL}
+};
+
+// Natives defined outside this file, registered with the core ones so that
+// the table is complete for natives_install and for native_lookup alike
+// (--emit-c looks names up without ever starting the evaluator)
+static void (*const module_inits[])(void) = {
+    evaluator_register_natives, // Tasks
+    parallel_init,
+    text_init,
+};
+
+static void register_natives() {
+    if (natives_registered) return;
+    natives_registered = 1;
+    for (const NativeDef *d = core_natives; d->name; d++) {
+        native_register(d->name, d->fn);
+    }
+    for (size_t i = 0; i < sizeof(module_inits) / sizeof(module_inits[0]); i++) {
+        module_inits[i]();
+    }
+}
+
+int native_register(const char *name, NativeFn fn) {
+    if (native_count >= MAX_NATIVES) return 0;
+    natives[native_count].name = name;
+    natives[native_count].fn = fn;
+    native_count++;
+    return 1;
+}
+
+void natives_install(Environment *env) {
+    register_natives();
+    stdin_reader = make_null();
+    gc_add_root(&stdin_reader);
+    for (int i = 0; i < native_count; i++) {
+        env_set(env, natives[i].name, make_native(&natives[i]));
+    }
+}
+
+const NativeDef* native_lookup(const char *name) {
+    register_natives();
+    for (int i = 0; i < native_count; i++) {
+        if (strcmp(natives[i].name, name) == 0) return &natives[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,678 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compiler.h"
+#include "evaluator.h"
+#include "gc.h"
+#include "jit.h"
+#include "list.h"
+#include "builtins.h"
+#include "snapshot.h"
+#include "parser.h"
+#include "num.h"
+
+typedef int (*EvalFn)(Code *self, Environment *env, Value *out);
+typedef int (*ExecFn)(Code *self, Environment *env, Value *ret); // 1 = 'kembali' fired
+typedef NumKind (*IntEvalFn)(Code *self, Environment *env, Num *out); // STATIC_INT trees
+
+struct Code {
+    union {
+        EvalFn eval;
+        ExecFn exec;
+        IntEvalFn ieval;
+    } fn;
+    ASTNode *node; // Source node, used by tree-walker fallbacks
+    union {
+        Value constant;
+        const char *name;
+        struct { Code *left; Code *right; TokenType op; } binary;
+        struct { const char *callee; Code **args; int argc; } call;
+        struct { Code **items; int count; } list;
+        struct { const char *name; Code *value; } decl;
+        struct { Code *expr; } unary;
+        struct { Code *cond; Code *then_branch; } branch;
+        struct { const char *name; Code *start; Code *end; Code *body; } repeat;
+        struct { Code **stmts; int count; } block;
+        struct { Code *body; const char **params; int param_count; } function;
+    } as;
+    void *owned;    // Operand array allocated for this node
+    Code *all_next; // Every Code node, for cleanup
+};
+
+static Code *all_code = NULL;
+
+static Code* new_code(ASTNode *node) {
+    Code *c = calloc(1, sizeof(Code));
+    c->node = node;
+    c->all_next = all_code;
+    all_code = c;
+    return c;
+}
+
+static Code* compile_expr(ASTNode *node);
+static Code* compile_int(ASTNode *node);
+static Code* compile_stmt(ASTNode *node);
+
+// --- Expressions ---
+
+static int cc_constant(Code *self, Environment *env, Value *out) {
+    (void)env;
+    *out = self->as.constant;
+    return 1;
+}
+
+static int cc_var(Code *self, Environment *env, Value *out) {
+    if (!env_get(env, self->as.name, out)) {
+        fprintf(stderr, "Runtime Error: Variable '%s' not defined.\n", self->as.name);
+        return 0;
+    }
+    return 1;
+}
+
+static int eval_operands(Code *self, Environment *env, Value *l, Value *r) {
+    Code *left = self->as.binary.left;
+    Code *right = self->as.binary.right;
+    if (!left->fn.eval(left, env, l)) return 0;
+
+    gc_push_root(*l);
+    int ok = right->fn.eval(right, env, r);
+    gc_pop_roots(1);
+    return ok;
+}
+
+static int binary_slow(Value l, TokenType op, Value r, Value *out) {
+    gc_push_root(l);
+    gc_push_root(r);
+    *out = eval_binary_op(l, op, r);
+    gc_pop_roots(2);
+    return 1;
+}
+
+// Integer fast paths over x and y: store the result in n and yield 1, or
+// yield 0 when num.h must decide (overflow, division by zero)
+#define FAST_ADD !__builtin_add_overflow(x, y, &n)
+#define FAST_SUB !__builtin_sub_overflow(x, y, &n)
+#define FAST_MUL !__builtin_mul_overflow(x, y, &n)
+#define FAST_DIV (y != 0 && !(x == INT64_MIN && y == -1) && ((n = x / y), 1))
+#define FAST_CMP(op) ((n = x op y), 1)
+
+// One specialized closure per operator: the integer case is inlined and
+// everything else goes through the shared eval_binary_op.
+#define DEFINE_BINARY(name, tok, fast)                                   \
+    static int name(Code *self, Environment *env, Value *out) {          \
+        Value lv, rv;                                                    \
+        if (!eval_operands(self, env, &lv, &rv)) return 0;               \
+        if (lv.type == VAL_NUMBER && rv.type == VAL_NUMBER) {            \
+            int64_t x = lv.as.number, y = rv.as.number, n;               \
+            if (fast) {                                                  \
+                *out = make_number(n);                                   \
+                return 1;                                                \
+            }                                                            \
+        }                                                                \
+        return binary_slow(lv, tok, rv, out);                            \
+    }
+
+DEFINE_BINARY(cc_add, TOKEN_PLUS, FAST_ADD)
+DEFINE_BINARY(cc_sub, TOKEN_MINUS, FAST_SUB)
+DEFINE_BINARY(cc_mul, TOKEN_STAR, FAST_MUL)
+DEFINE_BINARY(cc_div, TOKEN_SLASH, FAST_DIV)
+DEFINE_BINARY(cc_lt, TOKEN_LT, FAST_CMP(<))
+DEFINE_BINARY(cc_gt, TOKEN_GT, FAST_CMP(>))
+DEFINE_BINARY(cc_le, TOKEN_LT_EQ, FAST_CMP(<=))
+DEFINE_BINARY(cc_ge, TOKEN_GT_EQ, FAST_CMP(>=))
+DEFINE_BINARY(cc_eq, TOKEN_EQ_EQ, FAST_CMP(==))
+DEFINE_BINARY(cc_ne, TOKEN_BANG_EQ, FAST_CMP(!=))
+
+// Numeric trees (infer.c) run on raw Nums; only the root boxes its result
+static NumKind ci_constant(Code *self, Environment *env, Num *out) {
+    (void)env;
+    out->i = self->as.constant.as.number;
+    return NUM_INT;
+}
+
+static NumKind ci_var(Code *self, Environment *env, Num *out) {
+    Value val;
+    if (!cc_var(self, env, &val)) return NUM_FAIL;
+    // Proven a number, unless it is the null left by a reported error
+    if (val.type != VAL_NUMBER && val.type != VAL_DECIMAL) return NUM_NULL;
+    return num_from_value(val, out);
+}
+
+static NumKind ci_boxed(Code *self, Environment *env, Num *out) {
+    Code *e = self->as.unary.expr;
+    Value val;
+    if (!e->fn.eval(e, env, &val)) return NUM_FAIL;
+    if (val.type != VAL_NUMBER && val.type != VAL_DECIMAL) return NUM_NULL;
+    return num_from_value(val, out);
+}
+
+#define DEFINE_INT_BINARY(name, tok, fast)                               \
+    static NumKind name(Code *self, Environment *env, Num *out) {        \
+        Code *left = self->as.binary.left;                               \
+        Code *right = self->as.binary.right;                             \
+        Num l, r;                                                        \
+        NumKind lk = left->fn.ieval(left, env, &l);                      \
+        if (!lk) return NUM_FAIL;                                        \
+        NumKind rk = right->fn.ieval(right, env, &r);                    \
+        if (!rk) return NUM_FAIL;                                        \
+        if (lk == NUM_NULL || rk == NUM_NULL) return NUM_NULL;           \
+        if (lk == NUM_INT && rk == NUM_INT) {                            \
+            int64_t x = l.i, y = r.i, n;                                 \
+            if (fast) {                                                  \
+                out->i = n;                                              \
+                return NUM_INT;                                          \
+            }                                                            \
+        }                                                                \
+        NumKind kind = num_op(lk, l, tok, rk, r, out);                   \
+        return kind ? kind : NUM_NULL;                                   \
+    }
+
+DEFINE_INT_BINARY(ci_add, TOKEN_PLUS, FAST_ADD)
+DEFINE_INT_BINARY(ci_sub, TOKEN_MINUS, FAST_SUB)
+DEFINE_INT_BINARY(ci_mul, TOKEN_STAR, FAST_MUL)
+DEFINE_INT_BINARY(ci_div, TOKEN_SLASH, FAST_DIV)
+DEFINE_INT_BINARY(ci_lt, TOKEN_LT, FAST_CMP(<))
+DEFINE_INT_BINARY(ci_gt, TOKEN_GT, FAST_CMP(>))
+DEFINE_INT_BINARY(ci_le, TOKEN_LT_EQ, FAST_CMP(<=))
+DEFINE_INT_BINARY(ci_ge, TOKEN_GT_EQ, FAST_CMP(>=))
+DEFINE_INT_BINARY(ci_eq, TOKEN_EQ_EQ, FAST_CMP(==))
+DEFINE_INT_BINARY(ci_ne, TOKEN_BANG_EQ, FAST_CMP(!=))
+
+static IntEvalFn int_binary_fn(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: return ci_add;
+        case TOKEN_MINUS: return ci_sub;
+        case TOKEN_STAR: return ci_mul;
+        case TOKEN_SLASH: return ci_div;
+        case TOKEN_LT: return ci_lt;
+        case TOKEN_GT: return ci_gt;
+        case TOKEN_LT_EQ: return ci_le;
+        case TOKEN_GT_EQ: return ci_ge;
+        case TOKEN_EQ_EQ: return ci_eq;
+        default: return ci_ne;
+    }
+}
+
+static int cc_int_root(Code *self, Environment *env, Value *out) {
+    Code *e = self->as.unary.expr;
+    Num n;
+    NumKind kind = e->fn.ieval(e, env, &n);
+    if (!kind) return 0;
+    *out = num_to_value(kind, n);
+    return 1;
+}
+
+static int cc_binary_generic(Code *self, Environment *env, Value *out) {
+    Value lv, rv;
+    if (!eval_operands(self, env, &lv, &rv)) return 0;
+    return binary_slow(lv, self->as.binary.op, rv, out);
+}
+
+static EvalFn binary_fn(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: return cc_add;
+        case TOKEN_MINUS: return cc_sub;
+        case TOKEN_STAR: return cc_mul;
+        case TOKEN_SLASH: return cc_div;
+        case TOKEN_LT: return cc_lt;
+        case TOKEN_GT: return cc_gt;
+        case TOKEN_LT_EQ: return cc_le;
+        case TOKEN_GT_EQ: return cc_ge;
+        case TOKEN_EQ_EQ: return cc_eq;
+        case TOKEN_BANG_EQ: return cc_ne;
+        default: return cc_binary_generic;
+    }
+}
+
+static Code* compile_function(FuncDeclNode *decl) {
+    if (decl->image_body) snapshot_materialize(decl);
+    if (decl->lazy_body) parser_materialize(decl);
+    Code *c = new_code((ASTNode*)decl);
+
+    int count = 0;
+    for (ASTNode *p = decl->params; p; p = p->next) count++;
+    c->as.function.params = malloc(sizeof(char*) * (count ? count : 1));
+    c->owned = c->as.function.params;
+    c->as.function.param_count = count;
+
+    int i = 0;
+    for (ASTNode *p = decl->params; p; p = p->next) {
+        c->as.function.params[i++] = ((VarAccessNode*)p)->name;
+    }
+
+    // Publish before compiling the body so recursive calls find it
+    decl->compiled = c;
+    c->as.function.body = compile_stmt(decl->body);
+    return c;
+}
+
+static int call_native(Code *self, const NativeDef *native, Environment *env, Value *out) {
+    int n = self->as.call.argc;
+    Value small_args[JIT_MAX_PARAMS];
+    Value *args = n <= JIT_MAX_PARAMS ? small_args : malloc(sizeof(Value) * n);
+    for (int i = 0; i < n; i++) {
+        Code *arg = self->as.call.args[i];
+        if (!arg->fn.eval(arg, env, &args[i])) args[i] = make_null();
+        gc_push_root(args[i]);
+    }
+
+    int ok = native->fn(args, n, out);
+    gc_pop_roots(n);
+    if (args != small_args) free(args);
+    return ok;
+}
+
+static int cc_call(Code *self, Environment *env, Value *out) {
+    const char *callee = self->as.call.callee;
+    Value func_val;
+    if (!env_get(env, callee, &func_val)) {
+        fprintf(stderr, "Runtime Error: Function '%s' not defined.\n", callee);
+        return 0;
+    }
+    if (func_val.type == VAL_NATIVE) {
+        return call_native(self, func_val.as.native, env, out);
+    }
+    if (func_val.type != VAL_FUNCTION && func_val.type != VAL_CLOSURE) {
+        fprintf(stderr, "Runtime Error: '%s' is not a function.\n", callee);
+        return 0;
+    }
+
+    ObjClosure *closure = func_val.type == VAL_CLOSURE ? func_val.as.closure : NULL;
+    FuncDeclNode *decl = (FuncDeclNode*)(closure ? closure->declaration : func_val.as.function.declaration);
+    Code *fn = decl->compiled ? decl->compiled : compile_function(decl);
+    if (closure) gc_push_root(func_val); // Its binding may change while arguments run
+
+    int n = self->as.call.argc;
+    if (n > fn->as.function.param_count) n = fn->as.function.param_count;
+
+    Value small_args[JIT_MAX_PARAMS];
+    Value *args = n <= JIT_MAX_PARAMS ? small_args : malloc(sizeof(Value) * n);
+    for (int i = 0; i < n; i++) {
+        Code *arg = self->as.call.args[i];
+        if (!arg->fn.eval(arg, env, &args[i])) args[i] = make_null();
+        gc_push_root(args[i]);
+    }
+
+    compiled_call(decl, closure, args, n, out);
+    gc_pop_roots(n + (closure ? 1 : 0));
+    if (args != small_args) free(args);
+    return 1;
+}
+
+void compiled_call(FuncDeclNode *decl, ObjClosure *closure, Value *args, int argc, Value *out) {
+    Code *fn = decl->compiled ? decl->compiled : compile_function(decl);
+    if (argc > fn->as.function.param_count) argc = fn->as.function.param_count;
+
+    if (!closure && jit_try_call(decl, args, argc, out)) return;
+
+    Environment *func_env = env_create(evaluator_global_env());
+    if (closure) evaluator_bind_captures(func_env, closure);
+    for (int i = 0; i < argc; i++) {
+        env_set(func_env, fn->as.function.params[i], args[i]);
+    }
+
+    Code *body = fn->as.function.body;
+    Value ret;
+    int returned = body->fn.exec(body, func_env, &ret);
+    env_free(func_env);
+
+    *out = returned ? ret : make_null();
+}
+
+static int cc_list(Code *self, Environment *env, Value *out) {
+    int count = self->as.list.count;
+    ObjList *list = list_new(count);
+    gc_push_root(make_list(list));
+    for (int i = 0; i < count; i++) {
+        Code *item = self->as.list.items[i];
+        Value v;
+        if (!item->fn.eval(item, env, &v)) v = make_null();
+        list_append(list, v);
+    }
+    gc_pop_roots(1);
+    *out = make_list(list);
+    return 1;
+}
+
+static int cc_index(Code *self, Environment *env, Value *out) {
+    Value target, index;
+    if (!eval_operands(self, env, &target, &index)) return 0;
+
+    // Fast path: unboxed list with an in-range index
+    if (target.type == VAL_LIST && index.type == VAL_NUMBER) {
+        ObjList *list = target.as.list;
+        int64_t i = index.as.number;
+        if (list->numeric && i >= 0 && i < list->count) {
+            *out = make_number(list->as.numbers[i]);
+            return 1;
+        }
+    }
+    return index_value(target, index, out);
+}
+
+static int cc_interp(Code *self, Environment *env, Value *out) {
+    int count = self->as.list.count;
+    Value small_parts[8];
+    Value *parts = count <= 8 ? small_parts : malloc(sizeof(Value) * count);
+    int done = 0;
+    for (; done < count; done++) {
+        Code *part = self->as.list.items[done];
+        if (!part->fn.eval(part, env, &parts[done])) break;
+        gc_push_root(parts[done]);
+    }
+    int ok = done == count;
+    if (ok) *out = join_values(parts, count);
+    gc_pop_roots(done);
+    if (parts != small_parts) free(parts);
+    return ok;
+}
+
+static int cc_expr_fallback(Code *self, Environment *env, Value *out) {
+    return evaluator_eval_node(self->node, env, out);
+}
+
+static Code* compile_expr(ASTNode *node) {
+    Code *c = new_code(node);
+    if (!node) {
+        c->fn.eval = cc_expr_fallback; // Reports nothing and fails, like the tree walker
+        return c;
+    }
+
+    switch (node->type) {
+        case NODE_LITERAL: {
+            LiteralNode *l = (LiteralNode*)node;
+            c->fn.eval = cc_constant;
+            c->as.constant = l->type == TOKEN_STRING  ? make_string_obj(l->string_obj)
+                           : l->type == TOKEN_DECIMAL ? make_decimal(l->decimal_val)
+                                                      : make_number(l->int_val);
+            break;
+        }
+        case NODE_VAR_ACCESS:
+            c->fn.eval = cc_var;
+            c->as.name = ((VarAccessNode*)node)->name;
+            break;
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *b = (BinaryExprNode*)node;
+            if (node->static_type == STATIC_INT) {
+                c->fn.eval = cc_int_root;
+                c->as.unary.expr = compile_int(node);
+                break;
+            }
+            c->fn.eval = binary_fn(b->op);
+            c->as.binary.op = b->op;
+            c->as.binary.left = compile_expr(b->left);
+            c->as.binary.right = compile_expr(b->right);
+            break;
+        }
+        case NODE_CALL_EXPR: {
+            CallExprNode *call = (CallExprNode*)node;
+            int argc = 0;
+            for (ASTNode *a = call->arguments; a; a = a->next) argc++;
+
+            c->fn.eval = cc_call;
+            c->as.call.callee = call->callee;
+            c->as.call.argc = argc;
+            c->as.call.args = malloc(sizeof(Code*) * (argc ? argc : 1));
+            c->owned = c->as.call.args;
+            int i = 0;
+            for (ASTNode *a = call->arguments; a; a = a->next) {
+                c->as.call.args[i++] = compile_expr(a);
+            }
+            break;
+        }
+        case NODE_LIST:
+        case NODE_INTERP: {
+            ASTNode *items = node->type == NODE_LIST ? ((ListNode*)node)->elements
+                                                     : ((InterpNode*)node)->parts;
+            int count = 0;
+            for (ASTNode *e = items; e; e = e->next) count++;
+
+            c->fn.eval = node->type == NODE_LIST ? cc_list : cc_interp;
+            c->as.list.count = count;
+            c->as.list.items = malloc(sizeof(Code*) * (count ? count : 1));
+            c->owned = c->as.list.items;
+            int i = 0;
+            for (ASTNode *e = items; e; e = e->next) {
+                c->as.list.items[i++] = compile_expr(e);
+            }
+            break;
+        }
+        case NODE_INDEX: {
+            IndexNode *ix = (IndexNode*)node;
+            c->fn.eval = cc_index; // Shares the binary operand layout
+            c->as.binary.left = compile_expr(ix->target);
+            c->as.binary.right = compile_expr(ix->index);
+            break;
+        }
+        default:
+            c->fn.eval = cc_expr_fallback;
+            break;
+    }
+    return c;
+}
+
+static Code* compile_int(ASTNode *node) {
+    Code *c = new_code(node);
+    if (node->type == NODE_LITERAL) {
+        c->fn.ieval = ci_constant;
+        c->as.constant = make_number(((LiteralNode*)node)->int_val);
+    } else if (node->type == NODE_VAR_ACCESS) {
+        c->fn.ieval = ci_var;
+        c->as.name = ((VarAccessNode*)node)->name;
+    } else if (node->type == NODE_BINARY_EXPR) {
+        BinaryExprNode *b = (BinaryExprNode*)node;
+        c->fn.ieval = int_binary_fn(b->op);
+        c->as.binary.op = b->op;
+        c->as.binary.left = compile_int(b->left);
+        c->as.binary.right = compile_int(b->right);
+    } else {
+        c->fn.ieval = ci_boxed; // Calls proven to return a number
+        c->as.unary.expr = compile_expr(node);
+    }
+    return c;
+}
+
+// --- Statements ---
+
+static int cc_block(Code *self, Environment *env, Value *ret) {
+    Code **stmts = self->as.block.stmts;
+    int count = self->as.block.count;
+    for (int i = 0; i < count; i++) {
+        if (stmts[i]->fn.exec(stmts[i], env, ret)) return 1;
+    }
+    return 0;
+}
+
+static int cc_print(Code *self, Environment *env, Value *ret) {
+    (void)ret;
+    Code *e = self->as.unary.expr;
+    Value val;
+    if (e->fn.eval(e, env, &val)) print_value(val);
+    return 0;
+}
+
+static int cc_var_decl(Code *self, Environment *env, Value *ret) {
+    (void)ret;
+    Code *e = self->as.decl.value;
+    Value val;
+    if (e->fn.eval(e, env, &val)) env_set(env, self->as.decl.name, val);
+    return 0;
+}
+
+static int cc_func_decl(Code *self, Environment *env, Value *ret) {
+    (void)ret;
+    FuncDeclNode *f = (FuncDeclNode*)self->node;
+    env_set(env, f->name, evaluator_make_function(f, env));
+    return 0;
+}
+
+static int cc_return(Code *self, Environment *env, Value *ret) {
+    Code *e = self->as.unary.expr;
+    return e->fn.eval(e, env, ret);
+}
+
+static int cc_if(Code *self, Environment *env, Value *ret) {
+    Code *cond = self->as.branch.cond;
+    Value c;
+    if (cond->fn.eval(cond, env, &c) && value_is_truthy(c)) {
+        Code *then_branch = self->as.branch.then_branch;
+        return then_branch->fn.exec(then_branch, env, ret);
+    }
+    return 0;
+}
+
+static int cc_repeat(Code *self, Environment *env, Value *ret) {
+    Code *start_code = self->as.repeat.start;
+    Code *end_code = self->as.repeat.end;
+    Value start, end;
+    if (!start_code->fn.eval(start_code, env, &start) || !end_code->fn.eval(end_code, env, &end)) return 0;
+    if (start.type != VAL_NUMBER || end.type != VAL_NUMBER) {
+        fprintf(stderr, "Runtime Error: 'ulang' bounds must be integers.\n");
+        return 0;
+    }
+
+    Value *slot = env_slot(env, self->as.repeat.name);
+    Code *body = self->as.repeat.body;
+    int64_t limit = end.as.number;
+    for (int64_t i = start.as.number; i <= limit; i++) {
+        slot->type = VAL_NUMBER;
+        slot->as.number = i;
+        if (body->fn.exec(body, env, ret)) return 1;
+        if (i == limit) break; // No i++ past INT64_MAX
+    }
+    return 0;
+}
+
+static int cc_while(Code *self, Environment *env, Value *ret) {
+    Code *cond = self->as.branch.cond;
+    Code *body = self->as.branch.then_branch;
+    Value c;
+    while (cond->fn.eval(cond, env, &c) && value_is_truthy(c)) {
+        if (body->fn.exec(body, env, ret)) return 1;
+    }
+    return 0;
+}
+
+static int cc_expr_stmt(Code *self, Environment *env, Value *ret) {
+    (void)ret;
+    Code *e = self->as.unary.expr;
+    Value discarded;
+    e->fn.eval(e, env, &discarded);
+    return 0;
+}
+
+static int cc_nop(Code *self, Environment *env, Value *ret) {
+    (void)self; (void)env; (void)ret;
+    return 0;
+}
+
+static int cc_stmt_fallback(Code *self, Environment *env, Value *ret) {
+    return evaluator_exec_node(self->node, env, ret);
+}
+
+static Code* compile_block(ASTNode *node, ASTNode *stmts) {
+    Code *c = new_code(node);
+    int count = 0;
+    for (ASTNode *s = stmts; s; s = s->next) count++;
+
+    c->fn.exec = cc_block;
+    c->as.block.count = count;
+    c->as.block.stmts = malloc(sizeof(Code*) * (count ? count : 1));
+    c->owned = c->as.block.stmts;
+    int i = 0;
+    for (ASTNode *s = stmts; s; s = s->next) {
+        c->as.block.stmts[i++] = compile_stmt(s);
+    }
+    return c;
+}
+
+static Code* compile_stmt(ASTNode *node) {
+    switch (node->type) {
+        case NODE_PROGRAM:
+            return compile_block(node, ((ProgramNode*)node)->statements);
+        case NODE_BLOCK:
+            return compile_block(node, ((BlockNode*)node)->statements);
+        default:
+            break;
+    }
+
+    Code *c = new_code(node);
+    switch (node->type) {
+        case NODE_PRINT:
+            c->fn.exec = cc_print;
+            c->as.unary.expr = compile_expr(((PrintNode*)node)->expression);
+            break;
+        case NODE_VAR_DECL: {
+            VarDeclNode *v = (VarDeclNode*)node;
+            c->fn.exec = cc_var_decl;
+            c->as.decl.name = v->name;
+            c->as.decl.value = compile_expr(v->value);
+            break;
+        }
+        case NODE_FUNC_DECL:
+            c->fn.exec = cc_func_decl; // Body is compiled lazily on first call
+            break;
+        case NODE_RETURN:
+            c->fn.exec = cc_return;
+            c->as.unary.expr = compile_expr(((ReturnNode*)node)->value);
+            break;
+        case NODE_IF: {
+            IfNode *i = (IfNode*)node;
+            c->fn.exec = cc_if;
+            c->as.branch.cond = compile_expr(i->condition);
+            c->as.branch.then_branch = compile_stmt(i->then_branch);
+            break;
+        }
+        case NODE_REPEAT: {
+            RepeatNode *r = (RepeatNode*)node;
+            c->fn.exec = cc_repeat;
+            c->as.repeat.name = r->var_name;
+            c->as.repeat.start = compile_expr(r->start);
+            c->as.repeat.end = compile_expr(r->end);
+            c->as.repeat.body = compile_stmt(r->body);
+            break;
+        }
+        case NODE_WHILE: {
+            WhileNode *w = (WhileNode*)node;
+            c->fn.exec = cc_while;
+            c->as.branch.cond = compile_expr(w->condition);
+            c->as.branch.then_branch = compile_stmt(w->body);
+            break;
+        }
+        case NODE_BINARY_EXPR:
+        case NODE_CALL_EXPR:
+            c->fn.exec = cc_expr_stmt;
+            c->as.unary.expr = compile_expr(node);
+            break;
+        case NODE_LITERAL:
+        case NODE_VAR_ACCESS:
+            c->fn.exec = cc_nop; // The tree walker ignores these statements too
+            break;
+        default:
+            c->fn.exec = cc_stmt_fallback;
+            break;
+    }
+    return c;
+}
+
+// --- Public API ---
+
+Code* compile_program(ASTNode *program) {
+    return compile_stmt(program);
+}
+
+void run_compiled(Code *code, Environment *env) {
+    Value ret;
+    code->fn.exec(code, env, &ret);
+}
+
+void cleanup_compiler() {
+    Code *c = all_code;
+    while (c) {
+        Code *next = c->all_next;
+        free(c->owned);
+        free(c);
+        c = next;
+    }
+    all_code = NULL;
+}
@@ -0,0 +1,799 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "emit_c.h"
+#include "builtins.h"
+
+typedef struct {
+    FuncDeclNode *decl;
+    int id;
+    int int_only;       // Has a plain 'int' C twin
+    const char **locals; // Parameters first, then names bound by 'biar'/'fungsi'
+    int local_count;
+    int param_count;
+} FuncInfo;
+
+typedef struct {
+    const char *name;
+    int bindings;       // Top-level statements that bind this name
+    FuncDeclNode *func; // Last top-level 'fungsi' bound to it
+} GlobalInfo;
+
+static FuncInfo *funcs;
+static int func_count;
+static GlobalInfo *globals;
+static int global_count;
+
+static FILE *out;
+static int had_error;
+static int indent;
+static int temp_counter;
+static FuncInfo *current; // Function being emitted, NULL for top-level code
+
+static void error(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "Emit-C Error: ");
+    vfprintf(stderr, fmt, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+    had_error = 1;
+}
+
+static void line(const char *fmt, ...) {
+    for (int i = 0; i < indent; i++) fputs("    ", out);
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(out, fmt, ap);
+    va_end(ap);
+    fputc('\n', out);
+}
+
+// --- Analysis ---
+
+static FuncInfo* func_info(FuncDeclNode *decl) {
+    for (int i = 0; i < func_count; i++) {
+        if (funcs[i].decl == decl) return &funcs[i];
+    }
+    return NULL;
+}
+
+static void add_local(FuncInfo *f, const char *name) {
+    for (int i = 0; i < f->local_count; i++) {
+        if (strcmp(f->locals[i], name) == 0) return;
+    }
+    f->locals = realloc(f->locals, sizeof(char*) * (f->local_count + 1));
+    f->locals[f->local_count++] = name;
+}
+
+static int local_index(FuncInfo *f, const char *name) {
+    if (!f) return -1;
+    for (int i = 0; i < f->local_count; i++) {
+        if (strcmp(f->locals[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+static GlobalInfo* find_global(const char *name) {
+    for (int i = 0; i < global_count; i++) {
+        if (strcmp(globals[i].name, name) == 0) return &globals[i];
+    }
+    return NULL;
+}
+
+static void bind_global(const char *name, FuncDeclNode *func) {
+    GlobalInfo *g = find_global(name);
+    if (!g) {
+        globals = realloc(globals, sizeof(GlobalInfo) * (global_count + 1));
+        g = &globals[global_count++];
+        g->name = name;
+        g->bindings = 0;
+        g->func = NULL;
+    }
+    g->bindings++;
+    g->func = func;
+}
+
+// The function a global name always refers to, or NULL if it may change
+static FuncDeclNode* stable_function(const char *name) {
+    GlobalInfo *g = find_global(name);
+    return (g && g->bindings == 1) ? g->func : NULL;
+}
+
+static void collect_funcs(ASTNode *stmts) {
+    for (ASTNode *s = stmts; s; s = s->next) {
+        if (s->type == NODE_FUNC_DECL) {
+            FuncDeclNode *f = (FuncDeclNode*)s;
+            funcs = realloc(funcs, sizeof(FuncInfo) * (func_count + 1));
+            FuncInfo *info = &funcs[func_count];
+            memset(info, 0, sizeof(FuncInfo));
+            info->decl = f;
+            info->id = func_count++;
+            collect_funcs(((BlockNode*)f->body)->statements);
+        } else if (s->type == NODE_IF) {
+            collect_funcs(((BlockNode*)((IfNode*)s)->then_branch)->statements);
+        } else if (s->type == NODE_BLOCK) {
+            collect_funcs(((BlockNode*)s)->statements);
+        } else if (s->type == NODE_REPEAT) {
+            collect_funcs(((BlockNode*)((RepeatNode*)s)->body)->statements);
+        } else if (s->type == NODE_WHILE) {
+            collect_funcs(((BlockNode*)((WhileNode*)s)->body)->statements);
+        }
+    }
+}
+
+// Blocks do not open scopes: every binding lands in the enclosing function
+// (or the global environment), so both walks descend into 'jika' bodies.
+static void global_binding(void *ctx, ASTNode *binder, const char *name) {
+    (void)ctx;
+    bind_global(name, binder->type == NODE_FUNC_DECL ? (FuncDeclNode*)binder : NULL);
+}
+
+static void local_binding(void *ctx, ASTNode *binder, const char *name) {
+    (void)binder;
+    add_local(ctx, name);
+}
+
+// --- Integer-only inference ---
+// A function is integer-only when its body consists of 'jika'/'kembali' over
+// parameters, number literals, arithmetic, comparisons and calls to other
+// integer-only functions, and ends in 'kembali'. Computed as a fixed point.
+
+static int int_expr_ok(FuncInfo *f, ASTNode *e) {
+    if (!e) return 0;
+    switch (e->type) {
+        case NODE_LITERAL:
+            return ((LiteralNode*)e)->type == TOKEN_NUMBER;
+        case NODE_VAR_ACCESS: {
+            int idx = local_index(f, ((VarAccessNode*)e)->name);
+            return idx >= 0 && idx < f->param_count;
+        }
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *b = (BinaryExprNode*)e;
+            switch (b->op) {
+                case TOKEN_PLUS: case TOKEN_MINUS: case TOKEN_STAR: case TOKEN_SLASH:
+                case TOKEN_LT: case TOKEN_GT: case TOKEN_LT_EQ: case TOKEN_GT_EQ:
+                case TOKEN_EQ_EQ: case TOKEN_BANG_EQ:
+                    return int_expr_ok(f, b->left) && int_expr_ok(f, b->right);
+                default:
+                    return 0;
+            }
+        }
+        case NODE_CALL_EXPR: {
+            CallExprNode *c = (CallExprNode*)e;
+            if (local_index(f, c->callee) >= 0) return 0;
+            FuncDeclNode *target = stable_function(c->callee);
+            FuncInfo *t = target ? func_info(target) : NULL;
+            if (!t || !t->int_only) return 0;
+
+            int argc = 0;
+            for (ASTNode *a = c->arguments; a; a = a->next, argc++) {
+                if (!int_expr_ok(f, a)) return 0;
+            }
+            return argc == t->param_count;
+        }
+        default:
+            return 0;
+    }
+}
+
+static int int_stmt_ok(FuncInfo *f, ASTNode *s) {
+    switch (s->type) {
+        case NODE_RETURN:
+            return int_expr_ok(f, ((ReturnNode*)s)->value);
+        case NODE_IF: {
+            IfNode *i = (IfNode*)s;
+            return int_expr_ok(f, i->condition) && int_stmt_ok(f, i->then_branch);
+        }
+        case NODE_BLOCK:
+            for (ASTNode *c = ((BlockNode*)s)->statements; c; c = c->next) {
+                if (!int_stmt_ok(f, c)) return 0;
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static int int_function_ok(FuncInfo *f) {
+    if (f->local_count != f->param_count) return 0;
+
+    ASTNode *last = NULL;
+    for (ASTNode *s = ((BlockNode*)f->decl->body)->statements; s; s = s->next) last = s;
+    if (!last || last->type != NODE_RETURN) return 0;
+
+    return int_stmt_ok(f, f->decl->body);
+}
+
+static void infer_int_only() {
+    for (int i = 0; i < func_count; i++) funcs[i].int_only = 1;
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < func_count; i++) {
+            if (funcs[i].int_only && !int_function_ok(&funcs[i])) {
+                funcs[i].int_only = 0;
+                changed = 1;
+            }
+        }
+    }
+}
+
+// --- Integer code ---
+
+static void gen_int_expr(ASTNode *e, FILE *o);
+
+static void gen_int_expr(ASTNode *e, FILE *o) {
+    switch (e->type) {
+        case NODE_LITERAL:
+            fprintf(o, "%lldLL", (long long)((LiteralNode*)e)->int_val);
+            break;
+        case NODE_VAR_ACCESS:
+            fprintf(o, "v_%s", ((VarAccessNode*)e)->name);
+            break;
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *b = (BinaryExprNode*)e;
+            const char *checked = NULL; // Arithmetic goes through the bailout helpers
+            switch (b->op) {
+                case TOKEN_PLUS: checked = "mrt_iadd"; break;
+                case TOKEN_MINUS: checked = "mrt_isub"; break;
+                case TOKEN_STAR: checked = "mrt_imul"; break;
+                case TOKEN_SLASH: checked = "mrt_idiv"; break;
+                default: break;
+            }
+            if (checked) {
+                fprintf(o, "%s(", checked);
+                gen_int_expr(b->left, o);
+                fprintf(o, ", ");
+                gen_int_expr(b->right, o);
+                fprintf(o, ")");
+                break;
+            }
+            const char *op = "<";
+            switch (b->op) {
+                case TOKEN_LT: op = "<"; break;
+                case TOKEN_GT: op = ">"; break;
+                case TOKEN_LT_EQ: op = "<="; break;
+                case TOKEN_GT_EQ: op = ">="; break;
+                case TOKEN_EQ_EQ: op = "=="; break;
+                case TOKEN_BANG_EQ: op = "!="; break;
+                default: break;
+            }
+            fprintf(o, "(");
+            gen_int_expr(b->left, o);
+            fprintf(o, " %s ", op);
+            gen_int_expr(b->right, o);
+            fprintf(o, ")");
+            break;
+        }
+        case NODE_CALL_EXPR: {
+            CallExprNode *c = (CallExprNode*)e;
+            FuncInfo *t = func_info(stable_function(c->callee));
+            fprintf(o, "fi%d_%s(", t->id, t->decl->name);
+            for (ASTNode *a = c->arguments; a; a = a->next) {
+                gen_int_expr(a, o);
+                if (a->next) fprintf(o, ", ");
+            }
+            fprintf(o, ")");
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void gen_int_stmt(ASTNode *s) {
+    switch (s->type) {
+        case NODE_RETURN:
+            for (int i = 0; i < indent; i++) fputs("    ", out);
+            fprintf(out, "return ");
+            gen_int_expr(((ReturnNode*)s)->value, out);
+            fprintf(out, ";\n");
+            break;
+        case NODE_IF: {
+            IfNode *i = (IfNode*)s;
+            for (int k = 0; k < indent; k++) fputs("    ", out);
+            fprintf(out, "if (");
+            gen_int_expr(i->condition, out);
+            fprintf(out, ") {\n");
+            indent++;
+            gen_int_stmt(i->then_branch);
+            indent--;
+            line("}");
+            break;
+        }
+        case NODE_BLOCK:
+            for (ASTNode *c = ((BlockNode*)s)->statements; c; c = c->next) gen_int_stmt(c);
+            break;
+        default:
+            break;
+    }
+}
+
+// --- Generic code ---
+// Expressions are flattened into MrtValue temporaries so that calls (the
+// only source of side effects) run left to right, as in the tree walker.
+
+static char* escape_string(const char *s) {
+    size_t size = strlen(s) * 4 + 1;
+    char *buf = malloc(size);
+    size_t n = 0;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') { buf[n++] = '\\'; buf[n++] = c; }
+        else if (c == '\n') { buf[n++] = '\\'; buf[n++] = 'n'; }
+        else if (c < 32 || c >= 127) n += snprintf(buf + n, size - n, "\\%03o", c);
+        else buf[n++] = c;
+    }
+    buf[n] = '\0';
+    return buf;
+}
+
+// Writes the C lvalue/rvalue for a Morph name into buf; 0 if unresolvable
+static int resolve_name(const char *name, char *buf, size_t size) {
+    if (local_index(current, name) >= 0) {
+        snprintf(buf, size, "v_%s", name);
+        return 1;
+    }
+    if (find_global(name)) {
+        snprintf(buf, size, "g_%s", name);
+        return 1;
+    }
+    return 0;
+}
+
+// Natives morph_rt provides as mrt_native_<name>; the rest need lists,
+// maps or readers, which translated programs do not have
+static const char *runtime_natives[] = {
+    "panjang", "tipe", "teks", "angka", "waktu", "waktu_ms", "mutlak", "akar", "pangkat", NULL
+};
+
+static int runtime_native(const char *name) {
+    for (int i = 0; runtime_natives[i]; i++) {
+        if (strcmp(runtime_natives[i], name) == 0) return 1;
+    }
+    return 0;
+}
+
+// The construct a node stands for, in error messages
+static const char* construct_name(NodeType type) {
+    switch (type) {
+        case NODE_PROGRAM: return "program";
+        case NODE_BLOCK: return "blok";
+        case NODE_VAR_DECL: return "'biar'";
+        case NODE_PRINT: return "'tulis'";
+        case NODE_IF: return "'jika'";
+        case NODE_REPEAT: return "'ulang'";
+        case NODE_WHILE: return "'selama'";
+        case NODE_LITERAL: return "literal";
+        case NODE_VAR_ACCESS: return "variabel";
+        case NODE_BINARY_EXPR: return "operator";
+        case NODE_CALL_EXPR: return "panggilan";
+        case NODE_LIST: return "list [...]";
+        case NODE_MAP: return "map {...}";
+        case NODE_INDEX: return "indeks x[i]";
+        case NODE_INTERP: return "teks interpolasi";
+        case NODE_FUNC_DECL: return "'fungsi'";
+        case NODE_RETURN: return "'kembali'";
+    }
+    return "?";
+}
+
+static void gen_value(ASTNode *e, char *buf, size_t size);
+
+static void gen_call(CallExprNode *c, char *buf, size_t size) {
+    int argc = 0;
+    for (ASTNode *a = c->arguments; a; a = a->next) argc++;
+
+    FuncDeclNode *target = local_index(current, c->callee) >= 0 ? NULL : stable_function(c->callee);
+    if (target) {
+        // Direct call; bind min(args, params) like the interpreter, missing ones are null
+        FuncInfo *t = func_info(target);
+        char **args = calloc(t->param_count ? t->param_count : 1, sizeof(char*));
+        ASTNode *a = c->arguments;
+        for (int i = 0; i < t->param_count && a; i++, a = a->next) {
+            args[i] = malloc(256);
+            gen_value(a, args[i], 256);
+        }
+
+        int id = temp_counter++;
+        for (int i = 0; i < indent; i++) fputs("    ", out);
+        fprintf(out, "MrtValue t%d = fn%d_%s(", id, t->id, target->name);
+        for (int i = 0; i < t->param_count; i++) {
+            fprintf(out, "%s%s", i ? ", " : "", args[i] ? args[i] : "mrt_null()");
+            free(args[i]);
+        }
+        fprintf(out, ");\n");
+        free(args);
+        snprintf(buf, size, "t%d", id);
+        return;
+    }
+
+    char callee[256];
+    int native = 0;
+    if (!resolve_name(c->callee, callee, sizeof(callee))) {
+        if (runtime_native(c->callee)) {
+            snprintf(callee, sizeof(callee), "mrt_native_%s", c->callee);
+            native = 1;
+        } else {
+            if (native_lookup(c->callee)) error("fungsi native '%s' tidak didukung", c->callee);
+            else error("fungsi '%s' tidak pernah didefinisikan", c->callee);
+            snprintf(buf, size, "mrt_null()");
+            return;
+        }
+    }
+
+    char **args = calloc(argc ? argc : 1, sizeof(char*));
+    int i = 0;
+    for (ASTNode *a = c->arguments; a; a = a->next, i++) {
+        args[i] = malloc(256);
+        gen_value(a, args[i], 256);
+    }
+
+    int id = temp_counter++;
+    if (argc > 0) {
+        for (int k = 0; k < indent; k++) fputs("    ", out);
+        fprintf(out, "MrtValue a%d[] = {", id);
+        for (i = 0; i < argc; i++) fprintf(out, "%s%s", i ? ", " : "", args[i]);
+        fprintf(out, "};\n");
+        if (native) line("MrtValue t%d = %s(%d, a%d);", id, callee, argc, id);
+        else line("MrtValue t%d = mrt_call(%s, \"%s\", %d, a%d);", id, callee, c->callee, argc, id);
+    } else if (native) {
+        line("MrtValue t%d = %s(0, NULL);", id, callee);
+    } else {
+        line("MrtValue t%d = mrt_call(%s, \"%s\", 0, NULL);", id, callee, c->callee);
+    }
+    for (i = 0; i < argc; i++) free(args[i]);
+    free(args);
+    snprintf(buf, size, "t%d", id);
+}
+
+static const char* runtime_op(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: return "mrt_add";
+        case TOKEN_MINUS: return "mrt_sub";
+        case TOKEN_STAR: return "mrt_mul";
+        case TOKEN_SLASH: return "mrt_div";
+        case TOKEN_LT: return "mrt_lt";
+        case TOKEN_GT: return "mrt_gt";
+        case TOKEN_LT_EQ: return "mrt_le";
+        case TOKEN_GT_EQ: return "mrt_ge";
+        case TOKEN_EQ_EQ: return "mrt_eq";
+        case TOKEN_BANG_EQ: return "mrt_ne";
+        default: return NULL;
+    }
+}
+
+static void gen_value(ASTNode *e, char *buf, size_t size) {
+    if (!e) {
+        error("ekspresi kosong");
+        snprintf(buf, size, "mrt_null()");
+        return;
+    }
+
+    switch (e->type) {
+        case NODE_LITERAL: {
+            LiteralNode *l = (LiteralNode*)e;
+            if (l->type == TOKEN_STRING) {
+                char *escaped = escape_string(l->string_val);
+                // Long literals get their own temporary to stay within buf
+                if (strlen(escaped) + 16 > size) {
+                    int id = temp_counter++;
+                    line("MrtValue t%d = mrt_str(\"%s\");", id, escaped);
+                    snprintf(buf, size, "t%d", id);
+                } else {
+                    snprintf(buf, size, "mrt_str(\"%s\")", escaped);
+                }
+                free(escaped);
+            } else if (l->type == TOKEN_DECIMAL) {
+                snprintf(buf, size, "mrt_decimal(%.17g)", l->decimal_val);
+            } else {
+                snprintf(buf, size, "mrt_number(%lldLL)", (long long)l->int_val);
+            }
+            return;
+        }
+        case NODE_VAR_ACCESS: {
+            const char *name = ((VarAccessNode*)e)->name;
+            if (resolve_name(name, buf, size)) return;
+            if (runtime_native(name)) {
+                snprintf(buf, size, "mrt_function(mrt_native_%s)", name);
+            } else if (native_lookup(name)) {
+                error("fungsi native '%s' tidak didukung", name);
+                snprintf(buf, size, "mrt_null()");
+            } else {
+                error("variabel '%s' tidak pernah didefinisikan", name);
+                snprintf(buf, size, "mrt_null()");
+            }
+            return;
+        }
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *b = (BinaryExprNode*)e;
+            const char *fn = runtime_op(b->op);
+            if (!fn) {
+                error("operator biner tidak dikenal");
+                snprintf(buf, size, "mrt_null()");
+                return;
+            }
+            char left[256], right[256];
+            gen_value(b->left, left, sizeof(left));
+            gen_value(b->right, right, sizeof(right));
+            int id = temp_counter++;
+            line("MrtValue t%d = %s(%s, %s);", id, fn, left, right);
+            snprintf(buf, size, "t%d", id);
+            return;
+        }
+        case NODE_CALL_EXPR:
+            gen_call((CallExprNode*)e, buf, size);
+            return;
+        case NODE_INTERP: {
+            // Parts become temporaries in order, then one mrt_join
+            int count = 0;
+            for (ASTNode *p = ((InterpNode*)e)->parts; p; p = p->next) count++;
+            char **parts = calloc(count ? count : 1, sizeof(char*));
+            int i = 0;
+            for (ASTNode *p = ((InterpNode*)e)->parts; p; p = p->next, i++) {
+                parts[i] = malloc(256);
+                gen_value(p, parts[i], 256);
+            }
+
+            int id = temp_counter++;
+            for (int k = 0; k < indent; k++) fputs("    ", out);
+            fprintf(out, "MrtValue a%d[] = {", id);
+            for (i = 0; i < count; i++) {
+                fprintf(out, "%s%s", i ? ", " : "", parts[i]);
+                free(parts[i]);
+            }
+            fprintf(out, "};\n");
+            free(parts);
+            line("MrtValue t%d = mrt_join(%d, a%d);", id, count, id);
+            snprintf(buf, size, "t%d", id);
+            return;
+        }
+        default:
+            error("%s tidak didukung", construct_name(e->type));
+            snprintf(buf, size, "mrt_null()");
+            return;
+    }
+}
+
+static void gen_stmt(ASTNode *s) {
+    char v[256];
+    switch (s->type) {
+        case NODE_PRINT:
+            gen_value(((PrintNode*)s)->expression, v, sizeof(v));
+            line("mrt_print(%s);", v);
+            break;
+        case NODE_VAR_DECL: {
+            VarDeclNode *d = (VarDeclNode*)s;
+            char target[256];
+            gen_value(d->value, v, sizeof(v));
+            resolve_name(d->name, target, sizeof(target));
+            line("%s = %s;", target, v);
+            break;
+        }
+        case NODE_FUNC_DECL: {
+            FuncDeclNode *f = (FuncDeclNode*)s;
+            if (f->capture_count > 0) {
+                error("fungsi '%s' menangkap variabel lokal '%s' (closure) belum didukung", f->name, f->captures[0]);
+                break;
+            }
+            char target[256];
+            resolve_name(f->name, target, sizeof(target));
+            line("%s = mrt_function(fnw%d_%s);", target, func_info(f)->id, f->name);
+            break;
+        }
+        case NODE_RETURN:
+            gen_value(((ReturnNode*)s)->value, v, sizeof(v));
+            if (current) {
+                line("return %s;", v);
+            } else {
+                line("(void)%s;", v);
+                line("return 0;"); // Top-level 'kembali' ends the program
+            }
+            break;
+        case NODE_IF: {
+            IfNode *i = (IfNode*)s;
+            gen_value(i->condition, v, sizeof(v));
+            line("if (mrt_truthy(%s)) {", v);
+            indent++;
+            gen_stmt(i->then_branch);
+            indent--;
+            line("}");
+            break;
+        }
+        case NODE_BLOCK:
+            for (ASTNode *c = ((BlockNode*)s)->statements; c; c = c->next) gen_stmt(c);
+            break;
+        case NODE_REPEAT: {
+            RepeatNode *r = (RepeatNode*)s;
+            char start[256], end[256], target[256];
+            gen_value(r->start, start, sizeof(start));
+            gen_value(r->end, end, sizeof(end));
+            resolve_name(r->var_name, target, sizeof(target));
+            int id = temp_counter++;
+            line("if (mrt_range_ok(%s, %s)) {", start, end);
+            indent++;
+            line("for (long long i%d = %s.as.number; i%d <= %s.as.number; i%d++) {", id, start, id, end, id);
+            indent++;
+            line("%s = mrt_number(i%d);", target, id);
+            gen_stmt(r->body);
+            line("if (i%d == %s.as.number) break;", id, end); // No i++ past LLONG_MAX
+            indent--;
+            line("}");
+            indent--;
+            line("}");
+            break;
+        }
+        case NODE_WHILE: {
+            WhileNode *w = (WhileNode*)s;
+            // The condition's temporaries are re-evaluated on every iteration
+            line("for (;;) {");
+            indent++;
+            gen_value(w->condition, v, sizeof(v));
+            line("if (!mrt_truthy(%s)) break;", v);
+            gen_stmt(w->body);
+            indent--;
+            line("}");
+            break;
+        }
+        case NODE_BINARY_EXPR:
+        case NODE_CALL_EXPR:
+        case NODE_LIST:
+        case NODE_MAP:
+        case NODE_INDEX:
+        case NODE_INTERP:
+            gen_value(s, v, sizeof(v));
+            line("(void)%s;", v);
+            break;
+        case NODE_LITERAL:
+        case NODE_VAR_ACCESS:
+            break; // No effect, as in the tree walker
+        default:
+            error("%s tidak didukung sebagai pernyataan", construct_name(s->type));
+            break;
+    }
+}
+
+// --- Functions ---
+
+static void gen_signature(FuncInfo *f, int as_int) {
+    FuncDeclNode *d = f->decl;
+    const char *type = as_int ? "long long" : "MrtValue";
+    fprintf(out, "static %s %s%d_%s(", type, as_int ? "fi" : "fn", f->id, d->name);
+    if (f->param_count == 0) fprintf(out, "void");
+    for (int i = 0; i < f->param_count; i++) {
+        fprintf(out, "%s%s v_%s", i ? ", " : "", type, f->locals[i]);
+    }
+    fprintf(out, ")");
+}
+
+static void gen_function(FuncInfo *f) {
+    FuncDeclNode *d = f->decl;
+    current = f;
+    temp_counter = 0;
+
+    if (f->int_only) {
+        gen_signature(f, 1);
+        fprintf(out, " {\n");
+        indent = 1;
+        gen_int_stmt(d->body);
+        fprintf(out, "}\n\n");
+    }
+
+    gen_signature(f, 0);
+    fprintf(out, " {\n");
+    indent = 1;
+
+    if (f->int_only) {
+        // Fast path straight into the integer twin when every argument is an
+        // integer; on a bailout the generic body below computes the result
+        for (int k = 0; k < indent; k++) fputs("    ", out);
+        fprintf(out, "if (");
+        for (int i = 0; i < f->param_count; i++) {
+            fprintf(out, "%sv_%s.type == MRT_NUMBER", i ? " && " : "", f->locals[i]);
+        }
+        if (f->param_count == 0) fprintf(out, "1");
+        fprintf(out, ") {\n");
+        for (int k = 0; k < indent + 1; k++) fputs("    ", out);
+        fprintf(out, "long long r = fi%d_%s(", f->id, d->name);
+        for (int i = 0; i < f->param_count; i++) {
+            fprintf(out, "%sv_%s.as.number", i ? ", " : "", f->locals[i]);
+        }
+        fprintf(out, ");\n");
+        indent++;
+        line("if (!mrt_bailout) return mrt_number(r);");
+        line("mrt_bailout = 0;");
+        indent--;
+        line("}");
+    }
+
+    for (int i = f->param_count; i < f->local_count; i++) {
+        line("MrtValue v_%s = mrt_null();", f->locals[i]);
+        line("(void)v_%s;", f->locals[i]);
+    }
+    gen_stmt(d->body);
+    line("return mrt_null();");
+    fprintf(out, "}\n\n");
+
+    // Uniform entry point for calls through function values (extern so an
+    // unused one does not trip -Wunused-function)
+    fprintf(out, "MrtValue fnw%d_%s(int argc, MrtValue *argv) {\n", f->id, d->name);
+    if (f->param_count == 0) fprintf(out, "    (void)argc;\n    (void)argv;\n");
+    fprintf(out, "    return fn%d_%s(", f->id, d->name);
+    for (int i = 0; i < f->param_count; i++) {
+        fprintf(out, "%sargc > %d ? argv[%d] : mrt_null()", i ? ", " : "", i, i);
+    }
+    fprintf(out, ");\n}\n\n");
+
+    current = NULL;
+}
+
+// --- Entry ---
+
+static void reset() {
+    for (int i = 0; i < func_count; i++) free(funcs[i].locals);
+    free(funcs);
+    free(globals);
+    funcs = NULL;
+    globals = NULL;
+    func_count = global_count = 0;
+    had_error = 0;
+    indent = 0;
+    current = NULL;
+}
+
+int emit_c(ASTNode *program, FILE *output) {
+    reset();
+    out = output;
+
+    ASTNode *stmts = ((ProgramNode*)program)->statements;
+    collect_funcs(stmts);
+    walk_bindings(stmts, global_binding, NULL);
+    for (int i = 0; i < func_count; i++) {
+        FuncInfo *f = &funcs[i];
+        for (ASTNode *p = f->decl->params; p; p = p->next) {
+            add_local(f, ((VarAccessNode*)p)->name);
+        }
+        f->param_count = f->local_count;
+        walk_bindings(((BlockNode*)f->decl->body)->statements, local_binding, f);
+    }
+    infer_int_only();
+
+    fprintf(out, "// Dihasilkan oleh morphc --emit-c\n");
+    fprintf(out, "// Bangun: cc -O2 -Iruntime <file>.c runtime/morph_rt.c -lm\n");
+    for (int i = 0; i < func_count; i++) {
+        if (funcs[i].int_only) fprintf(out, "// Fungsi bilangan bulat murni: %s\n", funcs[i].decl->name);
+    }
+    fprintf(out, "#include <stddef.h>\n#include \"morph_rt.h\"\n\n");
+
+    for (int i = 0; i < global_count; i++) {
+        fprintf(out, "static MrtValue g_%s = { MRT_NULL, { 0 } };\n", globals[i].name);
+    }
+    fprintf(out, "\n");
+
+    for (int i = 0; i < func_count; i++) {
+        if (funcs[i].int_only) {
+            gen_signature(&funcs[i], 1);
+            fprintf(out, ";\n");
+        }
+        gen_signature(&funcs[i], 0);
+        fprintf(out, ";\n");
+        fprintf(out, "MrtValue fnw%d_%s(int argc, MrtValue *argv);\n", funcs[i].id, funcs[i].decl->name);
+    }
+    fprintf(out, "\n");
+
+    for (int i = 0; i < func_count; i++) gen_function(&funcs[i]);
+
+    fprintf(out, "int main(void) {\n");
+    indent = 1;
+    temp_counter = 0;
+    for (ASTNode *s = stmts; s; s = s->next) gen_stmt(s);
+    line("return 0;");
+    fprintf(out, "}\n");
+
+    int result = had_error;
+    reset();
+    return result;
+}
@@ -1,21 +1,67 @@
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 #include "env.h"
 #include "ast.h" // Need ASTNode definition for function
+#include "gc.h"
 
 // --- Value Helpers ---
 
-Value make_number(int n) {
+Value make_number(int64_t n) {
     Value v;
     v.type = VAL_NUMBER;
     v.as.number = n;
     return v;
 }
 
+Value make_decimal(double d) {
+    Value v;
+    v.type = VAL_DECIMAL;
+    v.as.decimal = d;
+    return v;
+}
+
+_Static_assert(sizeof(Value) == 16 && offsetof(Value, as) == 8,
+               "inline strings assume inline_chars runs straight into 'as'");
+
 Value make_string(const char *s) {
+    return make_string_n(s, strlen(s));
+}
+
+Value make_string_obj(ObjString *s) {
+    Value v;
+    v.type = VAL_STRING;
+    v.inline_len = 0;
+    v.as.string = s;
+    return v;
+}
+
+Value make_string_n(const char *chars, size_t length) {
+    if (length > VALUE_INLINE_MAX) return make_string_obj(gc_new_string(chars, length));
     Value v;
     v.type = VAL_STRING;
-    v.as.string = strdup(s);
+    v.inline_len = (unsigned char)(length + 1);
+    memcpy((char*)&v + offsetof(Value, inline_chars), chars, length);
+    return v;
+}
+
+Value make_string_slice(ObjString *source, size_t offset, size_t length) {
+    // The caller keeps 'source' rooted, as for gc_new_view
+    if (length <= VALUE_INLINE_MAX) return make_string_n(source->chars + offset, length);
+    return make_string_obj(gc_new_view(source, offset, length));
+}
+
+Value make_list(ObjList *l) {
+    Value v;
+    v.type = VAL_LIST;
+    v.as.list = l;
+    return v;
+}
+
+Value make_map(ObjMap *m) {
+    Value v;
+    v.type = VAL_MAP;
+    v.as.map = m;
     return v;
 }
 
@@ -26,25 +72,52 @@ Value make_function(ASTNode *decl) {
     return v;
 }
 
+Value make_closure(struct ObjClosure *c) {
+    Value v;
+    v.type = VAL_CLOSURE;
+    v.as.closure = c;
+    return v;
+}
+
+Value make_native(const struct NativeDef *def) {
+    Value v;
+    v.type = VAL_NATIVE;
+    v.as.native = def;
+    return v;
+}
+
+Value make_reader(ObjReader *r) {
+    Value v;
+    v.type = VAL_READER;
+    v.as.reader = r;
+    return v;
+}
+
 Value make_null() {
     Value v;
     v.type = VAL_NULL;
+    v.as.number = 0; // Read by inferred-int paths when an argument failed to evaluate
     return v;
 }
 
-void free_value(Value v) {
-    if (v.type == VAL_STRING && v.as.string) {
-        free(v.as.string);
-    }
-    // Function declaration is part of AST, owned by AST, not Value.
-}
+// Strings are owned by the GC heap and function declarations by the AST,
+// so Values are plain copies and nothing is freed per value.
 
 // --- Environment Implementation ---
 
+// Per thread: a parallel worker's call frames are its own. Collection walks
+// the main thread's list and the lists workers publish at a GC safepoint
+static _Thread_local Environment *live_envs = NULL;
+
 Environment* env_create(Environment *parent) {
     Environment *env = malloc(sizeof(Environment));
     env->head = NULL;
     env->parent = parent;
+
+    env->prev_live = NULL;
+    env->next_live = live_envs;
+    if (live_envs) live_envs->prev_live = env;
+    live_envs = env;
     return env;
 }
 
@@ -53,19 +126,37 @@ void env_free(Environment *env) {
     while (current) {
         Entry *next = current->next;
         free(current->key);
-        free_value(current->value);
         free(current);
         current = next;
     }
+
+    if (env->prev_live) env->prev_live->next_live = env->next_live;
+    else live_envs = env->next_live;
+    if (env->next_live) env->next_live->prev_live = env->prev_live;
     free(env);
 }
 
+void env_mark_live() {
+    env_mark_list(live_envs);
+}
+
+Environment* env_live_list(void) {
+    return live_envs;
+}
+
+void env_mark_list(Environment *list) {
+    for (Environment *env = list; env; env = env->next_live) {
+        for (Entry *e = env->head; e; e = e->next) {
+            gc_mark_value(e->value);
+        }
+    }
+}
+
 void env_set(Environment *env, const char *key, Value value) {
     // 1. Check if variable exists in current scope to update
     Entry *current = env->head;
     while (current) {
         if (strcmp(current->key, key) == 0) {
-            free_value(current->value);
             current->value = value;
             return;
         }
@@ -87,18 +178,58 @@ void env_set(Environment *env, const char *key, Value value) {
     env->head = new_entry;
 }
 
+void env_push(Environment *env, const char *key, Value value) {
+    // Lookups and env_set stop at the first match from the head, so the
+    // older entry (if any) is simply never seen again
+    Entry *new_entry = malloc(sizeof(Entry));
+    new_entry->key = strdup(key);
+    new_entry->value = value;
+    new_entry->next = env->head;
+    env->head = new_entry;
+}
+
+Value* env_slot(Environment *env, const char *key) {
+    for (Entry *e = env->head; e; e = e->next) {
+        if (strcmp(e->key, key) == 0) {
+            if (e->value.type == VAL_UNBOUND) e->value = make_null();
+            return &e->value;
+        }
+    }
+    env_set(env, key, make_null());
+    return &env->head->value; // env_set prepends new entries
+}
+
+int env_get_local(Environment *env, const char *key, Value *out_value) {
+    for (Entry *e = env->head; e; e = e->next) {
+        if (strcmp(e->key, key) == 0) {
+            *out_value = e->value;
+            return e->value.type != VAL_UNBOUND;
+        }
+    }
+    return 0;
+}
+
+Value* env_find(Environment *env, const char *key, Environment **owner) {
+    for (Environment *scope = env; scope; scope = scope->parent) {
+        for (Entry *e = scope->head; e; e = e->next) {
+            if (strcmp(e->key, key) == 0) {
+                *owner = scope;
+                return e->value.type == VAL_UNBOUND ? NULL : &e->value;
+            }
+        }
+    }
+    return NULL;
+}
+
 int env_get(Environment *env, const char *key, Value *out_value) {
     Environment *current_env = env;
     while (current_env) {
         Entry *current = current_env->head;
         while (current) {
             if (strcmp(current->key, key) == 0) {
+                if (current->value.type == VAL_UNBOUND) return 0;
                 if (out_value) {
-                    *out_value = current->value;
-                    if (current->value.type == VAL_STRING) {
-                        out_value->as.string = strdup(current->value.as.string);
-                    }
-                    // Function is pointer copy (safe, AST owns it)
+                    *out_value = current->value; // Shared, the GC owns the payload
                 }
                 return 1;
             }
@@ -108,3 +239,12 @@ int env_get(Environment *env, const char *key, Value *out_value) {
     }
     return 0; // Not found
 }
+
+void env_unbind(Environment *env, const char *key) {
+    for (Entry *e = env->head; e; e = e->next) {
+        if (strcmp(e->key, key) == 0) {
+            e->value.type = VAL_UNBOUND;
+            return;
+        }
+    }
+}
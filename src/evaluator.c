@@ -1,21 +1,64 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include "evaluator.h"
 #include "env.h"
+#include "gc.h"
+#include "compiler.h"
+#include "jit.h"
+#include "list.h"
+#include "map.h"
+#include "builtins.h"
+#include "snapshot.h"
+#include "parser.h"
+#include "parallel.h"
+#include "num.h"
 
 static Environment *global_env;
-static Value last_return_value;
-static int is_returning = 0;
+// Per thread, so parallel workers can run functions alongside the main one
+static _Thread_local Value last_return_value;
+static _Thread_local int is_returning = 0;
+static _Thread_local int worker_thread = 0; // Pool threads only walk the tree
+static EngineKind engine = ENGINE_TREE;
+static int quickening = 1;
+
+// Task scheduler, see "Tasks" below
+static void init_tasks(void);
+static void finish_tasks(void);
+static void cleanup_tasks(void);
+
+void set_engine(EngineKind kind) {
+    engine = kind;
+}
+
+Environment* evaluator_global_env() {
+    return global_env;
+}
 
 void init_evaluator() {
     global_env = env_create(NULL);
+    natives_install(global_env);
+    init_tasks();
     is_returning = 0;
+    last_return_value = make_null();
+    gc_add_root(&last_return_value);
 }
 
 void cleanup_evaluator() {
     if (global_env) {
         env_free(global_env);
+        global_env = NULL;
     }
+    parallel_shutdown();
+    cleanup_tasks();
+    cleanup_compiler();
+    cleanup_jit();
+    gc_shutdown();
 }
 
 // Forward decl
@@ -23,124 +66,727 @@ static void exec_statement(ASTNode *node, Environment *env);
 static int eval_expression(ASTNode *node, Environment *env, Value *out_val);
 
 // Helper for arithmetic
-static Value eval_binary_op(Value left, TokenType op, Value right) {
+Value eval_binary_op(Value left, TokenType op, Value right) {
+    // Integers first: the common case costs one tag test per operand
     if (left.type == VAL_NUMBER && right.type == VAL_NUMBER) {
-        int l = left.as.number;
-        int r = right.as.number;
-        switch (op) {
-            case TOKEN_PLUS: return make_number(l + r);
-            case TOKEN_MINUS: return make_number(l - r);
-            case TOKEN_STAR: return make_number(l * r);
-            case TOKEN_SLASH: return make_number(r != 0 ? l / r : 0);
-            case TOKEN_LT: return make_number(l < r);
-            case TOKEN_GT: return make_number(l > r);
-            case TOKEN_LT_EQ: return make_number(l <= r);
-            case TOKEN_GT_EQ: return make_number(l >= r);
-            case TOKEN_EQ_EQ: return make_number(l == r);
-            case TOKEN_BANG_EQ: return make_number(l != r);
-            default: break;
-        }
+        Num n;
+        NumKind kind = num_int_op(left.as.number, op, right.as.number, &n);
+        return kind == NUM_FAIL ? make_null() : num_to_value(kind, n);
+    }
+    if ((left.type == VAL_NUMBER || left.type == VAL_DECIMAL) &&
+        (right.type == VAL_NUMBER || right.type == VAL_DECIMAL)) {
+        Num l, r, n;
+        NumKind lk = num_from_value(left, &l);
+        NumKind rk = num_from_value(right, &r);
+        NumKind kind = num_decimal_op(num_as_double(lk, l), op, num_as_double(rk, r), &n);
+        return kind == NUM_FAIL ? make_null() : num_to_value(kind, n);
+    }
+
+    // String equality compares contents
+    if ((op == TOKEN_EQ_EQ || op == TOKEN_BANG_EQ) && left.type == VAL_STRING && right.type == VAL_STRING) {
+        size_t length = string_length(&left);
+        int equal = length == string_length(&right) &&
+                    memcmp(string_chars(&left), string_chars(&right), length) == 0;
+        return make_number(op == TOKEN_EQ_EQ ? equal : !equal);
     }
 
     // String Concatenation
     if (op == TOKEN_PLUS) {
         if (left.type == VAL_STRING && right.type == VAL_STRING) {
-            size_t len = strlen(left.as.string) + strlen(right.as.string) + 1;
-            char *buf = malloc(len);
-            snprintf(buf, len, "%s%s", left.as.string, right.as.string);
-            Value v = make_string(buf);
-            free(buf); // make_string duplicates it, so we free our temp buf
-            return v;
+            size_t l_len = string_length(&left);
+            size_t r_len = string_length(&right);
+            if (l_len + r_len <= VALUE_INLINE_MAX) {
+                char buf[VALUE_INLINE_MAX];
+                memcpy(buf, string_chars(&left), l_len);
+                memcpy(buf + l_len, string_chars(&right), r_len);
+                return make_string_n(buf, l_len + r_len);
+            }
+            // Both operands are rooted by the caller while we allocate
+            ObjString *s = gc_alloc_string(l_len + r_len);
+            memcpy(s->chars, string_chars(&left), l_len);
+            memcpy(s->chars + l_len, string_chars(&right), r_len);
+            return make_string_obj(s);
         }
     }
 
     return make_null();
 }
 
+static size_t decimal_length(int64_t n) {
+    uint64_t u = n < 0 ? 0u - (uint64_t)n : (uint64_t)n;
+    size_t length = n < 0 ? 2 : 1;
+    while (u >= 10) {
+        u /= 10;
+        length++;
+    }
+    return length;
+}
+
+// Writes exactly 'length' bytes, from the last digit backwards
+static void write_decimal(char *dst, size_t length, int64_t n) {
+    uint64_t u = n < 0 ? 0u - (uint64_t)n : (uint64_t)n;
+    do {
+        dst[--length] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (n < 0) dst[0] = '-';
+}
+
+// Interpolated strings: every part is measured before anything is copied, so
+// the result takes one allocation (none when it fits inline). Strings go in
+// as they are, integers are formatted in place and decimals through a stack
+// buffer; other values are rare and take the 'tulis' list-element form
+// through a temporary buffer. The caller keeps the parts rooted, since the
+// result may collect.
+Value join_values(const Value *parts, int count) {
+    size_t total = 0;
+    char **printed = NULL;   // write_value output of non-string, non-number parts
+    size_t *printed_length = NULL;
+    for (int i = 0; i < count; i++) {
+        if (parts[i].type == VAL_STRING) {
+            total += string_length(&parts[i]);
+        } else if (parts[i].type == VAL_NUMBER) {
+            total += decimal_length(parts[i].as.number);
+        } else if (parts[i].type == VAL_DECIMAL) {
+            char buf[32];
+            total += format_decimal(parts[i].as.decimal, buf, sizeof(buf));
+        } else {
+            if (!printed) {
+                printed = calloc(count, sizeof(char*));
+                printed_length = calloc(count, sizeof(size_t));
+            }
+            FILE *f = open_memstream(&printed[i], &printed_length[i]);
+            write_value(parts[i], f);
+            fclose(f);
+            total += printed_length[i];
+        }
+    }
+
+    char small[VALUE_INLINE_MAX];
+    ObjString *s = total > VALUE_INLINE_MAX ? gc_alloc_string(total) : NULL;
+    char *dst = s ? s->chars : small;
+    for (int i = 0; i < count; i++) {
+        size_t length;
+        if (parts[i].type == VAL_STRING) {
+            length = string_length(&parts[i]);
+            memcpy(dst, string_chars(&parts[i]), length);
+        } else if (parts[i].type == VAL_NUMBER) {
+            length = decimal_length(parts[i].as.number);
+            write_decimal(dst, length, parts[i].as.number);
+        } else if (parts[i].type == VAL_DECIMAL) {
+            char buf[32];
+            length = format_decimal(parts[i].as.decimal, buf, sizeof(buf));
+            memcpy(dst, buf, length);
+        } else {
+            length = printed_length[i];
+            memcpy(dst, printed[i], length);
+            free(printed[i]);
+        }
+        dst += length;
+    }
+    free(printed);
+    free(printed_length);
+    return s ? make_string_obj(s) : make_string_n(small, total);
+}
+
+int value_is_truthy(Value v) {
+    if (v.type == VAL_NUMBER) return v.as.number != 0;
+    if (v.type == VAL_DECIMAL) return v.as.decimal != 0;
+    return 1;
+}
+
+static void write_decimal_value(double d, FILE *out) {
+    char buf[32];
+    format_decimal(d, buf, sizeof(buf));
+    fputs(buf, out);
+}
+
+// Containers print their elements in literal syntax, strings quoted
+void write_value(Value v, FILE *out) {
+    switch (v.type) {
+        case VAL_NUMBER: fprintf(out, "%lld", (long long)v.as.number); break;
+        case VAL_DECIMAL: write_decimal_value(v.as.decimal, out); break;
+        case VAL_STRING: fprintf(out, "\"%.*s\"", (int)string_length(&v), string_chars(&v)); break;
+        case VAL_FUNCTION:
+        case VAL_CLOSURE: fprintf(out, "<fungsi>"); break;
+        case VAL_NATIVE: fprintf(out, "<fungsi %s>", v.as.native->name); break;
+        case VAL_READER: fprintf(out, "<pembaca>"); break;
+        case VAL_NULL: fprintf(out, "kosong"); break;
+        case VAL_LIST: {
+            ObjList *list = v.as.list;
+            fputc('[', out);
+            for (int i = 0; i < list->count; i++) {
+                if (i > 0) fputs(", ", out);
+                if (list->numeric) fprintf(out, "%lld", (long long)list->as.numbers[i]);
+                else write_value(list->as.items[i], out);
+            }
+            fputc(']', out);
+            break;
+        }
+        case VAL_MAP: {
+            ObjMap *map = v.as.map;
+            int first = 1;
+            fputc('{', out);
+            for (int i = 0; i < map->entry_count; i++) {
+                MapEntry *e = &map->entries[i];
+                if (e->key.type == VAL_NULL) continue; // Deleted
+                if (!first) fputs(", ", out);
+                write_value(e->key, out);
+                fputs(": ", out);
+                write_value(e->value, out);
+                first = 0;
+            }
+            fputc('}', out);
+            break;
+        }
+    }
+}
+
+void print_value(Value v) {
+    if (v.type == VAL_STRING) {
+        printf("%.*s\n", (int)string_length(&v), string_chars(&v)); // Never NUL-terminated
+    } else if (v.type == VAL_NUMBER) {
+        printf("%lld\n", (long long)v.as.number);
+    } else if (v.type == VAL_DECIMAL) {
+        write_decimal_value(v.as.decimal, stdout);
+        putchar('\n');
+    } else if (v.type == VAL_LIST || v.type == VAL_MAP) {
+        write_value(v, stdout);
+        printf("\n");
+    }
+}
+
+int index_value(Value target, Value index, Value *out) {
+    if (target.type == VAL_MAP) {
+        if (!map_valid_key(index)) {
+            fprintf(stderr, "Runtime Error: Map keys must be integers or strings.\n");
+            return 0;
+        }
+        if (!map_get(target.as.map, index, out)) {
+            fprintf(stderr, "Runtime Error: Key not found in map.\n");
+            return 0;
+        }
+        return 1;
+    }
+    if (target.type != VAL_LIST) {
+        fprintf(stderr, "Runtime Error: Only lists and maps can be indexed.\n");
+        return 0;
+    }
+    if (index.type != VAL_NUMBER) {
+        fprintf(stderr, "Runtime Error: List index must be an integer.\n");
+        return 0;
+    }
+    if (!list_get(target.as.list, index.as.number, out)) {
+        fprintf(stderr, "Runtime Error: List index %lld out of range (length %d).\n",
+                (long long)index.as.number, target.as.list->count);
+        return 0;
+    }
+    return 1;
+}
+
+// Natives take every argument, evaluated left to right and rooted for the call
+static int call_native(const NativeDef *native, ASTNode *arguments, Environment *env, Value *out_val) {
+    int argc = 0;
+    for (ASTNode *arg = arguments; arg; arg = arg->next) argc++;
+
+    Value small_args[JIT_MAX_PARAMS];
+    Value *args = argc <= JIT_MAX_PARAMS ? small_args : malloc(sizeof(Value) * argc);
+    ASTNode *arg = arguments;
+    for (int i = 0; i < argc; i++, arg = arg->next) {
+        if (!eval_expression(arg, env, &args[i])) {
+            args[i] = make_null();
+        }
+        gc_push_root(args[i]);
+    }
+
+    int ok = native->fn(args, argc, out_val);
+    gc_pop_roots(argc);
+    if (args != small_args) free(args);
+    return ok;
+}
+
+static void invoke_function(FuncDeclNode *func_decl, ObjClosure *closure, Value *args, int argc,
+                            Value *out_val);
+
+// Evaluates the first 'argc' arguments in the caller's scope, rooted until
+// they are bound, and runs the function on them
+static void call_function(FuncDeclNode *func_decl, ObjClosure *closure, int argc, ASTNode *arguments,
+                          Environment *env, Value *out_val) {
+    Value small_args[JIT_MAX_PARAMS];
+    Value *args = argc <= JIT_MAX_PARAMS ? small_args : malloc(sizeof(Value) * argc);
+    ASTNode *arg = arguments;
+    for (int i = 0; i < argc; i++, arg = arg->next) {
+        if (!eval_expression(arg, env, &args[i])) {
+            args[i] = make_null();
+        }
+        gc_push_root(args[i]);
+    }
+
+    invoke_function(func_decl, closure, args, argc, out_val);
+    gc_pop_roots(argc);
+    if (args != small_args) free(args);
+}
+
+// Runs a user function on evaluated arguments, which the caller keeps rooted
+// along with 'closure' (NULL for a plain function). 'argc' is already
+// clamped to the parameter count.
+static void invoke_function(FuncDeclNode *func_decl, ObjClosure *closure, Value *args, int argc,
+                            Value *out_val) {
+    // Hot integer functions run natively; a bailout falls through to the interpreter
+    if (!closure && jit_try_call(func_decl, args, argc, out_val)) return;
+
+    // 2. Create new scope. Its parent is global_env: globals (and top-level
+    // functions, for recursion) stay visible. Variables of enclosing
+    // functions are copied in flat from the closure, never looked up outside.
+    Environment *func_env = env_create(global_env);
+    if (closure) evaluator_bind_captures(func_env, closure);
+
+    // 3. Bind arguments
+    ASTNode *param = func_decl->params;
+    for (int i = 0; i < argc; i++, param = param->next) {
+        char *param_name = ((VarAccessNode*)param)->name; // We used VarAccess for param list
+        env_set(func_env, param_name, args[i]);
+    }
+
+    // 4. Exec Body
+    exec_statement(func_decl->body, func_env);
+
+    // 5. Cleanup
+    env_free(func_env);
+
+    // 6. Return result
+    if (is_returning) {
+        *out_val = last_return_value;
+        last_return_value = make_null(); // Drop the root, the caller holds it now
+        is_returning = 0;
+    } else {
+        *out_val = make_null();
+    }
+}
+
+static int declared_before(FuncDeclNode *earlier, FuncDeclNode *decl) {
+    for (ASTNode *n = earlier->base.next; n; n = n->next) {
+        if (n == (ASTNode*)decl) return 1;
+    }
+    return 0;
+}
+
+// Closures of earlier 'fungsi' statements in the same block sealed a null
+// for 'decl' (not bound yet); they get its value now, as recursion gets its
+// own, so local functions can call each other
+static void bind_earlier_siblings(FuncDeclNode *decl, Environment *env, Value function) {
+    for (Entry *e = env->head; e; e = e->next) {
+        if (e->value.type != VAL_CLOSURE) continue;
+        ObjClosure *closure = e->value.as.closure;
+        FuncDeclNode *sibling = (FuncDeclNode*)closure->declaration;
+        if (!declared_before(sibling, decl)) continue;
+        for (int i = 0; i < closure->count; i++) {
+            if (closure->captured[i].type == VAL_NULL && strcmp(sibling->captures[i], decl->name) == 0) {
+                closure->captured[i] = function;
+            }
+        }
+    }
+}
+
+Value evaluator_make_function(FuncDeclNode *decl, Environment *env) {
+    Value function;
+    if (decl->capture_count == 0) {
+        function = make_function((ASTNode*)decl);
+    } else {
+        ObjClosure *closure = gc_new_closure((ASTNode*)decl, decl->capture_count);
+        for (int i = 0; i < decl->capture_count; i++) {
+            const char *name = decl->captures[i];
+            if (strcmp(name, decl->name) == 0) {
+                closure->captured[i] = make_closure(closure); // Recursion: not bound yet
+            } else {
+                env_get_local(env, name, &closure->captured[i]); // Not bound yet: stays null
+            }
+        }
+        function = make_closure(closure);
+    }
+    // Globals are looked up at run time, so only function scopes have closures to patch
+    if (env != global_env) bind_earlier_siblings(decl, env, function);
+    return function;
+}
+
+void evaluator_bind_captures(Environment *func_env, ObjClosure *closure) {
+    FuncDeclNode *decl = (FuncDeclNode*)closure->declaration;
+    for (int i = 0; i < closure->count; i++) {
+        env_push(func_env, decl->captures[i], closure->captured[i]);
+    }
+}
+
+int evaluator_call_value(Value callee, Value *args, int argc, Value *out_val) {
+    if (callee.type == VAL_NATIVE) return callee.as.native->fn(args, argc, out_val);
+    if (callee.type != VAL_FUNCTION && callee.type != VAL_CLOSURE) {
+        fprintf(stderr, "Runtime Error: Value is not a function.\n");
+        return 0;
+    }
+
+    ObjClosure *closure = callee.type == VAL_CLOSURE ? callee.as.closure : NULL;
+    FuncDeclNode *decl = (FuncDeclNode*)(closure ? closure->declaration : callee.as.function.declaration);
+    if (decl->image_body) snapshot_materialize(decl);
+    if (decl->lazy_body) parser_materialize(decl);
+    int bound = 0;
+    for (ASTNode *p = decl->params; p && bound < argc; p = p->next) bound++;
+
+    // Closures are compiled lazily and shared, so only the main thread uses them
+    if (engine == ENGINE_CLOSURE && !worker_thread) compiled_call(decl, closure, args, bound, out_val);
+    else invoke_function(decl, closure, args, bound, out_val);
+    return 1;
+}
+
+void evaluator_init_worker(void) {
+    worker_thread = 1;
+    is_returning = 0;
+    last_return_value = make_null();
+    jit_disable_thread();
+}
+
+// --- Quickening ---
+// Nodes rewrite themselves into a specialized form (ast.h QuickKind) once
+// they have run: an integer-only BinaryExpr skips the generic operator
+// dispatch and rooting, and a VarAccess or CallExpr that found a global
+// keeps its slot instead of walking the global list each time. Global slots
+// never move or go away (bindings are updated in place), so the guards only
+// check what could have changed: that no local binding hides the name and,
+// for calls, that the slot still holds the same function.
+
+#define QUICK_MAX_DEOPTS 4 // A node that keeps failing its guard stays generic
+
+void evaluator_set_quickening(int enabled) {
+    quickening = enabled;
+}
+
+// Only the main thread rewrites nodes, and never while parallel workers may
+// be reading them; a guard that fails there just takes the generic path
+static int may_rewrite(const ASTNode *node) {
+    return quickening && !worker_thread && !parallel_active() && node->deopts < QUICK_MAX_DEOPTS;
+}
+
+static void deopt(ASTNode *node) {
+    if (worker_thread || parallel_active()) return;
+    node->quick = QUICK_NONE;
+    node->deopts++;
+}
+
+static void release_function(void *ctx, ASTNode *node) {
+    (void)ctx;
+    if (node->type == NODE_FUNC_DECL) jit_release((FuncDeclNode*)node);
+}
+
+void evaluator_release_code(ASTNode *stmts) {
+    ast_visit(stmts, release_function, NULL);
+}
+
+static void forget_target(void *ctx, ASTNode *node) {
+    (void)ctx;
+    if (node->quick == QUICK_CALL) node->quick = QUICK_NONE; // Not a failed guard: no deopt
+}
+
+void evaluator_forget_targets(ASTNode *stmts) {
+    ast_visit(stmts, forget_target, NULL);
+}
+
+// Function scopes hang directly off global_env (captures are copied in
+// flat), so one scan of the local scope decides if a global is visible
+static int global_visible(Environment *env, const char *name) {
+    if (env == global_env) return 1;
+    Value ignored;
+    return env->parent == global_env && !env_get_local(env, name, &ignored);
+}
+
+static int lookup_variable(VarAccessNode *v, Environment *env, Value *out_val) {
+    if (v->base.quick == QUICK_GLOBAL) {
+        if (global_visible(env, v->name) && v->global->type != VAL_UNBOUND) {
+            *out_val = *v->global;
+            return 1;
+        }
+        deopt(&v->base);
+    }
+
+    Environment *owner;
+    Value *slot = env_find(env, v->name, &owner);
+    if (!slot) {
+        fprintf(stderr, "Runtime Error: Variable '%s' not defined.\n", v->name);
+        return 0;
+    }
+    *out_val = *slot;
+    if (owner == global_env && may_rewrite(&v->base)) {
+        v->global = slot;
+        v->base.quick = QUICK_GLOBAL;
+    }
+    return 1;
+}
+
+// Integer operators open-coded, so integer loops pay no more than the
+// overflow check. Returns 0 on overflow or division by zero, which the
+// generic operators turn into a decimal or an error.
+static int int_binary(TokenType op, int64_t l, int64_t r, int64_t *out) {
+    switch (op) {
+        case TOKEN_PLUS: return !__builtin_add_overflow(l, r, out);
+        case TOKEN_MINUS: return !__builtin_sub_overflow(l, r, out);
+        case TOKEN_STAR: return !__builtin_mul_overflow(l, r, out);
+        case TOKEN_SLASH:
+            if (r == 0 || (l == INT64_MIN && r == -1)) return 0;
+            *out = l / r;
+            return 1;
+        case TOKEN_LT: *out = l < r; return 1;
+        case TOKEN_GT: *out = l > r; return 1;
+        case TOKEN_LT_EQ: *out = l <= r; return 1;
+        case TOKEN_GT_EQ: *out = l >= r; return 1;
+        case TOKEN_EQ_EQ: *out = l == r; return 1;
+        case TOKEN_BANG_EQ: *out = l != r; return 1;
+        default: return 0;
+    }
+}
+
+// Expressions inference proved numeric (STATIC_INT) are computed on raw
+// numbers: operands are never boxed or rooted, and only the int/decimal tag
+// travels with them (num.h). A non-number can only reach here as the null
+// left behind by an already reported error; like a division by zero, it
+// makes the result null (NUM_NULL), just as the generic operators do.
+static NumKind eval_int(ASTNode *node, Environment *env, Num *out) {
+    switch (node->type) {
+        case NODE_LITERAL:
+            out->i = ((LiteralNode*)node)->int_val; // Decimal literals are never STATIC_INT
+            return NUM_INT;
+        case NODE_VAR_ACCESS: {
+            Value val;
+            if (!lookup_variable((VarAccessNode*)node, env, &val)) return NUM_FAIL;
+            if (val.type != VAL_NUMBER && val.type != VAL_DECIMAL) return NUM_NULL;
+            return num_from_value(val, out);
+        }
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *b = (BinaryExprNode*)node;
+            Num l, r;
+            NumKind lk = eval_int(b->left, env, &l);
+            if (!lk) return NUM_FAIL;
+            NumKind rk = eval_int(b->right, env, &r);
+            if (!rk) return NUM_FAIL;
+            if (lk == NUM_NULL || rk == NUM_NULL) return NUM_NULL;
+            if (lk == NUM_INT && rk == NUM_INT && int_binary(b->op, l.i, r.i, &out->i)) return NUM_INT;
+            NumKind kind = num_op(lk, l, b->op, rk, r, out);
+            return kind ? kind : NUM_NULL;
+        }
+        default: {
+            // Calls: the callee is proven to return a number
+            Value val;
+            if (!eval_expression(node, env, &val)) return NUM_FAIL;
+            if (val.type != VAL_NUMBER && val.type != VAL_DECIMAL) return NUM_NULL;
+            return num_from_value(val, out);
+        }
+    }
+}
+
+// Conditions skip the boxed result entirely when they are integral
+static int eval_condition(ASTNode *node, Environment *env, int *truthy) {
+    if (node && node->static_type == STATIC_INT) {
+        Num n;
+        NumKind kind = eval_int(node, env, &n);
+        if (!kind) return 0;
+        *truthy = kind == NUM_NULL ? value_is_truthy(make_null()) : num_truthy(kind, n);
+        return 1;
+    }
+    Value cond;
+    if (!eval_expression(node, env, &cond)) return 0;
+    *truthy = value_is_truthy(cond);
+    return 1;
+}
+
 static int eval_expression(ASTNode *node, Environment *env, Value *out_val) {
     if (!node) return 0;
 
+    if (node->static_type == STATIC_INT && node->type == NODE_BINARY_EXPR) {
+        Num n;
+        NumKind kind = eval_int(node, env, &n);
+        if (!kind) return 0;
+        *out_val = num_to_value(kind, n);
+        return 1;
+    }
+
     if (node->type == NODE_LITERAL) {
         LiteralNode *l = (LiteralNode*)node;
         if (l->type == TOKEN_STRING) {
-            *out_val = make_string(l->string_val);
+            *out_val = make_string_obj(l->string_obj);
+        } else if (l->type == TOKEN_DECIMAL) {
+            *out_val = make_decimal(l->decimal_val);
         } else {
             *out_val = make_number(l->int_val);
         }
         return 1;
     }
     else if (node->type == NODE_VAR_ACCESS) {
-        VarAccessNode *v = (VarAccessNode*)node;
-        if (!env_get(env, v->name, out_val)) {
-            fprintf(stderr, "Runtime Error: Variable '%s' not defined.\n", v->name);
-            return 0;
-        }
-        return 1;
+        return lookup_variable((VarAccessNode*)node, env, out_val);
     }
     else if (node->type == NODE_BINARY_EXPR) {
         BinaryExprNode *b = (BinaryExprNode*)node;
         Value left, right;
-        if (eval_expression(b->left, env, &left) && eval_expression(b->right, env, &right)) {
-            *out_val = eval_binary_op(left, b->op, right);
-            free_value(left);
-            free_value(right);
-            return 1;
+        if (!eval_expression(b->left, env, &left)) return 0;
+
+        if (node->quick == QUICK_INT_BINARY) {
+            if (left.type == VAL_NUMBER) {
+                // An integer holds nothing the GC could free, so no roots
+                if (!eval_expression(b->right, env, &right)) return 0;
+                if (right.type == VAL_NUMBER &&
+                    int_binary(b->op, left.as.number, right.as.number, &out_val->as.number)) {
+                    out_val->type = VAL_NUMBER;
+                    return 1;
+                }
+                if (right.type != VAL_NUMBER) deopt(node);
+                gc_push_root(right);
+                *out_val = eval_binary_op(left, b->op, right);
+                gc_pop_roots(1);
+                return 1;
+            }
+            deopt(node);
         }
-        return 0;
+
+        // Keep 'left' reachable while 'right' (or the result) allocates
+        gc_push_root(left);
+        if (!eval_expression(b->right, env, &right)) {
+            gc_pop_roots(1);
+            return 0;
+        }
+        gc_push_root(right);
+        *out_val = eval_binary_op(left, b->op, right);
+        gc_pop_roots(2);
+        if (left.type == VAL_NUMBER && right.type == VAL_NUMBER && may_rewrite(node)) {
+            node->quick = QUICK_INT_BINARY;
+        }
+        return 1;
     }
     else if (node->type == NODE_CALL_EXPR) {
         CallExprNode *c = (CallExprNode*)node;
-        Value func_val;
-        if (!env_get(env, c->callee, &func_val)) {
+        if (node->quick == QUICK_CALL || node->quick == QUICK_CALL_NATIVE) {
+            Value *slot = c->global;
+            if (global_visible(env, c->callee)) {
+                if (node->quick == QUICK_CALL_NATIVE && slot->type == VAL_NATIVE && slot->as.native == c->native) {
+                    return call_native(c->native, c->arguments, env, out_val);
+                }
+                if (node->quick == QUICK_CALL && slot->type == VAL_FUNCTION &&
+                    slot->as.function.declaration == c->target) {
+                    call_function((FuncDeclNode*)c->target, NULL, c->argc, c->arguments, env, out_val);
+                    return 1;
+                }
+            }
+            deopt(node);
+        }
+
+        Environment *owner;
+        Value *slot = env_find(env, c->callee, &owner);
+        if (!slot) {
             fprintf(stderr, "Runtime Error: Function '%s' not defined.\n", c->callee);
             return 0;
         }
+        Value func_val = *slot;
+        int cacheable = owner == global_env && may_rewrite(node);
 
-        if (func_val.type != VAL_FUNCTION) {
+        if (func_val.type == VAL_NATIVE) {
+            if (cacheable) {
+                c->global = slot;
+                c->native = func_val.as.native;
+                node->quick = QUICK_CALL_NATIVE;
+            }
+            return call_native(func_val.as.native, c->arguments, env, out_val);
+        }
+
+        if (func_val.type != VAL_FUNCTION && func_val.type != VAL_CLOSURE) {
              fprintf(stderr, "Runtime Error: '%s' is not a function.\n", c->callee);
              return 0;
         }
 
-        FuncDeclNode *func_decl = (FuncDeclNode*)func_val.as.function.declaration;
-
-        // 1. Create new scope with parent = global (lexical scoping) or current (dynamic)?
-        // For simple recursion, parent usually is the env where function was defined (Closure).
-        // But we don't store closure env yet. Let's use global_env as parent for now to access globals,
-        // or better, use current 'env' if we want dynamic scope (easier for now).
-        // Let's use global_env as base to allow recursion accessing global func name.
-        Environment *func_env = env_create(global_env);
+        ObjClosure *closure = func_val.type == VAL_CLOSURE ? func_val.as.closure : NULL;
+        FuncDeclNode *func_decl = (FuncDeclNode*)(closure ? closure->declaration
+                                                          : func_val.as.function.declaration);
+        if (func_decl->image_body) snapshot_materialize(func_decl);
+        if (func_decl->lazy_body) parser_materialize(func_decl);
+        if (closure) gc_push_root(func_val); // Its binding may change while arguments run
 
-        // 2. Bind arguments
-        ASTNode *param = func_decl->params;
-        ASTNode *arg = c->arguments;
-
-        while (param && arg) {
-            Value arg_val;
-            eval_expression(arg, env, &arg_val); // Eval arg in caller scope
-
-            // Bind to param name in func scope
-            char *param_name = ((VarAccessNode*)param)->name; // We used VarAccess for param list
-            env_set(func_env, param_name, arg_val);
-
-            param = param->next;
-            arg = arg->next;
+        int argc = 0;
+        for (ASTNode *param = func_decl->params, *arg = c->arguments; param && arg;
+             param = param->next, arg = arg->next) {
+            argc++;
+        }
+        if (!closure && cacheable) {
+            c->global = slot;
+            c->target = (ASTNode*)func_decl;
+            c->argc = argc;
+            node->quick = QUICK_CALL;
         }
 
-        // 3. Exec Body
-        exec_statement(func_decl->body, func_env);
-
-        // 4. Cleanup
-        env_free(func_env);
+        call_function(func_decl, closure, argc, c->arguments, env, out_val);
+        if (closure) gc_pop_roots(1);
+        return 1;
+    }
+    else if (node->type == NODE_LIST) {
+        ListNode *l = (ListNode*)node;
+        int count = 0;
+        for (ASTNode *e = l->elements; e; e = e->next) count++;
 
-        // 5. Return result
-        if (is_returning) {
-            *out_val = last_return_value; // Move ownership
-            is_returning = 0;
-        } else {
-            *out_val = make_null();
+        // The list is rooted while elements allocate; appending itself never collects
+        ObjList *list = list_new(count);
+        gc_push_root(make_list(list));
+        for (ASTNode *e = l->elements; e; e = e->next) {
+            Value item;
+            if (!eval_expression(e, env, &item)) item = make_null();
+            list_append(list, item);
+        }
+        gc_pop_roots(1);
+        *out_val = make_list(list);
+        return 1;
+    }
+    else if (node->type == NODE_MAP) {
+        MapNode *m = (MapNode*)node;
+        ObjMap *map = map_new(0);
+        gc_push_root(make_map(map));
+        for (ASTNode *k = m->keys, *v = m->values; k && v; k = k->next, v = v->next) {
+            Value key, val;
+            if (!eval_expression(k, env, &key)) {
+                gc_pop_roots(1);
+                return 0;
+            }
+            if (!map_valid_key(key)) {
+                fprintf(stderr, "Runtime Error: Map keys must be integers or strings.\n");
+                gc_pop_roots(1);
+                return 0;
+            }
+            gc_push_root(key);
+            if (!eval_expression(v, env, &val)) val = make_null();
+            map_set(map, key, val);
+            gc_pop_roots(1);
         }
+        gc_pop_roots(1);
+        *out_val = make_map(map);
         return 1;
     }
+    else if (node->type == NODE_INDEX) {
+        IndexNode *ix = (IndexNode*)node;
+        Value target, index;
+        if (!eval_expression(ix->target, env, &target)) return 0;
+        gc_push_root(target);
+        int ok = eval_expression(ix->index, env, &index);
+        gc_pop_roots(1);
+        return ok && index_value(target, index, out_val);
+    }
+    else if (node->type == NODE_INTERP) {
+        int count = 0;
+        for (ASTNode *p = ((InterpNode*)node)->parts; p; p = p->next) count++;
+
+        // Each part stays rooted until the result is built
+        Value small_parts[8];
+        Value *parts = count <= 8 ? small_parts : malloc(sizeof(Value) * count);
+        int done = 0;
+        for (ASTNode *p = ((InterpNode*)node)->parts; p; p = p->next, done++) {
+            if (!eval_expression(p, env, &parts[done])) break;
+            gc_push_root(parts[done]);
+        }
+        int ok = done == count;
+        if (ok) *out_val = join_values(parts, count);
+        gc_pop_roots(done);
+        if (parts != small_parts) free(parts);
+        return ok;
+    }
 
     return 0;
 }
@@ -161,16 +807,14 @@ static void exec_statement(ASTNode *node, Environment *env) {
     if (is_returning) return;
 
     switch (node->type) {
+        case NODE_BLOCK:
+            exec_block(node, env);
+            break;
         case NODE_PRINT: {
             PrintNode *p = (PrintNode*)node;
             Value val;
             if (eval_expression(p->expression, env, &val)) {
-                if (val.type == VAL_STRING) {
-                    printf("%s\n", val.as.string);
-                } else if (val.type == VAL_NUMBER) {
-                    printf("%d\n", val.as.number);
-                }
-                free_value(val);
+                print_value(val);
             }
             break;
         }
@@ -184,7 +828,7 @@ static void exec_statement(ASTNode *node, Environment *env) {
         }
         case NODE_FUNC_DECL: {
             FuncDeclNode *f = (FuncDeclNode*)node;
-            Value val = make_function((ASTNode*)f);
+            Value val = evaluator_make_function(f, env);
             env_set(env, f->name, val);
             break;
         }
@@ -199,16 +843,41 @@ static void exec_statement(ASTNode *node, Environment *env) {
         }
         case NODE_IF: {
             IfNode *i = (IfNode*)node;
-            Value cond;
-            if (eval_expression(i->condition, env, &cond)) {
-                int is_true = 0;
-                if (cond.type == VAL_NUMBER) is_true = (cond.as.number != 0);
-                else is_true = 1;
-
-                if (is_true) {
+            int truthy;
+            if (eval_condition(i->condition, env, &truthy)) {
+                if (truthy) {
                     exec_block(i->then_branch, env);
                 }
-                free_value(cond);
+            }
+            break;
+        }
+        case NODE_REPEAT: {
+            RepeatNode *r = (RepeatNode*)node;
+            Value start, end;
+            if (!eval_expression(r->start, env, &start) || !eval_expression(r->end, env, &end)) break;
+            if (start.type != VAL_NUMBER || end.type != VAL_NUMBER) {
+                fprintf(stderr, "Runtime Error: 'ulang' bounds must be integers.\n");
+                break;
+            }
+
+            // The counter lives unboxed in a C local and is stored into a slot
+            // resolved once, so iterations do no lookup and no allocation.
+            Value *slot = env_slot(env, r->var_name);
+            int64_t limit = end.as.number; // Hoisted bound
+            for (int64_t i = start.as.number; i <= limit; i++) {
+                slot->type = VAL_NUMBER;
+                slot->as.number = i;
+                exec_block(r->body, env);
+                if (is_returning || i == limit) break; // No i++ past INT64_MAX
+            }
+            break;
+        }
+        case NODE_WHILE: {
+            WhileNode *w = (WhileNode*)node;
+            int truthy;
+            while (eval_condition(w->condition, env, &truthy) && truthy) {
+                exec_block(w->body, env);
+                if (is_returning) break;
             }
             break;
         }
@@ -216,9 +885,7 @@ static void exec_statement(ASTNode *node, Environment *env) {
         case NODE_CALL_EXPR: {
             // Expression statement
             Value v;
-            if (eval_expression(node, env, &v)) {
-                free_value(v);
-            }
+            eval_expression(node, env, &v);
             break;
         }
         default:
@@ -226,8 +893,364 @@ static void exec_statement(ASTNode *node, Environment *env) {
     }
 }
 
+// --- Tasks ---
+//
+// Lightweight coroutines. jalankan(f, args...) starts a task and returns its
+// number, serahkan() lets the other ready tasks run, tunggu(t) waits for t to
+// finish and returns its result. Every task runs on its own mmap'd stack;
+// pages are committed only when touched, so an idle task costs a few
+// kilobytes (the Task record, its first stack pages and its GC root stack).
+// A finished task gives all of that back and leaves only its result, in a
+// small slot by task number. The main program is task 0 and runs on the
+// process stack.
+//
+// Scheduling is cooperative and round-robin: a task runs until it yields,
+// waits for another task or would block reading a file descriptor. Blocked
+// readers are parked on their descriptor, and when nothing is ready the
+// scheduler sleeps in poll() until one of them has input.
+
+#define TASK_STACK_SIZE (8 * 1024 * 1024) // Like a thread stack: reserved, committed as touched
+
+typedef enum {
+    TASK_READY,     // Running, or queued to run
+    TASK_WAIT_FD,   // Parked until wait_fd is readable
+    TASK_WAIT_TASK, // On another task's awaiter list
+    TASK_WAIT_ALL,  // Main program, waiting for every task to finish
+    TASK_DONE
+} TaskState;
+
+typedef struct Task {
+    int id;
+    TaskState state;
+    ucontext_t context;
+    void *stack;          // NULL for the main task
+    GcRootStack roots;    // Evaluation stack while suspended
+    Value function;
+    Value *args;
+    int argc;
+    Value result;
+    int wait_fd;
+    struct Task *awaiters; // Tasks blocked in tunggu() on this one
+    struct Task *next;     // Link in the run queue, a wait list or the dead list
+} Task;
+
+typedef struct {
+    Task *task;   // NULL once finished and reaped
+    Value result; // Set when it finishes
+    int done;
+} TaskSlot;
+
+static Task main_task;
+static Task *current = &main_task;
+static TaskSlot *tasks = NULL; // By id - 1; kept until exit for their results
+static int task_count = 0;
+static int task_capacity = 0;
+static int tasks_live = 0;  // Started and not finished
+static Task *run_head = NULL, *run_tail = NULL;
+static Task *fd_waiters = NULL;
+static Task *dead_tasks = NULL; // Finished, not yet freed
+static size_t page_size = 0;
+
+static void run_queue_push(Task *t) {
+    t->state = TASK_READY;
+    t->next = NULL;
+    if (run_tail) run_tail->next = t;
+    else run_head = t;
+    run_tail = t;
+}
+
+static Task* run_queue_pop(void) {
+    Task *t = run_head;
+    if (t) {
+        run_head = t->next;
+        if (!run_head) run_tail = NULL;
+    }
+    return t;
+}
+
+// A finished task cannot unmap the stack it is running on; whoever runs next
+// does, and frees the record with it
+static void reap_dead_tasks(void) {
+    while (dead_tasks) {
+        Task *t = dead_tasks;
+        dead_tasks = t->next;
+        munmap(t->stack, TASK_STACK_SIZE);
+        free(t->roots.values);
+        tasks[t->id - 1].task = NULL;
+        free(t);
+    }
+}
+
+// Sleeps until at least one parked descriptor is readable and queues its
+// tasks. Returns 0 when nothing is parked.
+static int wake_fd_waiters(void) {
+    int count = 0;
+    for (Task *t = fd_waiters; t; t = t->next) count++;
+    if (count == 0) return 0;
+
+    struct pollfd *fds = malloc(sizeof(struct pollfd) * count);
+    int i = 0;
+    for (Task *t = fd_waiters; t; t = t->next, i++) {
+        fds[i].fd = t->wait_fd;
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+    while (poll(fds, count, -1) < 0 && errno == EINTR) {}
+
+    // Keep the remaining waiters in order, queue the woken ones
+    Task **link = &fd_waiters;
+    i = 0;
+    while (*link) {
+        Task *t = *link;
+        if (fds[i++].revents) {
+            *link = t->next;
+            run_queue_push(t);
+        } else {
+            link = &t->next;
+        }
+    }
+    free(fds);
+    return 1;
+}
+
+// Gives the CPU to the next ready task and returns once the current task is
+// resumed. The caller has already queued or parked the current task.
+static void schedule(void) {
+    Task *next;
+    while (!(next = run_queue_pop())) {
+        if (!wake_fd_waiters()) {
+            fprintf(stderr, "Runtime Error: Semua tugas saling menunggu (deadlock).\n");
+            exit(1);
+        }
+    }
+    if (next != current) {
+        Task *prev = current;
+        current = next;
+        gc_swap_root_stack(&prev->roots, &next->roots);
+        swapcontext(&prev->context, &next->context);
+    }
+    reap_dead_tasks();
+}
+
+static void task_entry(void) {
+    reap_dead_tasks();
+    Task *t = current;
+
+    if (!evaluator_call_value(t->function, t->args, t->argc, &t->result)) t->result = make_null();
+
+    free(t->args);
+    t->args = NULL;
+    t->argc = 0;
+    t->function = make_null();
+    t->state = TASK_DONE;
+    tasks[t->id - 1].result = t->result;
+    tasks[t->id - 1].done = 1;
+    while (t->awaiters) {
+        Task *waiter = t->awaiters;
+        t->awaiters = waiter->next;
+        run_queue_push(waiter);
+    }
+    if (--tasks_live == 0 && main_task.state == TASK_WAIT_ALL) run_queue_push(&main_task);
+
+    t->next = dead_tasks;
+    dead_tasks = t;
+    schedule(); // Never returns: nothing resumes a finished task
+}
+
+static void mark_tasks(void) {
+    for (int i = 0; i < task_count; i++) {
+        gc_mark_value(tasks[i].result);
+        Task *t = tasks[i].task;
+        if (!t) continue;
+        gc_mark_value(t->function);
+        gc_mark_value(t->result);
+        for (int j = 0; j < t->argc; j++) gc_mark_value(t->args[j]);
+        if (t != current) {
+            for (int j = 0; j < t->roots.count; j++) gc_mark_value(t->roots.values[j]);
+        }
+    }
+    if (current != &main_task) {
+        for (int j = 0; j < main_task.roots.count; j++) gc_mark_value(main_task.roots.values[j]);
+    }
+}
+
+// Switching tasks would leave a parallel call's workers running user code
+static int tasks_allowed(const char *name) {
+    if (!parallel_active()) return 1;
+    fprintf(stderr, "Runtime Error: '%s' tidak bisa dipakai di dalam fungsi paralel.\n", name);
+    return 0;
+}
+
+static TaskSlot* expect_task(const char *name, Value v) {
+    if (v.type == VAL_NUMBER && v.as.number >= 1 && v.as.number <= task_count) {
+        return &tasks[v.as.number - 1];
+    }
+    fprintf(stderr, "Runtime Error: '%s' expects a task.\n", name);
+    return NULL;
+}
+
+// jalankan(f, args...): starts f(args...) as a task and returns its number
+static int bi_jalankan(Value *args, int argc, Value *out) {
+    if (!tasks_allowed("jalankan")) return 0;
+    if (argc < 1 || (args[0].type != VAL_FUNCTION && args[0].type != VAL_CLOSURE &&
+                     args[0].type != VAL_NATIVE)) {
+        fprintf(stderr, "Runtime Error: 'jalankan' expects a function.\n");
+        return 0;
+    }
+
+    void *stack = mmap(NULL, TASK_STACK_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    // Guard page: overflow faults instead of corrupting. It splits the
+    // mapping in two, so vm.max_map_count bounds the live tasks.
+    if (stack == MAP_FAILED || mprotect(stack, page_size, PROT_NONE) != 0) {
+        if (stack != MAP_FAILED) munmap(stack, TASK_STACK_SIZE);
+        fprintf(stderr, "Runtime Error: Tidak bisa membuat tugas baru (%d tugas berjalan).\n", tasks_live);
+        return 0;
+    }
+
+    Task *t = calloc(1, sizeof(Task));
+    t->id = task_count + 1;
+    t->stack = stack;
+    t->function = args[0];
+    t->argc = argc - 1;
+    t->args = malloc(sizeof(Value) * (t->argc ? t->argc : 1));
+    memcpy(t->args, args + 1, sizeof(Value) * t->argc);
+    t->result = make_null();
+
+    getcontext(&t->context);
+    t->context.uc_stack.ss_sp = stack;
+    t->context.uc_stack.ss_size = TASK_STACK_SIZE;
+    t->context.uc_link = NULL;
+    makecontext(&t->context, task_entry, 0);
+
+    if (task_count >= task_capacity) {
+        task_capacity = task_capacity < 16 ? 16 : task_capacity * 2;
+        tasks = realloc(tasks, sizeof(TaskSlot) * task_capacity);
+    }
+    tasks[task_count].task = t;
+    tasks[task_count].result = make_null();
+    tasks[task_count].done = 0;
+    task_count++;
+    tasks_live++;
+    run_queue_push(t);
+
+    *out = make_number(t->id);
+    return 1;
+}
+
+// serahkan(): lets every other ready task run once
+static int bi_serahkan(Value *args, int argc, Value *out) {
+    (void)args;
+    (void)argc;
+    *out = make_null();
+    if (!tasks_allowed("serahkan")) return 0;
+    if (tasks_live == 0) return 1;
+    run_queue_push(current);
+    schedule();
+    return 1;
+}
+
+// tunggu(t): waits for task t and returns its result
+static int bi_tunggu(Value *args, int argc, Value *out) {
+    if (argc != 1) {
+        fprintf(stderr, "Runtime Error: 'tunggu' expects 1 argument(s), got %d.\n", argc);
+        return 0;
+    }
+    TaskSlot *slot = expect_task("tunggu", args[0]);
+    if (!slot || !tasks_allowed("tunggu")) return 0;
+    if (slot->task == current) {
+        fprintf(stderr, "Runtime Error: Tugas tidak bisa menunggu dirinya sendiri.\n");
+        return 0;
+    }
+    if (!slot->done) {
+        size_t index = slot - tasks;
+        Task *t = slot->task;
+        current->state = TASK_WAIT_TASK;
+        current->next = t->awaiters;
+        t->awaiters = current;
+        schedule();
+        slot = &tasks[index]; // The table may have grown meanwhile
+    }
+    *out = slot->result;
+    return 1;
+}
+
+void evaluator_wait_readable(int fd) {
+    if (tasks_live == 0 || parallel_active()) return; // Just block
+
+    struct pollfd p = {fd, POLLIN, 0};
+    while (poll(&p, 1, 0) == 0) {
+        current->state = TASK_WAIT_FD;
+        current->wait_fd = fd;
+        current->next = fd_waiters;
+        fd_waiters = current;
+        schedule();
+    }
+}
+
+void evaluator_register_natives(void) {
+    native_register("jalankan", bi_jalankan);
+    native_register("serahkan", bi_serahkan);
+    native_register("tunggu", bi_tunggu);
+}
+
+static void init_tasks(void) {
+    memset(&main_task, 0, sizeof(main_task));
+    main_task.function = make_null();
+    main_task.result = make_null();
+    current = &main_task;
+    page_size = (size_t)sysconf(_SC_PAGESIZE);
+    gc_add_root_marker(mark_tasks);
+}
+
+// The program ends when its last task does
+static void finish_tasks(void) {
+    if (tasks_live == 0) return;
+    main_task.state = TASK_WAIT_ALL;
+    schedule();
+}
+
+static void cleanup_tasks(void) {
+    reap_dead_tasks();
+    for (int i = 0; i < task_count; i++) {
+        Task *t = tasks[i].task;
+        if (!t) continue;
+        if (t->stack) munmap(t->stack, TASK_STACK_SIZE);
+        free(t->roots.values);
+        free(t->args);
+        free(t);
+    }
+    free(tasks);
+    tasks = NULL;
+    task_count = task_capacity = tasks_live = 0;
+    run_head = run_tail = fd_waiters = NULL;
+}
+
+// --- Entry points for other engines ---
+
+int evaluator_eval_node(ASTNode *node, Environment *env, Value *out_val) {
+    return eval_expression(node, env, out_val);
+}
+
+int evaluator_exec_node(ASTNode *node, Environment *env, Value *ret_val) {
+    exec_statement(node, env);
+    if (is_returning) {
+        *ret_val = last_return_value;
+        last_return_value = make_null();
+        is_returning = 0;
+        return 1;
+    }
+    return 0;
+}
+
 void evaluate(ASTNode *node) {
-    if (node->type == NODE_PROGRAM) {
+    if (node->type != NODE_PROGRAM) return;
+
+    is_returning = 0; // A top-level 'kembali' ends only the program it was in
+    if (engine == ENGINE_CLOSURE) {
+        run_compiled(compile_program(node), global_env);
+    } else {
         exec_block(node, global_env);
     }
+    finish_tasks();
 }
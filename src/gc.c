@@ -0,0 +1,502 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "gc.h"
+
+#define GC_MIN_HEAP (1024 * 1024)
+#define GC_LOCAL_BUDGET (256 * 1024) // A parallel thread flushes once it holds this much
+#define GC_DEFAULT_GROWTH 2.0
+
+// --- Heap State ---
+
+static Obj *objects = NULL;
+static size_t bytes_allocated = 0;
+static size_t next_gc = GC_MIN_HEAP;
+static double growth_factor = GC_DEFAULT_GROWTH;
+
+// Gray stack for iterative marking (no C recursion on deep object graphs)
+static Obj **gray_stack = NULL;
+static int gray_count = 0;
+static int gray_capacity = 0;
+
+// Evaluation stack: temporaries the evaluator holds across an allocation.
+// Per thread: parallel workers root their own temporaries.
+static _Thread_local Value *eval_stack = NULL;
+static _Thread_local int eval_count = 0;
+static _Thread_local int eval_capacity = 0;
+
+// Parallel regions: allocation never collects, and every thread links its
+// new objects into a private list that gc_parallel_flush hands to the heap.
+// Threads stopped at a safepoint publish their roots here.
+static int parallel_region = 0;
+static _Thread_local Obj *local_objects = NULL;
+static _Thread_local long local_bytes = 0;
+static pthread_mutex_t flush_lock = PTHREAD_MUTEX_INITIALIZER;
+static GcThreadRoots *parked_roots = NULL;
+
+// Long-lived root slots registered by the evaluator
+#define GC_MAX_ROOT_SLOTS 16
+static Value *root_slots[GC_MAX_ROOT_SLOTS];
+static int root_slot_count = 0;
+
+// Root providers outside the heap (e.g. suspended tasks)
+#define GC_MAX_ROOT_MARKERS 4
+static void (*root_markers[GC_MAX_ROOT_MARKERS])(void);
+static int root_marker_count = 0;
+
+// Set while gc_find_declarations marks
+static void (*declaration_found)(void *ctx, struct ASTNode *decl) = NULL;
+static void *declaration_ctx = NULL;
+
+// Statistics
+static size_t stat_collections = 0;
+static size_t stat_bytes_freed = 0;
+static size_t stat_peak_heap = 0;
+static double stat_total_pause_ms = 0.0;
+static double stat_max_pause_ms = 0.0;
+
+// --- Allocation ---
+
+static Obj* allocate_object(size_t size, ObjType type) {
+    if (parallel_region) {
+        Obj *obj = malloc(size);
+        if (!obj) {
+            fprintf(stderr, "Runtime Error: Kehabisan memori.\n");
+            exit(1);
+        }
+        obj->type = type;
+        obj->marked = 0;
+        obj->pinned = 0;
+        obj->next = local_objects;
+        local_objects = obj;
+        local_bytes += size;
+        return obj;
+    }
+
+#ifdef GC_STRESS
+    gc_collect();
+#else
+    if (bytes_allocated + size > next_gc) {
+        gc_collect();
+    }
+#endif
+
+    Obj *obj = malloc(size);
+    if (!obj) {
+        fprintf(stderr, "Runtime Error: Kehabisan memori.\n");
+        exit(1);
+    }
+    obj->type = type;
+    obj->marked = 0;
+    obj->pinned = 0;
+    obj->next = objects;
+    objects = obj;
+
+    bytes_allocated += size;
+    if (bytes_allocated > stat_peak_heap) stat_peak_heap = bytes_allocated;
+    return obj;
+}
+
+ObjString* gc_alloc_string(size_t length) {
+    ObjString *s = (ObjString*)allocate_object(sizeof(ObjString) + length + 1, OBJ_STRING);
+    s->length = length;
+    s->hash = 0;
+    s->chars = (char*)(s + 1);
+    s->owner = NULL;
+    s->chars[length] = '\0';
+    return s;
+}
+
+ObjString* gc_new_view(ObjString *source, size_t offset, size_t length) {
+    // The caller keeps 'source' rooted across this allocation
+    ObjString *s = (ObjString*)allocate_object(sizeof(ObjString), OBJ_STRING);
+    s->length = length;
+    s->hash = 0;
+    s->chars = source->chars + offset;
+    s->owner = source->owner ? source->owner : source; // Never chain views
+    return s;
+}
+
+ObjString* gc_new_string(const char *chars, size_t length) {
+    ObjString *s = gc_alloc_string(length);
+    memcpy(s->chars, chars, length);
+    return s;
+}
+
+ObjList* gc_new_list(int capacity, int numeric) {
+    ObjList *list = (ObjList*)allocate_object(sizeof(ObjList), OBJ_LIST);
+    list->count = 0;
+    list->capacity = capacity;
+    list->numeric = numeric;
+    size_t elem = numeric ? sizeof(int64_t) : sizeof(Value);
+    list->as.numbers = capacity > 0 ? malloc(elem * capacity) : NULL;
+    gc_account((long)(elem * capacity));
+    return list;
+}
+
+ObjMap* gc_new_map(void) {
+    ObjMap *map = (ObjMap*)allocate_object(sizeof(ObjMap), OBJ_MAP);
+    map->count = 0;
+    map->entry_count = 0;
+    map->entry_capacity = 0;
+    map->entries = NULL;
+    map->index_capacity = 0;
+    map->index = NULL;
+    return map;
+}
+
+ObjReader* gc_new_reader(FILE *file, int owns_file) {
+    ObjReader *reader = (ObjReader*)allocate_object(sizeof(ObjReader), OBJ_READER);
+    reader->file = file;
+    reader->owns_file = owns_file;
+    reader->eof = 0;
+    reader->chunk = NULL;
+    reader->pos = 0;
+    reader->end = 0;
+    return reader;
+}
+
+ObjClosure* gc_new_closure(struct ASTNode *declaration, int count) {
+    ObjClosure *closure = (ObjClosure*)allocate_object(sizeof(ObjClosure) + sizeof(Value) * count,
+                                                       OBJ_CLOSURE);
+    closure->declaration = declaration;
+    closure->count = count;
+    for (int i = 0; i < count; i++) closure->captured[i] = make_null();
+    return closure;
+}
+
+void gc_account(long delta) {
+    if (parallel_region) {
+        local_bytes += delta;
+        return;
+    }
+    bytes_allocated += delta;
+    if (bytes_allocated > stat_peak_heap) stat_peak_heap = bytes_allocated;
+}
+
+static size_t object_size(Obj *obj) {
+    switch (obj->type) {
+        case OBJ_STRING: {
+            ObjString *s = (ObjString*)obj;
+            return sizeof(ObjString) + (s->owner ? 0 : s->length + 1);
+        }
+        case OBJ_READER: return sizeof(ObjReader);
+        case OBJ_CLOSURE: return sizeof(ObjClosure) + sizeof(Value) * ((ObjClosure*)obj)->count;
+        case OBJ_LIST: {
+            ObjList *list = (ObjList*)obj;
+            size_t elem = list->numeric ? sizeof(int64_t) : sizeof(Value);
+            return sizeof(ObjList) + elem * list->capacity;
+        }
+        case OBJ_MAP: {
+            ObjMap *map = (ObjMap*)obj;
+            return sizeof(ObjMap) + sizeof(MapEntry) * map->entry_capacity
+                                  + sizeof(int) * map->index_capacity;
+        }
+    }
+    return 0;
+}
+
+void gc_pin(Obj *obj) {
+    if (obj) obj->pinned = 1;
+}
+
+void gc_unpin(Obj *obj) {
+    if (obj) obj->pinned = 0;
+}
+
+// --- Roots ---
+
+void gc_add_root(Value *slot) {
+    if (root_slot_count >= GC_MAX_ROOT_SLOTS) {
+        fprintf(stderr, "Runtime Error: Terlalu banyak root GC.\n");
+        exit(1);
+    }
+    root_slots[root_slot_count++] = slot;
+}
+
+void gc_push_root(Value value) {
+    if (eval_count >= eval_capacity) {
+        eval_capacity = eval_capacity < 64 ? 64 : eval_capacity * 2;
+        eval_stack = realloc(eval_stack, sizeof(Value) * eval_capacity);
+    }
+    eval_stack[eval_count++] = value;
+}
+
+void gc_pop_roots(int count) {
+    eval_count -= count;
+}
+
+void gc_swap_root_stack(GcRootStack *save, const GcRootStack *load) {
+    save->values = eval_stack;
+    save->count = eval_count;
+    save->capacity = eval_capacity;
+    eval_stack = load->values;
+    eval_count = load->count;
+    eval_capacity = load->capacity;
+}
+
+void gc_add_root_marker(void (*mark)(void)) {
+    if (root_marker_count >= GC_MAX_ROOT_MARKERS) {
+        fprintf(stderr, "Runtime Error: Terlalu banyak root GC.\n");
+        exit(1);
+    }
+    root_markers[root_marker_count++] = mark;
+}
+
+// --- Parallel Regions ---
+
+void gc_parallel_begin(void) {
+    parallel_region = 1;
+}
+
+int gc_parallel_flush(void) {
+    pthread_mutex_lock(&flush_lock);
+    if (local_objects || local_bytes != 0) {
+        Obj **tail = &local_objects;
+        while (*tail) tail = &(*tail)->next;
+        *tail = objects;
+        objects = local_objects;
+        bytes_allocated += local_bytes;
+        if (bytes_allocated > stat_peak_heap) stat_peak_heap = bytes_allocated;
+        local_objects = NULL;
+        local_bytes = 0;
+    }
+#ifdef GC_STRESS
+    int due = 1;
+#else
+    int due = bytes_allocated > next_gc;
+#endif
+    pthread_mutex_unlock(&flush_lock);
+    return due;
+}
+
+int gc_parallel_flush_due(void) {
+#ifdef GC_STRESS
+    return local_objects != NULL;
+#else
+    return local_bytes >= GC_LOCAL_BUDGET;
+#endif
+}
+
+void gc_parallel_publish(GcThreadRoots *roots) {
+    roots->values = eval_stack;
+    roots->count = eval_count;
+    roots->envs = env_live_list();
+    roots->next = parked_roots;
+    parked_roots = roots;
+}
+
+void gc_parallel_collect(void) {
+    gc_parallel_flush();
+    gc_collect();
+    parked_roots = NULL; // The threads resume and their roots move on
+}
+
+void gc_parallel_end(void) {
+    parallel_region = 0;
+    if (bytes_allocated > stat_peak_heap) stat_peak_heap = bytes_allocated;
+}
+
+void gc_thread_shutdown(void) {
+    free(eval_stack);
+    eval_stack = NULL;
+    eval_count = eval_capacity = 0;
+}
+
+// --- Mark ---
+
+void gc_mark_object(Obj *obj) {
+    if (!obj || obj->marked) return;
+    obj->marked = 1;
+
+    if (gray_count >= gray_capacity) {
+        gray_capacity = gray_capacity < 64 ? 64 : gray_capacity * 2;
+        gray_stack = realloc(gray_stack, sizeof(Obj*) * gray_capacity);
+    }
+    gray_stack[gray_count++] = obj;
+}
+
+void gc_mark_value(Value value) {
+    if (value.type == VAL_STRING) {
+        if (!value.inline_len) gc_mark_object((Obj*)value.as.string);
+    } else if (value.type == VAL_LIST) {
+        gc_mark_object((Obj*)value.as.list);
+    } else if (value.type == VAL_MAP) {
+        gc_mark_object((Obj*)value.as.map);
+    } else if (value.type == VAL_READER) {
+        gc_mark_object((Obj*)value.as.reader);
+    } else if (value.type == VAL_CLOSURE) {
+        gc_mark_object((Obj*)value.as.closure);
+    } else if (value.type == VAL_FUNCTION && declaration_found) {
+        declaration_found(declaration_ctx, value.as.function.declaration);
+    }
+}
+
+static void blacken_object(Obj *obj) {
+    switch (obj->type) {
+        case OBJ_STRING:
+            gc_mark_object((Obj*)((ObjString*)obj)->owner); // NULL for owning strings
+            break;
+        case OBJ_READER:
+            gc_mark_object((Obj*)((ObjReader*)obj)->chunk);
+            break;
+        case OBJ_CLOSURE: {
+            ObjClosure *closure = (ObjClosure*)obj;
+            if (declaration_found) declaration_found(declaration_ctx, closure->declaration);
+            for (int i = 0; i < closure->count; i++) gc_mark_value(closure->captured[i]);
+            break;
+        }
+        case OBJ_LIST: {
+            ObjList *list = (ObjList*)obj;
+            if (list->numeric) break; // Unboxed numbers hold no references
+            for (int i = 0; i < list->count; i++) {
+                gc_mark_value(list->as.items[i]);
+            }
+            break;
+        }
+        case OBJ_MAP: {
+            ObjMap *map = (ObjMap*)obj;
+            for (int i = 0; i < map->entry_count; i++) {
+                gc_mark_value(map->entries[i].key); // Deleted entries hold null
+                gc_mark_value(map->entries[i].value);
+            }
+            break;
+        }
+    }
+}
+
+static void mark_roots() {
+    env_mark_live();
+
+    for (int i = 0; i < eval_count; i++) {
+        gc_mark_value(eval_stack[i]);
+    }
+    for (GcThreadRoots *t = parked_roots; t; t = t->next) {
+        env_mark_list(t->envs);
+        for (int i = 0; i < t->count; i++) gc_mark_value(t->values[i]);
+    }
+    for (int i = 0; i < root_slot_count; i++) {
+        gc_mark_value(*root_slots[i]);
+    }
+    for (int i = 0; i < root_marker_count; i++) {
+        root_markers[i]();
+    }
+}
+
+static void trace_references() {
+    while (gray_count > 0) {
+        Obj *obj = gray_stack[--gray_count];
+        blacken_object(obj);
+    }
+}
+
+// --- Sweep ---
+
+static void release_object(Obj *obj) {
+    if (obj->type == OBJ_LIST) {
+        free(((ObjList*)obj)->as.items);
+    } else if (obj->type == OBJ_MAP) {
+        free(((ObjMap*)obj)->entries);
+        free(((ObjMap*)obj)->index);
+    } else if (obj->type == OBJ_READER) {
+        ObjReader *reader = (ObjReader*)obj;
+        if (reader->file && reader->owns_file) fclose(reader->file);
+    }
+    free(obj);
+}
+
+static void free_object(Obj *obj) {
+    bytes_allocated -= object_size(obj);
+    release_object(obj);
+}
+
+static void sweep() {
+    Obj **link = &objects;
+    while (*link) {
+        Obj *obj = *link;
+        if (obj->marked || obj->pinned) {
+            obj->marked = 0;
+            link = &obj->next;
+        } else {
+            *link = obj->next;
+            stat_bytes_freed += object_size(obj);
+            free_object(obj);
+        }
+    }
+}
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+void gc_collect(void) {
+    double start = now_ms();
+
+    mark_roots();
+    trace_references();
+    sweep();
+
+    next_gc = (size_t)(bytes_allocated * growth_factor);
+    if (next_gc < GC_MIN_HEAP) next_gc = GC_MIN_HEAP;
+
+    double pause = now_ms() - start;
+    stat_collections++;
+    stat_total_pause_ms += pause;
+    if (pause > stat_max_pause_ms) stat_max_pause_ms = pause;
+}
+
+void gc_find_declarations(void (*found)(void *ctx, struct ASTNode *decl), void *ctx) {
+    declaration_found = found;
+    declaration_ctx = ctx;
+    gc_collect();
+    declaration_found = NULL;
+    declaration_ctx = NULL;
+}
+
+void gc_shutdown(void) {
+    Obj *obj = objects;
+    while (obj) {
+        Obj *next = obj->next;
+        release_object(obj);
+        obj = next;
+    }
+    objects = NULL;
+    bytes_allocated = 0;
+    next_gc = GC_MIN_HEAP;
+
+    free(gray_stack);
+    gray_stack = NULL;
+    gray_count = gray_capacity = 0;
+
+    free(eval_stack);
+    eval_stack = NULL;
+    eval_count = eval_capacity = 0;
+
+    root_slot_count = 0;
+    root_marker_count = 0;
+}
+
+// --- Tuning & Statistics ---
+
+void gc_set_growth_factor(double factor) {
+    // Below 1.0 the threshold would shrink under the live set and collect on every allocation
+    if (factor < 1.1) factor = 1.1;
+    growth_factor = factor;
+}
+
+void gc_print_stats(FILE *out) {
+    fprintf(out, "--- Statistik GC ---\n");
+    fprintf(out, "Koleksi        : %zu\n", stat_collections);
+    fprintf(out, "Total jeda     : %.3f ms\n", stat_total_pause_ms);
+    fprintf(out, "Jeda maksimum  : %.3f ms\n", stat_max_pause_ms);
+    fprintf(out, "Rata-rata jeda : %.3f ms\n",
+            stat_collections ? stat_total_pause_ms / stat_collections : 0.0);
+    fprintf(out, "Byte dibebaskan: %zu\n", stat_bytes_freed);
+    fprintf(out, "Heap saat ini  : %zu\n", bytes_allocated);
+    fprintf(out, "Heap puncak    : %zu\n", stat_peak_heap);
+    fprintf(out, "Faktor tumbuh  : %.2f\n", growth_factor);
+}
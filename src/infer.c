@@ -0,0 +1,600 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "infer.h"
+#include "builtins.h"
+
+// Lattice: NONE (no value seen yet) < INT < ANY. The analysis iterates to the
+// least fixed point, so recursion such as fib(n - 1) + fib(n - 2) settles on
+// INT; anything still NONE afterwards is never marked.
+typedef enum {
+    TY_NONE,
+    TY_INT,
+    TY_ANY
+} Ty;
+
+typedef struct Scope Scope;
+
+typedef struct {
+    const char *name;
+    Ty type;            // Join of every value bound to the name in this scope
+    int is_param;
+    int func_bindings;  // 'fungsi' declarations of this name
+    int other_bindings; // 'biar' bindings
+    int loop_bindings;  // 'ulang' counters
+    Scope *func;        // Scope of the last 'fungsi' bound to it
+} Var;
+
+// One per function body, plus one for top-level code whose variables are
+// the globals. Blocks do not open scopes, so nothing finer is needed.
+struct Scope {
+    FuncDeclNode *decl;  // NULL for top-level code
+    ASTNode *body;       // Statement list
+    Scope *parent;       // Enclosing scope for nested functions, NULL otherwise
+    Var *vars;
+    int var_count;
+    int var_capacity;
+    int *index;          // Open-addressing table over vars, -1 = empty
+    int index_capacity;  // Power of two
+    int param_count;
+    Ty ret;              // Join of every 'kembali' value
+    int always_returns;  // Body ends in 'kembali', so a call never yields null
+    int escapes;         // Used as a value: callers are not all visible
+    Scope *all_next;
+};
+
+static Scope *scopes;     // Every scope, newest first
+static Scope *top;        // Top-level code
+static int changed;
+static int annotating;    // Final pass: write results into the AST
+static int hidden_calls;  // Some body is not parsed yet: its calls are unseen
+static Environment *start_env;
+
+// Counters of the 'ulang' loops enclosing the statement being visited
+#define MAX_LOOP_DEPTH 256
+static const char *loop_vars[MAX_LOOP_DEPTH];
+static int loop_depth;
+
+// Natives that always produce a number when they succeed
+static const char *int_natives[] = {
+    "panjang", "jumlah", "hitung", "dot", "punya", "hapus", "hitung_baris",
+    "waktu", "waktu_ms", "mutlak", "akar", "pangkat", NULL
+};
+
+// --- Scopes ---
+
+static unsigned hash_name(const char *name) {
+    unsigned h = 2166136261u;
+    for (const char *p = name; *p; p++) {
+        h ^= (unsigned char)*p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static Var* find_var(Scope *s, const char *name) {
+    if (!s->index) return NULL;
+    unsigned mask = s->index_capacity - 1;
+    for (unsigned i = hash_name(name) & mask; s->index[i] >= 0; i = (i + 1) & mask) {
+        Var *v = &s->vars[s->index[i]];
+        if (strcmp(v->name, name) == 0) return v;
+    }
+    return NULL;
+}
+
+static void grow_index(Scope *s) {
+    free(s->index);
+    s->index_capacity = s->index_capacity ? s->index_capacity * 2 : 16;
+    s->index = malloc(sizeof(int) * s->index_capacity);
+    memset(s->index, -1, sizeof(int) * s->index_capacity);
+
+    unsigned mask = s->index_capacity - 1;
+    for (int n = 0; n < s->var_count; n++) {
+        unsigned i = hash_name(s->vars[n].name) & mask;
+        while (s->index[i] >= 0) i = (i + 1) & mask;
+        s->index[i] = n;
+    }
+}
+
+static Var* declare_var(Scope *s, const char *name) {
+    Var *v = find_var(s, name);
+    if (v) return v;
+
+    if (s->var_count >= s->var_capacity) {
+        s->var_capacity = s->var_capacity ? s->var_capacity * 2 : 8;
+        s->vars = realloc(s->vars, sizeof(Var) * s->var_capacity);
+    }
+    v = &s->vars[s->var_count++];
+    memset(v, 0, sizeof(Var));
+    v->name = name;
+
+    if (s->var_count * 2 > s->index_capacity) {
+        grow_index(s); // Also indexes the new var
+    } else {
+        unsigned mask = s->index_capacity - 1;
+        unsigned i = hash_name(name) & mask;
+        while (s->index[i] >= 0) i = (i + 1) & mask;
+        s->index[i] = s->var_count - 1;
+    }
+    return v;
+}
+
+static Scope* new_scope(FuncDeclNode *decl, ASTNode *body, Scope *parent) {
+    Scope *s = calloc(1, sizeof(Scope));
+    s->decl = decl;
+    s->body = body;
+    s->parent = parent;
+    s->all_next = scopes;
+    scopes = s;
+    return s;
+}
+
+static void join(Ty *slot, Ty t) {
+    if (t > *slot) {
+        *slot = t;
+        changed = 1;
+    }
+}
+
+static Ty combine(Ty a, Ty b) {
+    if (a == TY_ANY || b == TY_ANY) return TY_ANY;
+    if (a == TY_NONE || b == TY_NONE) return TY_NONE;
+    return TY_INT;
+}
+
+// --- Collection: which names each scope binds ---
+
+static void collect(Scope *s, ASTNode *stmts);
+
+static void collect_function(Scope *s, FuncDeclNode *f) {
+    Var *v = declare_var(s, f->name);
+    v->func_bindings++;
+
+    if (!f->body) hidden_calls = 1; // Lazy (parser.h); it stays an empty scope
+    Scope *fs = new_scope(f, f->body ? ((BlockNode*)f->body)->statements : NULL, s == top ? NULL : s);
+    v->func = fs;
+    for (ASTNode *p = f->params; p; p = p->next) {
+        declare_var(fs, ((VarAccessNode*)p)->name)->is_param = 1;
+        fs->param_count++;
+    }
+
+    ASTNode *last = fs->body;
+    while (last && last->next) last = last->next;
+    fs->always_returns = last && last->type == NODE_RETURN;
+
+    collect(fs, fs->body);
+}
+
+static void collect_binding(void *ctx, ASTNode *binder, const char *name) {
+    Scope *s = ctx;
+    switch (binder->type) {
+        case NODE_FUNC_DECL: collect_function(s, (FuncDeclNode*)binder); break;
+        case NODE_REPEAT: declare_var(s, name)->loop_bindings++; break;
+        default: declare_var(s, name)->other_bindings++; break;
+    }
+}
+
+static void collect(Scope *s, ASTNode *stmts) {
+    walk_bindings(stmts, collect_binding, s);
+}
+
+// --- Name resolution ---
+
+// A global function that every call by this name is known to reach
+static Scope* stable_function(const char *name) {
+    Var *g = find_var(top, name);
+    if (!g || g->func_bindings != 1 || g->other_bindings || g->loop_bindings) return NULL;
+    return g->func;
+}
+
+static Ty global_type(const char *name) {
+    Var *g = find_var(top, name);
+    if (!g) return TY_ANY; // Natives, or undefined (an error either way)
+    if (g->func_bindings) return TY_ANY;
+    return g->type;
+}
+
+// Inside its loop a counter always holds a number. After the loop it may
+// hold null (an empty range binds the slot without assigning it), which is
+// why 'ulang' joins ANY into the variable itself.
+static int is_loop_counter(Scope *s, const char *name) {
+    for (int i = loop_depth - 1; i >= 0; i--) {
+        if (strcmp(loop_vars[i], name) != 0) continue;
+        Var *v = find_var(s, name);
+        return !v->other_bindings && !v->func_bindings;
+    }
+    return 0;
+}
+
+// Bound by an enclosing function: a closure copy of unknown type (resolve.h)
+static int is_captured(Scope *s, const char *name) {
+    for (Scope *outer = s->parent; outer; outer = outer->parent) {
+        if (find_var(outer, name)) return 1;
+    }
+    return 0;
+}
+
+// Function scopes chain straight to the global environment at run time,
+// apart from the variables they capture
+static Ty name_type(Scope *s, const char *name) {
+    if (is_loop_counter(s, name)) return TY_INT;
+    if (s == top) return global_type(name);
+
+    Var *v = find_var(s, name);
+    if (!v) return is_captured(s, name) ? TY_ANY : global_type(name);
+    if (v->func_bindings) return TY_ANY;
+    if (v->is_param) return v->type; // Short calls already joined the global in
+    // Before its first binding the name still resolves to the global, or to
+    // the enclosing function's value when it is captured as well
+    for (int i = 0; i < s->decl->capture_count; i++) {
+        if (strcmp(s->decl->captures[i], name) == 0) return TY_ANY;
+    }
+    Ty g = global_type(name);
+    return v->type > g ? v->type : g;
+}
+
+static int is_local(Scope *s, const char *name) {
+    return s != top && (find_var(s, name) != NULL || is_captured(s, name));
+}
+
+static void mark_escaped(Scope *f) {
+    if (f->escapes) return;
+    f->escapes = 1;
+    changed = 1;
+}
+
+// --- Expressions ---
+
+static Ty expr_type(Scope *s, ASTNode *e);
+
+static Ty call_type(Scope *s, CallExprNode *c) {
+    int argc = 0;
+    Ty arg_types[64];
+    for (ASTNode *a = c->arguments; a; a = a->next, argc++) {
+        Ty t = expr_type(s, a);
+        if (argc < 64) arg_types[argc] = t;
+    }
+
+    if (is_local(s, c->callee)) return TY_ANY;
+
+    Scope *f = stable_function(c->callee);
+    if (f) {
+        int i = 0;
+        for (ASTNode *p = f->decl->params; p; p = p->next, i++) {
+            const char *param = ((VarAccessNode*)p)->name;
+            // Unbound parameters fall through to the global of the same name
+            Ty t = i < argc ? (i < 64 ? arg_types[i] : TY_ANY) : global_type(param);
+            join(&find_var(f, param)->type, t);
+        }
+        return f->always_returns ? f->ret : TY_ANY;
+    }
+
+    Value bound;
+    if (!find_var(top, c->callee) && env_get(start_env, c->callee, &bound) &&
+        bound.type == VAL_NATIVE && strcmp(bound.as.native->name, c->callee) == 0) {
+        for (const char **n = int_natives; *n; n++) {
+            if (strcmp(*n, c->callee) == 0) return TY_INT;
+        }
+    }
+    return TY_ANY;
+}
+
+static Ty expr_type(Scope *s, ASTNode *e) {
+    if (!e) return TY_ANY;
+
+    Ty t = TY_ANY;
+    switch (e->type) {
+        case NODE_LITERAL:
+            t = ((LiteralNode*)e)->type == TOKEN_NUMBER ? TY_INT : TY_ANY;
+            break;
+        case NODE_VAR_ACCESS: {
+            const char *name = ((VarAccessNode*)e)->name;
+            if (!is_local(s, name)) {
+                Scope *f = stable_function(name);
+                Var *g = find_var(top, name);
+                if (f) mark_escaped(f);
+                else if (g && g->func) mark_escaped(g->func);
+            }
+            t = name_type(s, name);
+            break;
+        }
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *b = (BinaryExprNode*)e;
+            Ty l = expr_type(s, b->left);
+            Ty r = expr_type(s, b->right);
+            t = combine(l, r);
+            break;
+        }
+        case NODE_CALL_EXPR:
+            t = call_type(s, (CallExprNode*)e);
+            break;
+        case NODE_LIST:
+            for (ASTNode *i = ((ListNode*)e)->elements; i; i = i->next) expr_type(s, i);
+            break;
+        case NODE_MAP:
+            for (ASTNode *k = ((MapNode*)e)->keys; k; k = k->next) expr_type(s, k);
+            for (ASTNode *v = ((MapNode*)e)->values; v; v = v->next) expr_type(s, v);
+            break;
+        case NODE_INDEX:
+            expr_type(s, ((IndexNode*)e)->target);
+            expr_type(s, ((IndexNode*)e)->index);
+            break;
+        case NODE_INTERP:
+            for (ASTNode *p = ((InterpNode*)e)->parts; p; p = p->next) expr_type(s, p);
+            break;
+        default:
+            break;
+    }
+
+    if (annotating) e->static_type = t == TY_INT ? STATIC_INT : STATIC_UNKNOWN;
+    return t;
+}
+
+// --- Statements ---
+
+static void visit(Scope *s, ASTNode *stmts) {
+    for (ASTNode *n = stmts; n; n = n->next) {
+        switch (n->type) {
+            case NODE_VAR_DECL: {
+                VarDeclNode *v = (VarDeclNode*)n;
+                join(&find_var(s, v->name)->type, expr_type(s, v->value));
+                break;
+            }
+            case NODE_PRINT:
+                expr_type(s, ((PrintNode*)n)->expression);
+                break;
+            case NODE_RETURN:
+                join(&s->ret, expr_type(s, ((ReturnNode*)n)->value));
+                break;
+            case NODE_BLOCK:
+                visit(s, ((BlockNode*)n)->statements);
+                break;
+            case NODE_IF:
+                expr_type(s, ((IfNode*)n)->condition);
+                visit(s, ((BlockNode*)((IfNode*)n)->then_branch)->statements);
+                break;
+            case NODE_REPEAT: {
+                RepeatNode *r = (RepeatNode*)n;
+                expr_type(s, r->start);
+                expr_type(s, r->end);
+                join(&find_var(s, r->var_name)->type, TY_ANY);
+                if (loop_depth < MAX_LOOP_DEPTH) {
+                    loop_vars[loop_depth++] = r->var_name;
+                    visit(s, ((BlockNode*)r->body)->statements);
+                    loop_depth--;
+                } else {
+                    visit(s, ((BlockNode*)r->body)->statements);
+                }
+                break;
+            }
+            case NODE_WHILE:
+                expr_type(s, ((WhileNode*)n)->condition);
+                visit(s, ((BlockNode*)((WhileNode*)n)->body)->statements);
+                break;
+            case NODE_BINARY_EXPR:
+            case NODE_CALL_EXPR:
+                expr_type(s, n);
+                break;
+            default:
+                break; // Function bodies are their own scopes
+        }
+    }
+}
+
+// Callers the analysis cannot enumerate may pass anything
+static void widen_open_params(Scope *s) {
+    if (s == top) return;
+    int open = hidden_calls || s->parent || s->escapes || stable_function(s->decl->name) != s;
+    if (!open) return;
+    for (int i = 0; i < s->var_count; i++) {
+        if (s->vars[i].is_param) join(&s->vars[i].type, TY_ANY);
+    }
+}
+
+// --- Diagnostics ---
+
+static void write_expr(ASTNode *e, FILE *out) {
+    switch (e->type) {
+        case NODE_LITERAL: {
+            LiteralNode *l = (LiteralNode*)e;
+            if (l->type == TOKEN_STRING) fprintf(out, "\"%s\"", l->string_val);
+            else if (l->type == TOKEN_DECIMAL) fprintf(out, "%g", l->decimal_val);
+            else fprintf(out, "%lld", (long long)l->int_val);
+            break;
+        }
+        case NODE_VAR_ACCESS:
+            fputs(((VarAccessNode*)e)->name, out);
+            break;
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *b = (BinaryExprNode*)e;
+            const char *op = "?";
+            switch (b->op) {
+                case TOKEN_PLUS: op = "+"; break;
+                case TOKEN_MINUS: op = "-"; break;
+                case TOKEN_STAR: op = "*"; break;
+                case TOKEN_SLASH: op = "/"; break;
+                case TOKEN_LT: op = "<"; break;
+                case TOKEN_GT: op = ">"; break;
+                case TOKEN_LT_EQ: op = "<="; break;
+                case TOKEN_GT_EQ: op = ">="; break;
+                case TOKEN_EQ_EQ: op = "=="; break;
+                case TOKEN_BANG_EQ: op = "!="; break;
+                default: break;
+            }
+            int lp = b->left->type == NODE_BINARY_EXPR;
+            int rp = b->right->type == NODE_BINARY_EXPR;
+            if (lp) fputc('(', out);
+            write_expr(b->left, out);
+            fprintf(out, lp ? ") %s " : " %s ", op);
+            if (rp) fputc('(', out);
+            write_expr(b->right, out);
+            if (rp) fputc(')', out);
+            break;
+        }
+        case NODE_CALL_EXPR: {
+            CallExprNode *c = (CallExprNode*)e;
+            fprintf(out, "%s(", c->callee);
+            for (ASTNode *a = c->arguments; a; a = a->next) {
+                write_expr(a, out);
+                if (a->next) fputs(", ", out);
+            }
+            fputc(')', out);
+            break;
+        }
+        case NODE_LIST:
+            fputs("[...]", out);
+            break;
+        case NODE_MAP:
+            fputs("{...}", out);
+            break;
+        case NODE_INDEX:
+            write_expr(((IndexNode*)e)->target, out);
+            fputs("[", out);
+            write_expr(((IndexNode*)e)->index, out);
+            fputs("]", out);
+            break;
+        case NODE_INTERP:
+            fputs("\"...\"", out);
+            break;
+        default:
+            break;
+    }
+}
+
+static int dump_count;
+
+// Lists the outermost specialized operator of each expression tree
+static void dump_expr(ASTNode *e, FILE *out) {
+    if (!e) return;
+    switch (e->type) {
+        case NODE_BINARY_EXPR:
+            if (e->static_type == STATIC_INT) {
+                fputs("  angka: ", out);
+                write_expr(e, out);
+                fputc('\n', out);
+                dump_count++;
+                return;
+            }
+            dump_expr(((BinaryExprNode*)e)->left, out);
+            dump_expr(((BinaryExprNode*)e)->right, out);
+            break;
+        case NODE_CALL_EXPR:
+            for (ASTNode *a = ((CallExprNode*)e)->arguments; a; a = a->next) dump_expr(a, out);
+            break;
+        case NODE_LIST:
+            for (ASTNode *i = ((ListNode*)e)->elements; i; i = i->next) dump_expr(i, out);
+            break;
+        case NODE_MAP:
+            for (ASTNode *k = ((MapNode*)e)->keys; k; k = k->next) dump_expr(k, out);
+            for (ASTNode *v = ((MapNode*)e)->values; v; v = v->next) dump_expr(v, out);
+            break;
+        case NODE_INDEX:
+            dump_expr(((IndexNode*)e)->target, out);
+            dump_expr(((IndexNode*)e)->index, out);
+            break;
+        case NODE_INTERP:
+            for (ASTNode *p = ((InterpNode*)e)->parts; p; p = p->next) dump_expr(p, out);
+            break;
+        default:
+            break;
+    }
+}
+
+static void dump_stmts(ASTNode *stmts, FILE *out) {
+    for (ASTNode *n = stmts; n; n = n->next) {
+        switch (n->type) {
+            case NODE_VAR_DECL: dump_expr(((VarDeclNode*)n)->value, out); break;
+            case NODE_PRINT: dump_expr(((PrintNode*)n)->expression, out); break;
+            case NODE_RETURN: dump_expr(((ReturnNode*)n)->value, out); break;
+            case NODE_BLOCK: dump_stmts(((BlockNode*)n)->statements, out); break;
+            case NODE_IF:
+                dump_expr(((IfNode*)n)->condition, out);
+                dump_stmts(((BlockNode*)((IfNode*)n)->then_branch)->statements, out);
+                break;
+            case NODE_REPEAT: {
+                RepeatNode *r = (RepeatNode*)n;
+                dump_expr(r->start, out);
+                dump_expr(r->end, out);
+                dump_stmts(((BlockNode*)r->body)->statements, out);
+                break;
+            }
+            case NODE_WHILE:
+                dump_expr(((WhileNode*)n)->condition, out);
+                dump_stmts(((BlockNode*)((WhileNode*)n)->body)->statements, out);
+                break;
+            case NODE_BINARY_EXPR:
+            case NODE_CALL_EXPR:
+                dump_expr(n, out);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static const char* type_name(Ty t) {
+    return t == TY_INT ? "angka" : "?";
+}
+
+static void dump_scope(Scope *s, FILE *out) {
+    if (s == top) {
+        fprintf(out, "program\n");
+    } else {
+        fprintf(out, "fungsi %s(", s->decl->name);
+        for (ASTNode *p = s->decl->params; p; p = p->next) {
+            const char *name = ((VarAccessNode*)p)->name;
+            fprintf(out, "%s: %s%s", name, type_name(find_var(s, name)->type), p->next ? ", " : "");
+        }
+        fprintf(out, ") -> %s\n", type_name(s->always_returns ? s->ret : TY_ANY));
+    }
+    dump_stmts(s->body, out);
+}
+
+// --- Entry point ---
+
+void infer_types(ASTNode *program, Environment *globals, FILE *dump) {
+    if (!program || program->type != NODE_PROGRAM) return;
+    start_env = globals;
+
+    scopes = NULL;
+    hidden_calls = 0;
+    top = new_scope(NULL, ((ProgramNode*)program)->statements, NULL);
+    collect(top, top->body);
+
+    do {
+        changed = 0;
+        for (Scope *s = scopes; s; s = s->all_next) {
+            widen_open_params(s);
+            visit(s, s->body);
+        }
+    } while (changed);
+
+    annotating = 1;
+    for (Scope *s = scopes; s; s = s->all_next) visit(s, s->body);
+    annotating = 0;
+
+    if (dump) {
+        // Scopes were pushed newest first; print in source order
+        int count = 0;
+        for (Scope *s = scopes; s; s = s->all_next) count++;
+        Scope **order = malloc(sizeof(Scope*) * count);
+        int i = count;
+        for (Scope *s = scopes; s; s = s->all_next) order[--i] = s;
+
+        dump_count = 0;
+        fprintf(dump, "--- Inferensi tipe ---\n");
+        for (i = 0; i < count; i++) dump_scope(order[i], dump);
+        fprintf(dump, "Node terspesialisasi: %d\n", dump_count);
+        free(order);
+    }
+
+    Scope *s = scopes;
+    while (s) {
+        Scope *next = s->all_next;
+        free(s->vars);
+        free(s->index);
+        free(s);
+        s = next;
+    }
+    scopes = top = NULL;
+}
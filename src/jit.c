@@ -0,0 +1,501 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include "jit.h"
+#include "evaluator.h"
+
+struct JitCode {
+    unsigned char *code; // Executable mapping
+    size_t mapped;
+    size_t length;       // Bytes of machine code
+    Value *self_slot;    // Global binding of the function once found; never moves
+    JitCode *next;
+};
+
+static int jit_enabled = 1;
+static _Thread_local int jit_thread_disabled = 0;
+static int jit_dump = 0;
+static JitCode *all_jit = NULL;
+
+void jit_set_enabled(int enabled) {
+    jit_enabled = enabled;
+}
+
+void jit_disable_thread(void) {
+    jit_thread_disabled = 1;
+}
+
+void jit_set_dump(int dump) {
+    jit_dump = dump;
+}
+
+#if defined(__x86_64__) && defined(__linux__)
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Set by native code when a guard fails; every native frame unwinds on it.
+static volatile unsigned char jit_bailout = 0;
+
+typedef int64_t (*JitFn)(int64_t, int64_t, int64_t, int64_t, int64_t, int64_t);
+
+// --- Eligibility ---
+
+static int param_count(FuncDeclNode *decl) {
+    int n = 0;
+    for (ASTNode *p = decl->params; p; p = p->next) n++;
+    return n;
+}
+
+static int param_index(FuncDeclNode *decl, const char *name) {
+    int i = 0;
+    for (ASTNode *p = decl->params; p; p = p->next, i++) {
+        if (strcmp(((VarAccessNode*)p)->name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static int expr_supported(FuncDeclNode *decl, ASTNode *node) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case NODE_LITERAL:
+            return ((LiteralNode*)node)->type == TOKEN_NUMBER;
+        case NODE_VAR_ACCESS:
+            return param_index(decl, ((VarAccessNode*)node)->name) >= 0;
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *b = (BinaryExprNode*)node;
+            switch (b->op) {
+                case TOKEN_PLUS: case TOKEN_MINUS: case TOKEN_STAR: case TOKEN_SLASH:
+                case TOKEN_LT: case TOKEN_GT: case TOKEN_LT_EQ: case TOKEN_GT_EQ:
+                case TOKEN_EQ_EQ: case TOKEN_BANG_EQ:
+                    return expr_supported(decl, b->left) && expr_supported(decl, b->right);
+                default:
+                    return 0;
+            }
+        }
+        case NODE_CALL_EXPR: {
+            CallExprNode *c = (CallExprNode*)node;
+            if (strcmp(c->callee, decl->name) != 0) return 0; // Self-recursion only
+            int argc = 0;
+            for (ASTNode *a = c->arguments; a; a = a->next, argc++) {
+                if (!expr_supported(decl, a)) return 0;
+            }
+            return argc == param_count(decl);
+        }
+        default:
+            return 0;
+    }
+}
+
+static int stmt_supported(FuncDeclNode *decl, ASTNode *node) {
+    switch (node->type) {
+        case NODE_RETURN:
+            return expr_supported(decl, ((ReturnNode*)node)->value);
+        case NODE_IF: {
+            IfNode *i = (IfNode*)node;
+            return expr_supported(decl, i->condition) && stmt_supported(decl, i->then_branch);
+        }
+        case NODE_BLOCK:
+            for (ASTNode *s = ((BlockNode*)node)->statements; s; s = s->next) {
+                if (!stmt_supported(decl, s)) return 0;
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static int function_supported(FuncDeclNode *decl) {
+    if (param_count(decl) > JIT_MAX_PARAMS) return 0;
+    // A parameter shadowing the function name would turn self-calls into value calls
+    if (param_index(decl, decl->name) >= 0) return 0;
+    return stmt_supported(decl, decl->body);
+}
+
+// --- Emitter ---
+
+typedef struct {
+    unsigned char *buf;
+    size_t len;
+    size_t cap;
+    int depth;            // 8-byte pushes on top of the frame, for call alignment
+    size_t *bail_fixups;  // rel32 fields that jump to the bailout stub
+    int bail_count;
+    int bail_cap;
+} Emitter;
+
+static void emit_byte(Emitter *e, unsigned char b) {
+    if (e->len >= e->cap) {
+        e->cap = e->cap < 256 ? 256 : e->cap * 2;
+        e->buf = realloc(e->buf, e->cap);
+    }
+    e->buf[e->len++] = b;
+}
+
+static void emit(Emitter *e, int count, ...) {
+    va_list ap;
+    va_start(ap, count);
+    for (int i = 0; i < count; i++) emit_byte(e, (unsigned char)va_arg(ap, int));
+    va_end(ap);
+}
+
+static void emit_u32(Emitter *e, uint32_t v) {
+    for (int i = 0; i < 4; i++) emit_byte(e, (v >> (8 * i)) & 0xFF);
+}
+
+static void emit_u64(Emitter *e, uint64_t v) {
+    for (int i = 0; i < 8; i++) emit_byte(e, (v >> (8 * i)) & 0xFF);
+}
+
+static void patch_rel32(Emitter *e, size_t at, size_t target) {
+    int32_t rel = (int32_t)(target - (at + 4));
+    memcpy(e->buf + at, &rel, 4);
+}
+
+// jcc rel32 to a label patched later; returns the rel32 position
+static size_t emit_jcc(Emitter *e, unsigned char cc) {
+    emit(e, 2, 0x0F, cc);
+    size_t at = e->len;
+    emit_u32(e, 0);
+    return at;
+}
+
+static void emit_bail_jcc(Emitter *e, unsigned char cc) {
+    size_t at = emit_jcc(e, cc);
+    if (e->bail_count >= e->bail_cap) {
+        e->bail_cap = e->bail_cap < 16 ? 16 : e->bail_cap * 2;
+        e->bail_fixups = realloc(e->bail_fixups, sizeof(size_t) * e->bail_cap);
+    }
+    e->bail_fixups[e->bail_count++] = at;
+}
+
+#define JCC_JO  0x80
+#define JCC_JE  0x84
+#define JCC_JNE 0x85
+
+static void emit_load_flag_addr(Emitter *e) {
+    emit(e, 2, 0x48, 0xB9); // mov rcx, imm64
+    emit_u64(e, (uint64_t)(uintptr_t)&jit_bailout);
+}
+
+// --- Code Generation ---
+// Expressions leave their 64-bit result in rax, matching the interpreter's
+// integers. Where the interpreter would promote to a decimal (overflow) or
+// report an error (division by zero) the guard fails instead.
+
+static void gen_expr(Emitter *e, FuncDeclNode *decl, ASTNode *node);
+
+static void gen_binary(Emitter *e, FuncDeclNode *decl, BinaryExprNode *b) {
+    gen_expr(e, decl, b->left);
+    emit_byte(e, 0x50); e->depth++;          // push rax
+    gen_expr(e, decl, b->right);
+    emit(e, 3, 0x48, 0x89, 0xC1);            // mov rcx, rax
+    emit_byte(e, 0x58); e->depth--;          // pop rax
+
+    switch (b->op) {
+        case TOKEN_PLUS:
+            emit(e, 3, 0x48, 0x01, 0xC8);    // add rax, rcx
+            emit_bail_jcc(e, JCC_JO);
+            return;
+        case TOKEN_MINUS:
+            emit(e, 3, 0x48, 0x29, 0xC8);    // sub rax, rcx
+            emit_bail_jcc(e, JCC_JO);
+            return;
+        case TOKEN_STAR:
+            emit(e, 4, 0x48, 0x0F, 0xAF, 0xC1); // imul rax, rcx
+            emit_bail_jcc(e, JCC_JO);
+            return;
+        case TOKEN_SLASH: {
+            // x / 0 is an interpreter error and INT64_MIN / -1 a decimal: both bail out
+            emit(e, 3, 0x48, 0x85, 0xC9);    // test rcx, rcx
+            emit_bail_jcc(e, JCC_JE);
+            emit(e, 4, 0x48, 0x83, 0xF9, 0xFF); // cmp rcx, -1
+            size_t do_div = emit_jcc(e, JCC_JNE);
+            emit(e, 2, 0x48, 0xBA);          // mov rdx, INT64_MIN
+            emit_u64(e, (uint64_t)INT64_MIN);
+            emit(e, 3, 0x48, 0x39, 0xD0);    // cmp rax, rdx
+            emit_bail_jcc(e, JCC_JE);
+
+            patch_rel32(e, do_div, e->len);
+            emit(e, 2, 0x48, 0x99);          // cqo
+            emit(e, 3, 0x48, 0xF7, 0xF9);    // idiv rcx
+            return;
+        }
+        default: {
+            unsigned char setcc;
+            switch (b->op) {
+                case TOKEN_LT: setcc = 0x9C; break;
+                case TOKEN_GT: setcc = 0x9F; break;
+                case TOKEN_LT_EQ: setcc = 0x9E; break;
+                case TOKEN_GT_EQ: setcc = 0x9D; break;
+                case TOKEN_EQ_EQ: setcc = 0x94; break;
+                default: setcc = 0x95; break; // TOKEN_BANG_EQ
+            }
+            emit(e, 3, 0x48, 0x39, 0xC8);    // cmp rax, rcx
+            emit(e, 3, 0x0F, setcc, 0xC0);   // setcc al
+            emit(e, 3, 0x0F, 0xB6, 0xC0);    // movzx eax, al
+            return;
+        }
+    }
+}
+
+static void gen_self_call(Emitter *e, FuncDeclNode *decl, CallExprNode *c) {
+    // pop rdi, rsi, rdx, rcx, r8, r9
+    static const unsigned char pop_arg[JIT_MAX_PARAMS][2] = {
+        {0x5F, 0}, {0x5E, 0}, {0x5A, 0}, {0x59, 0}, {0x41, 0x58}, {0x41, 0x59}
+    };
+
+    int argc = 0;
+    for (ASTNode *a = c->arguments; a; a = a->next, argc++) {
+        gen_expr(e, decl, a);
+        emit_byte(e, 0x50); e->depth++;      // push rax
+    }
+    for (int i = argc - 1; i >= 0; i--) {
+        if (pop_arg[i][1]) emit(e, 2, pop_arg[i][0], pop_arg[i][1]);
+        else emit_byte(e, pop_arg[i][0]);
+        e->depth--;
+    }
+
+    int misaligned = e->depth % 2;
+    if (misaligned) emit(e, 4, 0x48, 0x83, 0xEC, 0x08); // sub rsp, 8
+
+    emit_byte(e, 0xE8);                       // call <function start>
+    size_t at = e->len;
+    emit_u32(e, 0);
+    patch_rel32(e, at, 0);
+
+    if (misaligned) emit(e, 4, 0x48, 0x83, 0xC4, 0x08); // add rsp, 8
+
+    emit_load_flag_addr(e);
+    emit(e, 3, 0x80, 0x39, 0x00);             // cmp byte [rcx], 0
+    emit_bail_jcc(e, JCC_JNE);
+}
+
+static void gen_expr(Emitter *e, FuncDeclNode *decl, ASTNode *node) {
+    switch (node->type) {
+        case NODE_LITERAL: {
+            int64_t value = ((LiteralNode*)node)->int_val;
+            if (value >= INT32_MIN && value <= INT32_MAX) {
+                emit(e, 3, 0x48, 0xC7, 0xC0); // mov rax, imm32 (sign-extended)
+                emit_u32(e, (uint32_t)value);
+            } else {
+                emit(e, 2, 0x48, 0xB8);       // mov rax, imm64
+                emit_u64(e, (uint64_t)value);
+            }
+            break;
+        }
+        case NODE_VAR_ACCESS: {
+            int slot = param_index(decl, ((VarAccessNode*)node)->name);
+            emit(e, 4, 0x48, 0x8B, 0x45, (unsigned char)(-8 * (slot + 1))); // mov rax, [rbp-8*(slot+1)]
+            break;
+        }
+        case NODE_BINARY_EXPR:
+            gen_binary(e, decl, (BinaryExprNode*)node);
+            break;
+        case NODE_CALL_EXPR:
+            gen_self_call(e, decl, (CallExprNode*)node);
+            break;
+        default:
+            break; // Rejected by expr_supported
+    }
+}
+
+static void gen_stmt(Emitter *e, FuncDeclNode *decl, ASTNode *node) {
+    switch (node->type) {
+        case NODE_RETURN:
+            gen_expr(e, decl, ((ReturnNode*)node)->value);
+            emit(e, 2, 0xC9, 0xC3);           // leave; ret
+            break;
+        case NODE_IF: {
+            IfNode *i = (IfNode*)node;
+            gen_expr(e, decl, i->condition);
+            emit(e, 3, 0x48, 0x85, 0xC0);     // test rax, rax
+            size_t skip = emit_jcc(e, JCC_JE);
+            gen_stmt(e, decl, i->then_branch);
+            patch_rel32(e, skip, e->len);
+            break;
+        }
+        case NODE_BLOCK:
+            for (ASTNode *s = ((BlockNode*)node)->statements; s; s = s->next) {
+                gen_stmt(e, decl, s);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void gen_function(Emitter *e, FuncDeclNode *decl) {
+    // mov [rbp-8*(i+1)], rdi / rsi / rdx / rcx / r8 / r9
+    static const unsigned char store_arg[JIT_MAX_PARAMS][3] = {
+        {0x48, 0x89, 0x7D}, {0x48, 0x89, 0x75}, {0x48, 0x89, 0x55},
+        {0x48, 0x89, 0x4D}, {0x4C, 0x89, 0x45}, {0x4C, 0x89, 0x4D}
+    };
+
+    int n = param_count(decl);
+    uint32_t frame = (uint32_t)((n * 8 + 15) & ~15);
+
+    emit_byte(e, 0x55);                       // push rbp
+    emit(e, 3, 0x48, 0x89, 0xE5);             // mov rbp, rsp
+    emit(e, 3, 0x48, 0x81, 0xEC);             // sub rsp, frame
+    emit_u32(e, frame);
+    for (int i = 0; i < n; i++) {
+        emit(e, 4, store_arg[i][0], store_arg[i][1], store_arg[i][2], (unsigned char)(-8 * (i + 1)));
+    }
+
+    gen_stmt(e, decl, decl->body);
+
+    // Falling off the end returns null in the interpreter: bail out.
+    size_t bail = e->len;
+    emit_load_flag_addr(e);
+    emit(e, 3, 0xC6, 0x01, 0x01);             // mov byte [rcx], 1
+    emit(e, 2, 0xC9, 0xC3);                   // leave; ret
+
+    for (int i = 0; i < e->bail_count; i++) {
+        patch_rel32(e, e->bail_fixups[i], bail);
+    }
+}
+
+static void dump_code(FuncDeclNode *decl, JitCode *jc) {
+    fprintf(stderr, "JIT: %s dikompilasi (%zu byte) @ %p\n", decl->name, jc->length, (void*)jc->code);
+    for (size_t i = 0; i < jc->length; i++) {
+        fprintf(stderr, "%s%02x", (i % 16 == 0) ? "  " : " ", jc->code[i]);
+        if (i % 16 == 15 || i + 1 == jc->length) fprintf(stderr, "\n");
+    }
+}
+
+static JitCode* install(Emitter *e) {
+    long page = sysconf(_SC_PAGESIZE);
+    size_t mapped = (e->len + page - 1) & ~(size_t)(page - 1);
+
+    void *mem = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return NULL;
+    memcpy(mem, e->buf, e->len);
+    if (mprotect(mem, mapped, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, mapped);
+        return NULL;
+    }
+
+    JitCode *jc = malloc(sizeof(JitCode));
+    jc->code = mem;
+    jc->mapped = mapped;
+    jc->length = e->len;
+    jc->self_slot = NULL;
+    jc->next = all_jit;
+    all_jit = jc;
+    return jc;
+}
+
+static int jit_compile(FuncDeclNode *decl) {
+    if (!function_supported(decl)) {
+        if (jit_dump) fprintf(stderr, "JIT: %s tidak didukung, tetap diinterpretasi\n", decl->name);
+        return 0;
+    }
+
+    Emitter e = {0};
+    gen_function(&e, decl);
+    decl->jit = install(&e);
+    free(e.buf);
+    free(e.bail_fixups);
+
+    if (!decl->jit) return 0;
+    if (jit_dump) dump_code(decl, decl->jit);
+    return 1;
+}
+
+// --- Entry ---
+
+static int self_binding_intact(FuncDeclNode *decl) {
+    // Native self-calls are bound at compile time; the global name must still
+    // resolve to this declaration for that to match the interpreter. Global
+    // bindings are updated in place, so the slot is looked up only once.
+    JitCode *jc = decl->jit;
+    if (!jc->self_slot) {
+        Environment *owner;
+        jc->self_slot = env_find(evaluator_global_env(), decl->name, &owner);
+        if (!jc->self_slot) return 0;
+    }
+    Value *v = jc->self_slot;
+    return v->type == VAL_FUNCTION && v->as.function.declaration == (ASTNode*)decl;
+}
+
+int jit_try_call(FuncDeclNode *decl, Value *args, int argc, Value *out_val) {
+    if (!jit_enabled || jit_thread_disabled || decl->jit_state == JIT_REJECTED) return 0;
+
+    int all_int = 1;
+    for (int i = 0; i < argc; i++) {
+        if (args[i].type != VAL_NUMBER) all_int = 0;
+    }
+
+    if (decl->jit_state == JIT_COLD) {
+        if (!all_int) {
+            decl->jit_state = JIT_REJECTED; // Not type-stable on integers
+            return 0;
+        }
+        if (++decl->call_count < JIT_HOT_THRESHOLD) return 0;
+        decl->jit_state = jit_compile(decl) ? JIT_COMPILED : JIT_REJECTED;
+        if (decl->jit_state != JIT_COMPILED) return 0;
+    }
+
+    // Entry guards
+    if (!all_int || argc != param_count(decl) || !self_binding_intact(decl)) return 0;
+
+    int64_t a[JIT_MAX_PARAMS] = {0};
+    for (int i = 0; i < argc; i++) a[i] = args[i].as.number;
+
+    JitFn fn = (JitFn)(void*)decl->jit->code;
+    int64_t result = fn(a[0], a[1], a[2], a[3], a[4], a[5]);
+
+    if (jit_bailout) {
+        jit_bailout = 0;
+        if (++decl->deopt_count >= JIT_MAX_DEOPTS) decl->jit_state = JIT_REJECTED;
+        if (jit_dump) fprintf(stderr, "JIT: deoptimisasi %s\n", decl->name);
+        return 0;
+    }
+
+    *out_val = make_number(result);
+    return 1;
+}
+
+void jit_release(FuncDeclNode *decl) {
+    if (!decl->jit) return;
+    for (JitCode **link = &all_jit; *link; link = &(*link)->next) {
+        if (*link != decl->jit) continue;
+        *link = decl->jit->next;
+        munmap(decl->jit->code, decl->jit->mapped);
+        free(decl->jit);
+        break;
+    }
+    decl->jit = NULL;
+}
+
+void cleanup_jit() {
+    JitCode *jc = all_jit;
+    while (jc) {
+        JitCode *next = jc->next;
+        munmap(jc->code, jc->mapped);
+        free(jc);
+        jc = next;
+    }
+    all_jit = NULL;
+}
+
+#else // No native backend for this platform
+
+int jit_try_call(FuncDeclNode *decl, Value *args, int argc, Value *out_val) {
+    (void)decl; (void)args; (void)argc; (void)out_val;
+    return 0;
+}
+
+void jit_release(FuncDeclNode *decl) {
+    (void)decl;
+}
+
+void cleanup_jit() {
+    (void)all_jit;
+}
+
+#endif
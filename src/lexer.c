@@ -3,22 +3,56 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include "lexer.h"
+#include "scan.h"
 
-static const char *src;
-static int pos = 0;
-static int line = 1;
+// Per thread, so chunks of one source can be lexed concurrently (parser.h)
+static _Thread_local const char *src;
+static _Thread_local size_t src_len = 0;
+static _Thread_local int pos = 0;
+static _Thread_local int line = 1;
 
 // Buffer untuk peek_token
-static Token current_token;
-static int token_consumed = 1;
+static _Thread_local Token current_token;
+static _Thread_local int token_consumed = 1;
+static _Thread_local int discard_text = 0; // skip_token: tokens carry no value
+static _Thread_local const char *skipped_text; // Source of the last discarded token
+static _Thread_local int skipped_length;
 
 void init_lexer(const char *source) {
+    init_lexer_at(source, 1);
+}
+
+void init_lexer_at(const char *source, int first_line) {
+    init_lexer_span(source, strlen(source), first_line);
+}
+
+void init_lexer_span(const char *source, size_t length, int first_line) {
     src = source;
+    src_len = length;
+    scan_init();
     pos = 0;
-    line = 1;
+    line = first_line;
     token_consumed = 1;
 }
 
+void lexer_save(LexerState *state) {
+    state->src = src;
+    state->src_len = src_len;
+    state->pos = pos;
+    state->line = line;
+    state->current_token = current_token;
+    state->token_consumed = token_consumed;
+}
+
+void lexer_restore(const LexerState *state) {
+    src = state->src;
+    src_len = state->src_len;
+    pos = state->pos;
+    line = state->line;
+    current_token = state->current_token;
+    token_consumed = state->token_consumed;
+}
+
 static char peek_char() {
     return src[pos];
 }
@@ -36,15 +70,59 @@ static char advance_char() {
 }
 
 static void skip_whitespace() {
-    while (isspace(peek_char())) {
-        advance_char();
-    }
+    pos = scan_whitespace(src, pos, src_len, &line);
+}
+
+// --- Keywords ---
+// Perfect hash over (length, first char, last char). Slots are assigned with
+// designated initializers computed by the same macro at compile time, so a
+// new keyword that collides is reported by -Woverride-init (-Wextra); pick
+// other multipliers until the table builds cleanly.
+
+#define KEYWORD_SLOTS 16
+#define KEYWORD_HASH(len, first, last) \
+    (((len) * 3 + (unsigned char)(first) + (unsigned char)(last) * 4) & (KEYWORD_SLOTS - 1))
+// First and last characters are spelled out: indexing a string literal is
+// not a constant expression in C
+#define KEYWORD(word, first, last, token) \
+    [KEYWORD_HASH(sizeof(word) - 1, first, last)] = {word, sizeof(word) - 1, token}
+
+typedef struct {
+    const char *word;
+    int length;
+    TokenType type;
+} Keyword;
+
+static const Keyword keywords[KEYWORD_SLOTS] = {
+    KEYWORD("tulis", 't', 's', TOKEN_TULIS),
+    KEYWORD("biar", 'b', 'r', TOKEN_BIAR),
+    KEYWORD("jika", 'j', 'a', TOKEN_JIKA),
+    KEYWORD("maka", 'm', 'a', TOKEN_MAKA),
+    KEYWORD("akhir", 'a', 'r', TOKEN_AKHIR),
+    KEYWORD("fungsi", 'f', 'i', TOKEN_FUNGSI),
+    KEYWORD("kembali", 'k', 'i', TOKEN_KEMBALI),
+    KEYWORD("dan", 'd', 'n', TOKEN_DAN),
+    KEYWORD("atau", 'a', 'u', TOKEN_ATAU),
+    KEYWORD("ulang", 'u', 'g', TOKEN_ULANG),
+    KEYWORD("selama", 's', 'a', TOKEN_SELAMA),
+};
+
+static TokenType keyword_type(const char *start, int length) {
+    const Keyword *k = &keywords[KEYWORD_HASH(length, start[0], start[length - 1])];
+    if (k->length == length && memcmp(k->word, start, length) == 0) return k->type;
+    return TOKEN_IDENTIFIER;
 }
 
 static Token make_token(TokenType type, const char *start, int length) {
     Token token;
     token.type = type;
     token.line = line;
+    if (discard_text) {
+        token.value = NULL;
+        skipped_text = start;
+        skipped_length = length;
+        return token;
+    }
     token.value = malloc(length + 1);
     strncpy(token.value, start, length);
     token.value[length] = '\0';
@@ -56,13 +134,18 @@ static Token scan_token() {
 
     char c = peek_char();
 
-    if (c == '\0') return (Token){TOKEN_EOF, NULL, line};
+    if ((size_t)pos >= src_len || c == '\0') return (Token){TOKEN_EOF, NULL, line};
 
     // Single-char & Double-char tokens
     const char *start = &src[pos];
 
     if (c == '(') { advance_char(); return make_token(TOKEN_LPAREN, "(", 1); }
     if (c == ')') { advance_char(); return make_token(TOKEN_RPAREN, ")", 1); }
+    if (c == '[') { advance_char(); return make_token(TOKEN_LBRACKET, "[", 1); }
+    if (c == ']') { advance_char(); return make_token(TOKEN_RBRACKET, "]", 1); }
+    if (c == '{') { advance_char(); return make_token(TOKEN_LBRACE, "{", 1); }
+    if (c == '}') { advance_char(); return make_token(TOKEN_RBRACE, "}", 1); }
+    if (c == ':') { advance_char(); return make_token(TOKEN_COLON, ":", 1); }
     if (c == ',') { advance_char(); return make_token(TOKEN_COMMA, ",", 1); }
     if (c == '+') { advance_char(); return make_token(TOKEN_PLUS, "+", 1); }
     if (c == '-') { advance_char(); return make_token(TOKEN_MINUS, "-", 1); }
@@ -108,49 +191,34 @@ static Token scan_token() {
     // String literals
     if (c == '"') {
         advance_char();
-        const char *s_start = &src[pos];
-        int length = 0;
-        while (peek_char() != '"' && peek_char() != '\0') {
-            advance_char();
-            length++;
-        }
+        int s_start = pos;
+        int s_line = line;
+        pos = scan_string_body(src, pos, src_len, &line);
+        int length = pos - s_start;
         if (peek_char() == '"') advance_char();
-        return make_token(TOKEN_STRING, s_start, length);
+
+        Token token = make_token(TOKEN_STRING, &src[s_start], length);
+        token.line = s_line; // Multi-line literals report where they start
+        return token;
     }
 
     // Numbers
     if (isdigit(c)) {
-        const char *n_start = &src[pos];
-        int length = 0;
-        while (isdigit(peek_char())) {
-            advance_char();
-            length++;
+        int n_start = pos;
+        pos = scan_digits(src, pos, src_len);
+        if (src[pos] == '.' && isdigit((unsigned char)src[pos + 1])) {
+            pos = scan_digits(src, pos + 1, src_len);
+            return make_token(TOKEN_DECIMAL, &src[n_start], pos - n_start);
         }
-        return make_token(TOKEN_NUMBER, n_start, length);
+        return make_token(TOKEN_NUMBER, &src[n_start], pos - n_start);
     }
 
     // Identifiers & Keywords
     if (isalpha(c) || c == '_') {
-        const char *i_start = &src[pos];
-        int length = 0;
-        while (isalnum(peek_char()) || peek_char() == '_') {
-            advance_char();
-            length++;
-        }
-
-        if (length == 5 && strncmp(i_start, "tulis", 5) == 0) return make_token(TOKEN_TULIS, i_start, length);
-        if (length == 4 && strncmp(i_start, "biar", 4) == 0) return make_token(TOKEN_BIAR, i_start, length);
-        if (length == 4 && strncmp(i_start, "jika", 4) == 0) return make_token(TOKEN_JIKA, i_start, length);
-        if (length == 4 && strncmp(i_start, "maka", 4) == 0) return make_token(TOKEN_MAKA, i_start, length);
-        if (length == 5 && strncmp(i_start, "akhir", 5) == 0) return make_token(TOKEN_AKHIR, i_start, length);
-
-        // New Keywords
-        if (length == 6 && strncmp(i_start, "fungsi", 6) == 0) return make_token(TOKEN_FUNGSI, i_start, length);
-        if (length == 7 && strncmp(i_start, "kembali", 7) == 0) return make_token(TOKEN_KEMBALI, i_start, length);
-        if (length == 3 && strncmp(i_start, "dan", 3) == 0) return make_token(TOKEN_DAN, i_start, length);
-        if (length == 4 && strncmp(i_start, "atau", 4) == 0) return make_token(TOKEN_ATAU, i_start, length);
-
-        return make_token(TOKEN_IDENTIFIER, i_start, length);
+        int i_start = pos;
+        pos = scan_identifier(src, pos, src_len);
+        int length = pos - i_start;
+        return make_token(keyword_type(&src[i_start], length), &src[i_start], length);
     }
 
     advance_char();
@@ -165,6 +233,32 @@ Token next_token() {
     return scan_token();
 }
 
+TokenType skip_token() {
+    if (!token_consumed) {
+        token_consumed = 1;
+        free(current_token.value);
+        return current_token.type;
+    }
+    discard_text = 1;
+    TokenType type = scan_token().type;
+    discard_text = 0;
+    return type;
+}
+
+TokenType skip_token_text(const char **text, int *length) {
+    skipped_text = NULL;
+    skipped_length = 0;
+    TokenType type = skip_token();
+    *text = skipped_text;
+    *length = skipped_length;
+    return type;
+}
+
+const char* lexer_mark(int *at_line) {
+    *at_line = line;
+    return &src[pos];
+}
+
 Token peek_token() {
     if (token_consumed) {
         current_token = scan_token();
@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include "list.h"
+
+ObjList* list_new(int capacity) {
+    return gc_new_list(capacity, 1);
+}
+
+static void list_reserve(ObjList *list, int needed) {
+    if (needed <= list->capacity) return;
+
+    int capacity = list->capacity < 8 ? 8 : list->capacity;
+    while (capacity < needed) capacity *= 2;
+
+    size_t elem = list->numeric ? sizeof(int64_t) : sizeof(Value);
+    list->as.numbers = realloc(list->as.numbers, elem * capacity);
+    if (!list->as.numbers) {
+        fprintf(stderr, "Runtime Error: Kehabisan memori.\n");
+        exit(1);
+    }
+    gc_account((long)(elem * (capacity - list->capacity)));
+    list->capacity = capacity;
+}
+
+Value* list_boxed_items(ObjList *list) {
+    if (!list->numeric) return list->as.items;
+
+    int capacity = list->capacity;
+    Value *items = malloc(sizeof(Value) * (capacity ? capacity : 1));
+    for (int i = 0; i < list->count; i++) {
+        items[i] = make_number(list->as.numbers[i]);
+    }
+    free(list->as.numbers);
+    gc_account((long)((sizeof(Value) - sizeof(int64_t)) * capacity));
+
+    list->as.items = items;
+    list->numeric = 0;
+    return items;
+}
+
+void list_append(ObjList *list, Value value) {
+    list_reserve(list, list->count + 1);
+
+    if (list->numeric) {
+        if (value.type == VAL_NUMBER) {
+            list->as.numbers[list->count++] = value.as.number;
+            return;
+        }
+        list_boxed_items(list);
+    }
+    list->as.items[list->count++] = value;
+}
+
+int list_get(ObjList *list, int64_t index, Value *out) {
+    if (index < 0 || index >= list->count) return 0;
+    *out = list->numeric ? make_number(list->as.numbers[index]) : list->as.items[index];
+    return 1;
+}
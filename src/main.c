@@ -1,10 +1,45 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "parser.h"
 #include "evaluator.h"
+#include "gc.h"
+#include "jit.h"
+#include "emit_c.h"
+#include "infer.h"
+#include "snapshot.h"
+#include "parallel.h"
+#include "resolve.h"
+#include "optimize.h"
+#include "repl.h"
+
+// Sources at least this large are parsed in chunks on several threads
+#define PARALLEL_PARSE_MIN_SOURCE (1 << 20)
 
 void print_usage(const char *prog_name) {
-    printf("Penggunaan: %s <file_source.fox>\n", prog_name);
+    printf("Penggunaan: %s [opsi] <file_source.fox>\n", prog_name);
+    printf("            %s --repl [opsi] [file_source.fox]\n", prog_name);
+    printf("Opsi:\n");
+    printf("  --gc-stats          Tampilkan statistik GC (jeda, heap) setelah eksekusi\n");
+    printf("  --gc-growth=<f>     Faktor pertumbuhan heap GC (bawaan 2.0)\n");
+    printf("  --engine=<nama>     Mesin eksekusi: tree (bawaan) atau closure\n");
+    printf("  --no-jit            Matikan JIT x86-64 untuk fungsi bilangan bulat yang panas\n");
+    printf("  --jit-dump          Tampilkan kode mesin yang dihasilkan JIT\n");
+    printf("  --emit-c[=<file>]   Terjemahkan program ke C (bawaan ke stdout), tanpa eksekusi\n");
+    printf("  --parse-only        Hanya lex dan parse (untuk benchmark), tanpa eksekusi\n");
+    printf("  --lazy              Parse badan fungsi saat pertama dipanggil; galat sintaks di dalamnya baru dilaporkan saat itu\n");
+    printf("  --strict            Parse semua badan fungsi di awal agar setiap galat sintaks langsung dilaporkan\n");
+    printf("  --parse-threads=<n> Jumlah thread parser (bawaan: seperti --threads untuk sumber >= 1 MB, selain itu 1)\n");
+    printf("  --no-infer          Matikan inferensi tipe (jalur cepat bilangan bulat)\n");
+    printf("  --no-quicken        Matikan spesialisasi node AST saat runtime (tree walker)\n");
+    printf("  --dump-types        Tampilkan ekspresi yang dispesialisasi ke bilangan bulat\n");
+    printf("  --no-opt            Matikan optimasi (inline fungsi kecil, hapus kode mati)\n");
+    printf("  --opt-report        Tampilkan panggilan yang di-inline dan kode yang dihapus\n");
+    printf("  --snapshot=<file>   Jalankan program sebagai prelude lalu simpan global ke image\n");
+    printf("  --image=<file>      Mulai dengan global yang dimuat dari image\n");
+    printf("  --threads=<n>       Jumlah thread untuk peta_paralel/reduksi_paralel (bawaan: jumlah CPU)\n");
+    printf("  --watch             Jalankan ulang setiap kali file berubah; hanya bagian yang berubah diparse ulang\n");
+    printf("  --repl              Mode interaktif (setelah menjalankan file, jika ada)\n");
 }
 
 char* read_file(const char* path) {
@@ -32,31 +67,193 @@ char* read_file(const char* path) {
     return buffer;
 }
 
+// --watch and --repl: one global environment for every run (repl.h)
+static int run_interactive(const char *filepath, int watch, EngineKind engine,
+                           const char *image_path, int show_gc_stats) {
+    init_evaluator();
+    set_engine(engine);
+    int status = 0;
+    char *source = NULL;
+    ASTNode *program = NULL;
+    if (image_path && snapshot_load(evaluator_global_env(), image_path) != 0) {
+        status = 1;
+    } else if (watch) {
+        status = watch_run(filepath);
+    } else {
+        if (filepath) {
+            source = read_file(filepath);
+            if (!source) status = 1;
+        }
+        if (source) {
+            init_parser(source);
+            program = parse();
+            resolve_program(program);
+            evaluate(program);
+        }
+        if (status == 0) repl_run();
+    }
+
+    if (show_gc_stats) {
+        gc_print_stats(stderr);
+    }
+    if (program) free_ast(program);
+    snapshot_close();
+    cleanup_evaluator();
+    free(source);
+    return status;
+}
+
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
+    const char *filepath = NULL;
+    int show_gc_stats = 0;
+    EngineKind engine = ENGINE_TREE;
+    int emit_c_mode = 0;
+    int parse_only = 0;
+    int lazy = 0;
+    int strict = 0;
+    int parse_threads = 0;
+    int infer = 1;
+    int dump_types = 0;
+    int optimize = 1;
+    int opt_report = 0;
+    const char *snapshot_path = NULL;
+    const char *image_path = NULL;
+    const char *emit_c_path = NULL;
+    int watch = 0;
+    int repl = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--gc-stats") == 0) {
+            show_gc_stats = 1;
+        } else if (strncmp(arg, "--gc-growth=", 12) == 0) {
+            gc_set_growth_factor(atof(arg + 12));
+        } else if (strcmp(arg, "--engine=tree") == 0) {
+            engine = ENGINE_TREE;
+        } else if (strcmp(arg, "--engine=closure") == 0) {
+            engine = ENGINE_CLOSURE;
+        } else if (strcmp(arg, "--no-jit") == 0) {
+            jit_set_enabled(0);
+        } else if (strcmp(arg, "--jit-dump") == 0) {
+            jit_set_dump(1);
+        } else if (strcmp(arg, "--emit-c") == 0) {
+            emit_c_mode = 1;
+        } else if (strncmp(arg, "--emit-c=", 9) == 0) {
+            emit_c_mode = 1;
+            emit_c_path = arg + 9;
+        } else if (strcmp(arg, "--parse-only") == 0) {
+            parse_only = 1;
+        } else if (strcmp(arg, "--lazy") == 0) {
+            lazy = 1;
+        } else if (strcmp(arg, "--strict") == 0) {
+            strict = 1;
+        } else if (strncmp(arg, "--parse-threads=", 16) == 0) {
+            parse_threads = atoi(arg + 16);
+        } else if (strcmp(arg, "--no-infer") == 0) {
+            infer = 0;
+        } else if (strcmp(arg, "--no-quicken") == 0) {
+            evaluator_set_quickening(0);
+        } else if (strcmp(arg, "--dump-types") == 0) {
+            dump_types = 1;
+        } else if (strcmp(arg, "--no-opt") == 0) {
+            optimize = 0;
+        } else if (strcmp(arg, "--opt-report") == 0) {
+            opt_report = 1;
+        } else if (strncmp(arg, "--snapshot=", 11) == 0) {
+            snapshot_path = arg + 11;
+        } else if (strncmp(arg, "--image=", 8) == 0) {
+            image_path = arg + 8;
+        } else if (strncmp(arg, "--threads=", 10) == 0) {
+            parallel_set_threads(atoi(arg + 10));
+        } else if (strcmp(arg, "--watch") == 0) {
+            watch = 1;
+        } else if (strcmp(arg, "--repl") == 0) {
+            repl = 1;
+        } else if (arg[0] == '-' && arg[1] == '-') {
+            fprintf(stderr, "Opsi tidak dikenal: %s\n", arg);
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            filepath = arg;
+        }
+    }
+
+    if (repl || (watch && filepath)) {
+        return run_interactive(filepath, watch && !repl, engine, image_path, show_gc_stats);
+    }
+    if (!filepath) {
         print_usage(argv[0]);
         return 1;
     }
 
-    const char *filepath = argv[1];
     char *source = read_file(filepath);
 
     if (!source) {
         return 1;
     }
 
-    // 1. Init & Parse
-    init_parser(source);
-    ASTNode *program = parse();
+    // 1. Init & Parse. Translation to C needs every body up front.
+    size_t source_length = strlen(source);
+    parser_set_lazy(lazy && !strict && !emit_c_mode);
+    if (parse_threads <= 0) {
+        parse_threads = source_length >= PARALLEL_PARSE_MIN_SOURCE ? parallel_thread_count() : 1;
+    }
+    ASTNode *program;
+    if (parse_threads > 1) {
+        program = parse_parallel(source, parse_threads);
+    } else {
+        init_parser(source);
+        program = parse();
+    }
+
+    if (parse_only) {
+        free_ast(program);
+        free(source);
+        return 0;
+    }
 
-    // 2. Evaluate
+    resolve_program(program); // Closure captures, before anything runs the tree
+    if (optimize) {
+        // An image keeps every global, so nothing may be dropped from one
+        optimize_program(program, snapshot_path == NULL, opt_report ? stderr : NULL);
+    }
+
+    if (emit_c_mode) {
+        FILE *out = emit_c_path ? fopen(emit_c_path, "w") : stdout;
+        if (!out) {
+            fprintf(stderr, "Gagal membuka file: %s\n", emit_c_path);
+            return 1;
+        }
+        int status = emit_c(program, out);
+        if (emit_c_path) fclose(out);
+        free_ast(program);
+        free(source);
+        return status;
+    }
+
+    // 2. Evaluate, starting from the image's globals if there is one
     init_evaluator();
-    evaluate(program);
+    set_engine(engine);
+    int status = 0;
+    if (image_path && snapshot_load(evaluator_global_env(), image_path) != 0) {
+        status = 1;
+    } else {
+        if (infer || dump_types) {
+            infer_types(program, evaluator_global_env(), dump_types ? stderr : NULL);
+        }
+        evaluate(program);
+        if (snapshot_path) status = snapshot_save(evaluator_global_env(), snapshot_path);
+    }
 
-    // 3. Cleanup
-    cleanup_evaluator();
+    if (show_gc_stats) {
+        gc_print_stats(stderr);
+    }
+
+    // 3. Cleanup (ASTs first: they unpin literals, then the heap is torn down)
     free_ast(program);
+    snapshot_close();
+    cleanup_evaluator();
     free(source);
 
-    return 0;
+    return status;
 }
@@ -0,0 +1,163 @@
+#include <stdlib.h>
+#include <string.h>
+#include "map.h"
+
+#define MAP_MIN_ENTRIES 8
+
+// --- Hashing ---
+
+static unsigned bytes_hash(const char *chars, size_t length) {
+    unsigned h = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)chars[i];
+        h *= 16777619u;
+    }
+    return h ? h : 1; // 0 means "not computed"
+}
+
+// Heap strings cache their hash; inline ones are short enough to rehash.
+// Parallel workers may fill the same cache at once, always with the same
+// value, hence the relaxed atomics.
+static unsigned string_hash(Value *key) {
+    if (key->inline_len) return bytes_hash(string_chars(key), string_length(key));
+    ObjString *s = key->as.string;
+    unsigned h = __atomic_load_n(&s->hash, __ATOMIC_RELAXED);
+    if (!h) {
+        h = bytes_hash(s->chars, s->length);
+        __atomic_store_n(&s->hash, h, __ATOMIC_RELAXED);
+    }
+    return h;
+}
+
+static unsigned int_hash(int64_t n) {
+    // Fibonacci hashing spreads sequential ids over the whole table
+    uint64_t h = (uint64_t)n * 0x9E3779B97F4A7C15ull;
+    return (unsigned)(h >> 32);
+}
+
+static unsigned key_hash(Value key) {
+    return key.type == VAL_STRING ? string_hash(&key) : int_hash(key.as.number);
+}
+
+static int keys_equal(Value a, unsigned a_hash, MapEntry *e) {
+    if (e->hash != a_hash || e->key.type != a.type) return 0;
+    if (a.type == VAL_NUMBER) return a.as.number == e->key.as.number;
+
+    if (!a.inline_len && !e->key.inline_len && a.as.string == e->key.as.string) return 1;
+    size_t length = string_length(&a);
+    return length == string_length(&e->key) &&
+           memcmp(string_chars(&a), string_chars(&e->key), length) == 0;
+}
+
+int map_valid_key(Value key) {
+    return key.type == VAL_NUMBER || key.type == VAL_STRING;
+}
+
+// --- Table maintenance ---
+
+static void rebuild_index(ObjMap *map) {
+    int mask = map->index_capacity - 1;
+    for (int i = 0; i < map->index_capacity; i++) map->index[i] = -1;
+    for (int i = 0; i < map->entry_count; i++) {
+        unsigned slot = map->entries[i].hash & mask;
+        while (map->index[slot] != -1) slot = (slot + 1) & mask;
+        map->index[slot] = i;
+    }
+}
+
+// Resizes the entry array and index; the caller rebuilds the index
+static void map_resize(ObjMap *map, int capacity) {
+    long old_bytes = (long)(sizeof(MapEntry) * map->entry_capacity + sizeof(int) * map->index_capacity);
+
+    map->entries = realloc(map->entries, sizeof(MapEntry) * capacity);
+    map->entry_capacity = capacity;
+    free(map->index);
+    map->index_capacity = capacity * 2;
+    map->index = malloc(sizeof(int) * map->index_capacity);
+    if (!map->entries || !map->index) {
+        fprintf(stderr, "Runtime Error: Kehabisan memori.\n");
+        exit(1);
+    }
+    gc_account((long)(sizeof(MapEntry) * capacity + sizeof(int) * map->index_capacity) - old_bytes);
+}
+
+// Makes room for one more entry: drops deleted entries, growing only when
+// the table is genuinely full of live keys.
+static void map_grow(ObjMap *map) {
+    int live = 0;
+    for (int i = 0; i < map->entry_count; i++) {
+        if (map->entries[i].key.type != VAL_NULL) map->entries[live++] = map->entries[i];
+    }
+    map->entry_count = live;
+
+    if (live * 2 > map->entry_capacity || map->entry_capacity == 0) {
+        map_resize(map, map->entry_capacity ? map->entry_capacity * 2 : MAP_MIN_ENTRIES);
+    }
+    rebuild_index(map);
+}
+
+ObjMap* map_new(int capacity) {
+    ObjMap *map = gc_new_map();
+    if (capacity > 0) {
+        // An empty map never grows through map_grow, so size it directly
+        int entries = MAP_MIN_ENTRIES;
+        while (entries < capacity) entries *= 2;
+        map_resize(map, entries);
+        rebuild_index(map);
+    }
+    return map;
+}
+
+// Index slot holding 'key', or the empty slot where it would go
+static int find_slot(ObjMap *map, Value key, unsigned hash) {
+    int mask = map->index_capacity - 1;
+    int slot = hash & mask;
+    for (;;) {
+        int pos = map->index[slot];
+        if (pos == -1 || keys_equal(key, hash, &map->entries[pos])) return slot;
+        slot = (slot + 1) & mask;
+    }
+}
+
+// --- Public API ---
+
+int map_get(ObjMap *map, Value key, Value *out) {
+    if (map->count == 0 || !map_valid_key(key)) return 0;
+    int pos = map->index[find_slot(map, key, key_hash(key))];
+    if (pos == -1) return 0;
+    *out = map->entries[pos].value;
+    return 1;
+}
+
+void map_set(ObjMap *map, Value key, Value value) {
+    unsigned hash = key_hash(key);
+    if (map->index_capacity > 0) {
+        int pos = map->index[find_slot(map, key, hash)];
+        if (pos != -1) {
+            map->entries[pos].value = value;
+            return;
+        }
+    }
+
+    if (map->entry_count == map->entry_capacity) map_grow(map);
+
+    int pos = map->entry_count++;
+    map->entries[pos].key = key;
+    map->entries[pos].value = value;
+    map->entries[pos].hash = hash;
+    map->index[find_slot(map, key, hash)] = pos;
+    map->count++;
+}
+
+int map_delete(ObjMap *map, Value key) {
+    if (map->count == 0 || !map_valid_key(key)) return 0;
+    int pos = map->index[find_slot(map, key, key_hash(key))];
+    if (pos == -1) return 0;
+
+    // The index slot keeps pointing here so probe chains stay intact;
+    // a null key never compares equal.
+    map->entries[pos].key = make_null();
+    map->entries[pos].value = make_null();
+    map->count--;
+    return 1;
+}
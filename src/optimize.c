@@ -0,0 +1,573 @@
+#include <stdlib.h>
+#include <string.h>
+#include "optimize.h"
+#include "parser.h"
+
+#define INLINE_BUDGET 16    // Nodes in an inlined 'kembali' expression
+#define INLINE_MAX_PARAMS 8
+
+// --- Scopes ---
+
+// One per function body being optimized; top-level code has none
+typedef struct Scope {
+    FuncDeclNode *decl;
+    struct Scope *parent;
+    NameSet locals;
+    NameSet bound; // Locals certainly bound at the statement being optimized
+} Scope;
+
+static int bound_locally(const Scope *s, const char *name) {
+    for (; s; s = s->parent) {
+        if (name_set_has(&s->locals, name)) return 1;
+    }
+    return 0;
+}
+
+// --- Expressions ---
+
+// What the optimizer knows of a top-level name
+typedef struct {
+    FuncDeclNode *decl;   // The top-level function of this name, once it
+    ASTNode *inline_expr; // qualifies for inlining, and its 'kembali' expression
+    int bound;            // Certainly bound: by a top-level statement already passed
+} GlobalInfo;
+
+typedef struct {
+    NameTable globals;  // Bindings at top level, counted
+    GlobalInfo *info;   // Parallel to 'globals'
+    FILE *report;
+    int inlined;
+    int dead_statements;
+    int dropped_functions;
+    ASTNode *removed; // Freed at the end: the tables above point into them
+} Optimizer;
+
+static GlobalInfo* global_info(const Optimizer *o, const char *name) {
+    NameCount *e = name_table_find(&o->globals, name);
+    return e ? &o->info[e - o->globals.items] : NULL;
+}
+
+// Reading 'name' here cannot fail. A local counts once a statement directly
+// in its function body has bound it (parameters from the start); a global
+// once a statement directly at top level has, which for a function body
+// means before the function's own declaration ran.
+static int known_bound(const Optimizer *o, const Scope *s, const char *name) {
+    for (; s; s = s->parent) {
+        if (name_set_has(&s->locals, name)) return name_set_has(&s->bound, name);
+    }
+    GlobalInfo *global = global_info(o, name);
+    return global && global->bound;
+}
+
+// Evaluating 'node' never fails, so a 'biar' of it always binds its name
+static int cannot_fail(const Optimizer *o, const Scope *s, ASTNode *node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_LITERAL: return 1;
+        case NODE_VAR_ACCESS: return known_bound(o, s, ((VarAccessNode*)node)->name);
+        case NODE_BINARY_EXPR: // Operators yield null rather than fail
+            return cannot_fail(o, s, ((BinaryExprNode*)node)->left) &&
+                   cannot_fail(o, s, ((BinaryExprNode*)node)->right);
+        default:
+            return 0;
+    }
+}
+
+// Records the name a statement directly in a body (or at top level) is
+// sure to bind
+static void note_bound(Optimizer *o, Scope *s, ASTNode *stmt) {
+    const char *name;
+    if (stmt->type == NODE_FUNC_DECL) {
+        name = ((FuncDeclNode*)stmt)->name;
+    } else if (stmt->type == NODE_VAR_DECL && cannot_fail(o, s, ((VarDeclNode*)stmt)->value)) {
+        name = ((VarDeclNode*)stmt)->name;
+    } else {
+        return;
+    }
+    if (s) name_set_add(&s->bound, name);
+    else global_info(o, name)->bound = 1; // Collected in optimize_program
+}
+
+static void discard(Optimizer *o, ASTNode *list) {
+    ASTNode *tail = list;
+    while (tail->next) tail = tail->next;
+    tail->next = o->removed;
+    o->removed = list;
+}
+
+static int param_index(FuncDeclNode *f, const char *name) {
+    int i = 0;
+    for (ASTNode *p = f->params; p; p = p->next, i++) {
+        if (strcmp(((VarAccessNode*)p)->name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// Node count of an expression made only of literals, names, operators and
+// calls; anything else (or a NULL from a parse error) is over any budget
+static int inline_cost(ASTNode *node) {
+    if (!node) return INLINE_BUDGET + 1;
+    switch (node->type) {
+        case NODE_LITERAL:
+        case NODE_VAR_ACCESS:
+            return 1;
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *b = (BinaryExprNode*)node;
+            return 1 + inline_cost(b->left) + inline_cost(b->right);
+        }
+        case NODE_CALL_EXPR: {
+            int cost = 1;
+            for (ASTNode *a = ((CallExprNode*)node)->arguments; a; a = a->next) cost += inline_cost(a);
+            return cost;
+        }
+        default:
+            return INLINE_BUDGET + 1;
+    }
+}
+
+static int mentions(ASTNode *node, const char *name) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_VAR_ACCESS: return strcmp(((VarAccessNode*)node)->name, name) == 0;
+        case NODE_BINARY_EXPR:
+            return mentions(((BinaryExprNode*)node)->left, name) ||
+                   mentions(((BinaryExprNode*)node)->right, name);
+        case NODE_CALL_EXPR: {
+            CallExprNode *c = (CallExprNode*)node;
+            if (strcmp(c->callee, name) == 0) return 1;
+            for (ASTNode *a = c->arguments; a; a = a->next) {
+                if (mentions(a, name)) return 1;
+            }
+            return 0;
+        }
+        default:
+            return 0;
+    }
+}
+
+// Calls through a parameter would call whatever the caller passed
+static int calls_param(ASTNode *node, FuncDeclNode *f) {
+    switch (node->type) {
+        case NODE_BINARY_EXPR:
+            return calls_param(((BinaryExprNode*)node)->left, f) ||
+                   calls_param(((BinaryExprNode*)node)->right, f);
+        case NODE_CALL_EXPR: {
+            CallExprNode *c = (CallExprNode*)node;
+            if (param_index(f, c->callee) >= 0) return 1;
+            for (ASTNode *a = c->arguments; a; a = a->next) {
+                if (calls_param(a, f)) return 1;
+            }
+            return 0;
+        }
+        default:
+            return 0;
+    }
+}
+
+// The function's expression qualifies for inlining: a lone 'kembali' within
+// budget that never names the function itself nor calls a parameter
+static ASTNode* inline_candidate(const Optimizer *o, FuncDeclNode *f) {
+    if (name_table_count(&o->globals, f->name) != 1 || f->capture_count > 0) return NULL;
+
+    int count = 0;
+    for (ASTNode *p = f->params; p; p = p->next, count++) {
+        if (param_index(f, ((VarAccessNode*)p)->name) != count) return NULL; // Repeated name
+    }
+    if (count > INLINE_MAX_PARAMS) return NULL;
+
+    if (!f->body) return NULL; // Not parsed yet (parser.h)
+    ASTNode *body = ((BlockNode*)f->body)->statements;
+    if (!body || body->next || body->type != NODE_RETURN) return NULL;
+    ASTNode *expr = ((ReturnNode*)body)->value;
+    if (inline_cost(expr) > INLINE_BUDGET || mentions(expr, f->name) || calls_param(expr, f)) return NULL;
+    return expr;
+}
+
+// Every name the expression reads, other than parameters, must mean at the
+// call site what it means in the function: a global
+static int free_names_global(ASTNode *node, FuncDeclNode *f, const Scope *s) {
+    switch (node->type) {
+        case NODE_VAR_ACCESS: {
+            const char *name = ((VarAccessNode*)node)->name;
+            return param_index(f, name) >= 0 || !bound_locally(s, name);
+        }
+        case NODE_BINARY_EXPR:
+            return free_names_global(((BinaryExprNode*)node)->left, f, s) &&
+                   free_names_global(((BinaryExprNode*)node)->right, f, s);
+        case NODE_CALL_EXPR: {
+            CallExprNode *c = (CallExprNode*)node;
+            if (bound_locally(s, c->callee)) return 0;
+            for (ASTNode *a = c->arguments; a; a = a->next) {
+                if (!free_names_global(a, f, s)) return 0;
+            }
+            return 1;
+        }
+        default:
+            return 1;
+    }
+}
+
+typedef struct {
+    FuncDeclNode *f;
+    int trivial[INLINE_MAX_PARAMS]; // Argument is a literal or a bound name: free to repeat or skip
+    int uses[INLINE_MAX_PARAMS];
+    int has_call;
+    int has_operator;  // Seen in evaluation order so far
+    int last_effect;   // Highest non-trivial argument reached so far
+    int ordered;
+} ArgCheck;
+
+// Walks the expression in evaluation order. A call evaluates every argument
+// before its body, so a non-trivial argument may only be substituted where
+// it is still evaluated first: ahead of any operator of the body (which may
+// report an error) and after the non-trivial arguments before it.
+static void check_uses(ArgCheck *ck, ASTNode *node) {
+    switch (node->type) {
+        case NODE_VAR_ACCESS: {
+            int i = param_index(ck->f, ((VarAccessNode*)node)->name);
+            if (i < 0) return;
+            ck->uses[i]++;
+            if (ck->trivial[i]) return;
+            if (ck->has_operator || i <= ck->last_effect) ck->ordered = 0;
+            ck->last_effect = i;
+            return;
+        }
+        case NODE_BINARY_EXPR:
+            check_uses(ck, ((BinaryExprNode*)node)->left);
+            check_uses(ck, ((BinaryExprNode*)node)->right);
+            ck->has_operator = 1;
+            return;
+        case NODE_CALL_EXPR:
+            for (ASTNode *a = ((CallExprNode*)node)->arguments; a; a = a->next) check_uses(ck, a);
+            ck->has_call = 1;
+            ck->has_operator = 1;
+            return;
+        default:
+            return;
+    }
+}
+
+// A name that may be unbound is not trivial: dropping or repeating it
+// would drop or repeat its error
+static int can_substitute(const Optimizer *o, const Scope *s, FuncDeclNode *f, ASTNode *expr,
+                          ASTNode *args) {
+    ArgCheck ck = {f, {0}, {0}, 0, 0, -1, 1};
+    int argc = 0;
+    ASTNode *p = f->params;
+    for (ASTNode *a = args; a; a = a->next, p = p->next, argc++) {
+        if (!p) return 0;
+        ck.trivial[argc] = a->type == NODE_LITERAL ||
+                           (a->type == NODE_VAR_ACCESS && known_bound(o, s, ((VarAccessNode*)a)->name));
+    }
+    if (p) return 0;
+
+    check_uses(&ck, expr);
+    for (int i = 0; i < argc; i++) {
+        if (ck.trivial[i]) continue;
+        // Evaluated exactly once, and not moved across the body's own calls
+        if (ck.uses[i] != 1 || ck.has_call) return 0;
+    }
+    return ck.ordered;
+}
+
+static ASTNode* clone_expr(ASTNode *node, FuncDeclNode *f, ASTNode **args);
+
+static ASTNode* clone_list(ASTNode *head, FuncDeclNode *f, ASTNode **args) {
+    NodeList out = {NULL, NULL};
+    for (ASTNode *n = head; n; n = n->next) node_list_push(&out, clone_expr(n, f, args));
+    return out.head;
+}
+
+// Copies an expression; with 'f', its parameters are replaced by copies of
+// the matching arguments
+static ASTNode* clone_expr(ASTNode *node, FuncDeclNode *f, ASTNode **args) {
+    if (!node) return NULL;
+    ASTNode *copy = NULL;
+    switch (node->type) {
+        case NODE_LITERAL: {
+            LiteralNode *l = (LiteralNode*)node;
+            if (l->type == TOKEN_STRING) copy = new_literal_string(l->string_val);
+            else if (l->type == TOKEN_DECIMAL) copy = new_literal_decimal(l->decimal_val);
+            else copy = new_literal_number(l->int_val);
+            break;
+        }
+        case NODE_VAR_ACCESS: {
+            const char *name = ((VarAccessNode*)node)->name;
+            int i = f ? param_index(f, name) : -1;
+            copy = i >= 0 ? clone_expr(args[i], NULL, NULL) : new_var_access(name);
+            break;
+        }
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *b = (BinaryExprNode*)node;
+            copy = new_binary_expr(clone_expr(b->left, f, args), b->op, clone_expr(b->right, f, args));
+            break;
+        }
+        case NODE_CALL_EXPR: {
+            CallExprNode *c = (CallExprNode*)node;
+            copy = new_call_expr(c->callee, clone_list(c->arguments, f, args));
+            break;
+        }
+        case NODE_LIST:
+            copy = new_list(clone_list(((ListNode*)node)->elements, f, args));
+            break;
+        case NODE_MAP:
+            copy = new_map(clone_list(((MapNode*)node)->keys, f, args),
+                           clone_list(((MapNode*)node)->values, f, args));
+            break;
+        case NODE_INDEX:
+            copy = new_index(clone_expr(((IndexNode*)node)->target, f, args),
+                             clone_expr(((IndexNode*)node)->index, f, args));
+            break;
+        case NODE_INTERP:
+            copy = new_interp(clone_list(((InterpNode*)node)->parts, f, args));
+            break;
+        default:
+            break; // Statements never appear inside expressions
+    }
+    return copy;
+}
+
+static void opt_expr(Optimizer *o, Scope *s, ASTNode **slot);
+
+static void opt_expr_list(Optimizer *o, Scope *s, ASTNode **head) {
+    for (ASTNode **p = head; *p; p = &(*p)->next) opt_expr(o, s, p);
+}
+
+// Replaces the call in '*slot' by the callee's expression when it qualifies
+static void try_inline(Optimizer *o, Scope *s, ASTNode **slot) {
+    CallExprNode *c = (CallExprNode*)*slot;
+    if (bound_locally(s, c->callee)) return;
+    GlobalInfo *entry = global_info(o, c->callee);
+    if (!entry || !entry->inline_expr) return;
+
+    FuncDeclNode *f = entry->decl;
+    ASTNode *expr = entry->inline_expr;
+    if (!free_names_global(expr, f, s) || !can_substitute(o, s, f, expr, c->arguments)) return;
+
+    ASTNode *args[INLINE_MAX_PARAMS];
+    int argc = 0;
+    for (ASTNode *a = c->arguments; a; a = a->next) args[argc++] = a;
+
+    ASTNode *inlined = clone_expr(expr, f, args);
+    inlined->next = c->base.next;
+    c->base.next = NULL;
+    *slot = inlined;
+
+    o->inlined++;
+    if (o->report) {
+        if (s) fprintf(o->report, "Inline: '%s' di dalam '%s'\n", f->name, s->decl->name);
+        else fprintf(o->report, "Inline: '%s' di tingkat atas\n", f->name);
+    }
+    free_ast((ASTNode*)c);
+}
+
+static void opt_expr(Optimizer *o, Scope *s, ASTNode **slot) {
+    ASTNode *node = *slot;
+    if (!node) return;
+    switch (node->type) {
+        case NODE_BINARY_EXPR:
+            opt_expr(o, s, &((BinaryExprNode*)node)->left);
+            opt_expr(o, s, &((BinaryExprNode*)node)->right);
+            break;
+        case NODE_CALL_EXPR:
+            opt_expr_list(o, s, &((CallExprNode*)node)->arguments);
+            try_inline(o, s, slot);
+            break;
+        case NODE_LIST: opt_expr_list(o, s, &((ListNode*)node)->elements); break;
+        case NODE_MAP:
+            opt_expr_list(o, s, &((MapNode*)node)->keys);
+            opt_expr_list(o, s, &((MapNode*)node)->values);
+            break;
+        case NODE_INDEX:
+            opt_expr(o, s, &((IndexNode*)node)->target);
+            opt_expr(o, s, &((IndexNode*)node)->index);
+            break;
+        case NODE_INTERP: opt_expr_list(o, s, &((InterpNode*)node)->parts); break;
+        default:
+            break;
+    }
+}
+
+// --- Statements ---
+
+// Number operators on number literals: nothing to observe, not even an error
+static int pure_arithmetic(ASTNode *node) {
+    if (!node) return 0;
+    if (node->type == NODE_LITERAL) {
+        TokenType t = ((LiteralNode*)node)->type;
+        return t == TOKEN_NUMBER || t == TOKEN_DECIMAL;
+    }
+    if (node->type != NODE_BINARY_EXPR) return 0;
+    BinaryExprNode *b = (BinaryExprNode*)node;
+    return b->op != TOKEN_SLASH && pure_arithmetic(b->left) && pure_arithmetic(b->right);
+}
+
+// Expression statements other than operators and calls are never evaluated
+static int no_effect(ASTNode *stmt) {
+    switch (stmt->type) {
+        case NODE_LITERAL:
+        case NODE_VAR_ACCESS:
+        case NODE_LIST:
+        case NODE_MAP:
+        case NODE_INDEX:
+        case NODE_INTERP:
+            return 1;
+        case NODE_BINARY_EXPR:
+            return pure_arithmetic(stmt);
+        default:
+            return 0;
+    }
+}
+
+static void opt_statements(Optimizer *o, Scope *s, ASTNode **head, int top_level);
+
+static void opt_block(Optimizer *o, Scope *s, ASTNode *block) {
+    if (block) opt_statements(o, s, &((BlockNode*)block)->statements, 0);
+}
+
+static void opt_function(Optimizer *o, Scope *parent, FuncDeclNode *f) {
+    if (!f->body) return;
+    Scope scope = {f, parent, {NULL, 0, 0}, {NULL, 0, 0}};
+    for (ASTNode *p = f->params; p; p = p->next) {
+        name_set_add(&scope.locals, ((VarAccessNode*)p)->name);
+        name_set_add(&scope.bound, ((VarAccessNode*)p)->name);
+    }
+    name_set_collect(&scope.locals, ((BlockNode*)f->body)->statements);
+    opt_statements(o, &scope, &((BlockNode*)f->body)->statements, 1);
+    free(scope.locals.items);
+    free(scope.bound.items);
+}
+
+static void opt_statement(Optimizer *o, Scope *s, ASTNode **slot) {
+    ASTNode *node = *slot;
+    switch (node->type) {
+        case NODE_BLOCK: opt_block(o, s, node); break;
+        case NODE_VAR_DECL: opt_expr(o, s, &((VarDeclNode*)node)->value); break;
+        case NODE_PRINT: opt_expr(o, s, &((PrintNode*)node)->expression); break;
+        case NODE_IF:
+            opt_expr(o, s, &((IfNode*)node)->condition);
+            opt_block(o, s, ((IfNode*)node)->then_branch);
+            break;
+        case NODE_REPEAT: {
+            RepeatNode *r = (RepeatNode*)node;
+            opt_expr(o, s, &r->start);
+            opt_expr(o, s, &r->end);
+            opt_block(o, s, r->body);
+            break;
+        }
+        case NODE_WHILE:
+            opt_expr(o, s, &((WhileNode*)node)->condition);
+            opt_block(o, s, ((WhileNode*)node)->body);
+            break;
+        case NODE_RETURN: opt_expr(o, s, &((ReturnNode*)node)->value); break;
+        case NODE_FUNC_DECL: opt_function(o, s, (FuncDeclNode*)node); break;
+        default:
+            opt_expr(o, s, slot); // Expression statement
+            break;
+    }
+}
+
+// Functions declared directly at top level become inlinable once their own
+// body is done, so only calls after the declaration see them. 'direct' is
+// set for the statements of the program or of a function body themselves,
+// as opposed to those of a nested block, which may not run.
+static void opt_statements(Optimizer *o, Scope *s, ASTNode **head, int direct) {
+    ASTNode **p = head;
+    while (*p) {
+        opt_statement(o, s, p);
+        ASTNode *stmt = *p;
+
+        if (no_effect(stmt)) {
+            *p = stmt->next;
+            stmt->next = NULL;
+            discard(o, stmt);
+            o->dead_statements++;
+            continue;
+        }
+        if (stmt->type == NODE_RETURN && stmt->next) {
+            for (ASTNode *n = stmt->next; n; n = n->next) o->dead_statements++;
+            discard(o, stmt->next);
+            stmt->next = NULL;
+        }
+        if (direct) note_bound(o, s, stmt);
+        if (direct && !s && stmt->type == NODE_FUNC_DECL) {
+            FuncDeclNode *f = (FuncDeclNode*)stmt;
+            ASTNode *expr = inline_candidate(o, f);
+            if (expr) {
+                GlobalInfo *entry = global_info(o, f->name);
+                entry->decl = f;
+                entry->inline_expr = expr;
+            }
+        }
+        p = &stmt->next;
+    }
+}
+
+// --- Unused Functions ---
+
+static void release_uses(NameTable *uses, FuncDeclNode *f) {
+    NameTable inner = {NULL, 0, 0};
+    name_table_collect_function_uses(&inner, f, f->name);
+    for (int i = 0; i < inner.count; i++) name_table_find(uses, inner.items[i].name)->count--;
+    free(inner.items);
+}
+
+static void drop_unused_functions(Optimizer *o, ProgramNode *program) {
+    NameTable uses = {NULL, 0, 0};
+    for (ASTNode *n = program->statements; n; n = n->next) {
+        const char *self = n->type == NODE_FUNC_DECL ? ((FuncDeclNode*)n)->name : NULL;
+        ASTNode *next = n->next;
+        n->next = NULL; // One statement at a time
+        name_table_collect_uses(&uses, n, self);
+        n->next = next;
+    }
+    name_table_finish(&uses);
+
+    // Dropping a function may leave the ones only it called unused
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        ASTNode **p = &program->statements;
+        while (*p) {
+            ASTNode *stmt = *p;
+            if (stmt->type == NODE_FUNC_DECL) {
+                FuncDeclNode *f = (FuncDeclNode*)stmt;
+                if (name_table_count(&uses, f->name) == 0) {
+                    if (o->report) fprintf(o->report, "Dihapus: fungsi '%s' tidak pernah dipakai\n", f->name);
+                    release_uses(&uses, f);
+                    *p = stmt->next;
+                    stmt->next = NULL;
+                    discard(o, stmt);
+                    o->dropped_functions++;
+                    changed = 1;
+                    continue;
+                }
+            }
+            p = &stmt->next;
+        }
+    }
+    free(uses.items);
+    if (o->dropped_functions > 0) parser_track_lazy((ASTNode*)program); // Some may have been lazy
+}
+
+void optimize_program(ASTNode *program, int drop_unused, FILE *report) {
+    if (!program || program->type != NODE_PROGRAM) return;
+    ProgramNode *root = (ProgramNode*)program;
+
+    Optimizer o = {{NULL, 0, 0}, NULL, report, 0, 0, 0, NULL};
+    if (report) fprintf(report, "--- Optimasi ---\n");
+
+    name_table_collect(&o.globals, root->statements);
+    name_table_finish(&o.globals);
+    o.info = calloc(o.globals.count > 0 ? o.globals.count : 1, sizeof(GlobalInfo));
+    opt_statements(&o, NULL, &root->statements, 1);
+    if (drop_unused) drop_unused_functions(&o, root);
+
+    if (report) {
+        fprintf(report, "Panggilan di-inline: %d, pernyataan mati dihapus: %d, fungsi dihapus: %d\n",
+                o.inlined, o.dead_statements, o.dropped_functions);
+    }
+    free(o.globals.items);
+    free(o.info);
+    free_ast(o.removed);
+}
@@ -0,0 +1,390 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "parallel.h"
+#include "evaluator.h"
+#include "builtins.h"
+#include "gc.h"
+#include "list.h"
+#include "snapshot.h"
+#include "parser.h"
+
+#define CHUNKS_PER_WORKER 8 // Enough slack for stealing to even out uneven elements
+
+// Chunks [top, bottom) not yet taken. The owner works from the bottom,
+// thieves take from the top, so they only meet on the last chunk.
+typedef struct Deque {
+    pthread_mutex_t lock;
+    int top;
+    int bottom;
+} Deque;
+
+typedef enum {
+    JOB_MAP,    // results[i] = f(xs[i])
+    JOB_REDUCE  // results[c] = fold of chunk c, from its first element
+} JobKind;
+
+typedef struct Job {
+    JobKind kind;
+    Value function;
+    ObjList *input;
+    int count;
+    int chunk_size;
+    Value *results;
+} Job;
+
+static int requested_threads = 0;
+static int pool_size = 0;       // Workers including the main thread, 0 before the first call
+static pthread_t *threads = NULL;
+static Deque *deques = NULL;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+static Job *job = NULL;
+static unsigned generation = 0; // Bumped for every job
+static int busy = 0;            // Pool threads still on the current job
+static int shutting_down = 0;
+static int region_active = 0;
+
+// GC safepoint: a thread whose flush crosses the heap threshold asks for a
+// collection; workers then stop at their next call boundary and the main
+// thread collects once all of them are stopped or out of chunks
+static pthread_cond_t collected = PTHREAD_COND_INITIALIZER;
+static int collect_pending = 0;
+static int running = 0; // Threads still taking chunks, the main thread included
+static int parked = 0;  // Workers stopped at the safepoint for the next collection
+static unsigned collections = 0; // Bumped by each one, releasing the parked workers
+
+int parallel_active(void) {
+    return region_active;
+}
+
+void parallel_set_threads(int count) {
+    requested_threads = count < 0 ? 0 : count;
+}
+
+// --- Chunk Work ---
+
+static Value call_or_null(Value function, Value *args, int argc) {
+    Value out;
+    if (!evaluator_call_value(function, args, argc, &out)) out = make_null();
+    return out;
+}
+
+static void poll_safepoint(int self);
+
+static void map_range(const Job *j, int start, int end, int self) {
+    for (int i = start; i < end; i++) {
+        Value x;
+        list_get(j->input, i, &x);
+        j->results[i] = call_or_null(j->function, &x, 1);
+        poll_safepoint(self);
+    }
+}
+
+static Value reduce_range(Value function, ObjList *input, int start, int end, int self) {
+    Value pair[2];
+    list_get(input, start, &pair[0]);
+    for (int i = start + 1; i < end; i++) {
+        list_get(input, i, &pair[1]);
+        pair[0] = call_or_null(function, pair, 2);
+        gc_push_root(pair[0]);
+        poll_safepoint(self);
+        gc_pop_roots(1);
+    }
+    return pair[0];
+}
+
+static void run_chunk(const Job *j, int chunk, int self) {
+    int start = chunk * j->chunk_size;
+    int end = start + j->chunk_size;
+    if (end > j->count) end = j->count;
+    if (j->kind == JOB_MAP) map_range(j, start, end, self);
+    else j->results[chunk] = reduce_range(j->function, j->input, start, end, self);
+}
+
+// --- Work Stealing ---
+
+static int pop_bottom(Deque *d) {
+    int chunk = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->top < d->bottom) chunk = --d->bottom;
+    pthread_mutex_unlock(&d->lock);
+    return chunk;
+}
+
+static int steal(int self) {
+    for (int k = 1; k < pool_size; k++) {
+        Deque *d = &deques[(self + k) % pool_size];
+        pthread_mutex_lock(&d->lock);
+        int chunk = d->top < d->bottom ? d->top++ : -1;
+        pthread_mutex_unlock(&d->lock);
+        if (chunk >= 0) return chunk;
+    }
+    return -1; // Chunks are never added during a job, so every deque is drained
+}
+
+// The main thread holds pool_lock. Every other thread is parked with its
+// objects flushed and its roots published, or has no chunks left.
+static void collect_parked(void) {
+    gc_parallel_collect();
+    __atomic_store_n(&collect_pending, 0, __ATOMIC_RELAXED);
+    collections++;
+    parked = 0; // A released worker that has not woken yet is no longer stopped
+    pthread_cond_broadcast(&collected);
+}
+
+// Between calls a thread holds nothing beyond its evaluation stack, its
+// live environments and the results it has stored in the job
+static void safepoint(int self) {
+    int due = gc_parallel_flush();
+    pthread_mutex_lock(&pool_lock);
+    if (due) __atomic_store_n(&collect_pending, 1, __ATOMIC_RELAXED);
+    if (collect_pending) {
+        if (self == 0) {
+            while (parked < running - 1) pthread_cond_wait(&work_done, &pool_lock);
+            collect_parked();
+        } else {
+            GcThreadRoots roots;
+            unsigned seen = collections;
+            gc_parallel_publish(&roots);
+            parked++;
+            pthread_cond_signal(&work_done);
+            while (collections == seen) pthread_cond_wait(&collected, &pool_lock);
+        }
+    }
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// Every chunk ends at a safepoint; inside one, a call boundary only stops
+// once the thread has allocated enough or a collection is waiting on it.
+// collect_pending is only written under pool_lock, safepoint rereads it there.
+static void poll_safepoint(int self) {
+    if (gc_parallel_flush_due() || __atomic_load_n(&collect_pending, __ATOMIC_RELAXED)) safepoint(self);
+}
+
+static void work(int self) {
+    int chunk;
+    while ((chunk = pop_bottom(&deques[self])) >= 0 || (chunk = steal(self)) >= 0) {
+        run_chunk(job, chunk, self);
+        safepoint(self);
+    }
+    pthread_mutex_lock(&pool_lock);
+    running--;
+    pthread_cond_signal(&work_done); // The main thread may be waiting for this one to stop
+    pthread_mutex_unlock(&pool_lock);
+}
+
+static void* worker_main(void *arg) {
+    int self = (int)(intptr_t)arg;
+    evaluator_init_worker();
+
+    unsigned seen = 0;
+    pthread_mutex_lock(&pool_lock);
+    for (;;) {
+        while (generation == seen && !shutting_down) pthread_cond_wait(&work_ready, &pool_lock);
+        if (shutting_down) break;
+        seen = generation;
+        pthread_mutex_unlock(&pool_lock);
+
+        work(self);
+
+        pthread_mutex_lock(&pool_lock);
+        if (--busy == 0) pthread_cond_signal(&work_done);
+    }
+    pthread_mutex_unlock(&pool_lock);
+    gc_thread_shutdown();
+    return NULL;
+}
+
+int parallel_thread_count(void) {
+    int count = requested_threads;
+    if (count == 0) count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1 ? 1 : count;
+}
+
+// The function, the input and every result stored so far; results start
+// out null
+static void mark_job(void) {
+    if (!job) return;
+    gc_mark_value(job->function);
+    gc_mark_object((Obj*)job->input);
+    int slots = job->kind == JOB_MAP ? job->count : (job->count + job->chunk_size - 1) / job->chunk_size;
+    for (int i = 0; i < slots; i++) gc_mark_value(job->results[i]);
+}
+
+static void start_pool(void) {
+    int count = parallel_thread_count();
+
+    deques = malloc(sizeof(Deque) * count);
+    for (int i = 0; i < count; i++) {
+        pthread_mutex_init(&deques[i].lock, NULL);
+        deques[i].top = deques[i].bottom = 0;
+    }
+    threads = malloc(sizeof(pthread_t) * count);
+    pool_size = 1; // The main thread is worker 0
+    for (int i = 1; i < count; i++) {
+        if (pthread_create(&threads[i], NULL, worker_main, (void*)(intptr_t)i) != 0) break;
+        pool_size++;
+    }
+    gc_add_root_marker(mark_job); // Dropped by gc_shutdown, which follows parallel_shutdown
+}
+
+// Runs 'j' on every worker, the calling (main) thread included. The GC
+// collects only at safepoints between calls.
+static void run_job(Job *j) {
+    int chunks = (j->count + j->chunk_size - 1) / j->chunk_size;
+    for (int w = 0; w < pool_size; w++) {
+        deques[w].top = (int)((long)chunks * w / pool_size);
+        deques[w].bottom = (int)((long)chunks * (w + 1) / pool_size);
+    }
+
+    snapshot_materialize_all(); // Workers must find every function body decoded
+    parser_materialize_all();   // and parsed
+    gc_parallel_begin();
+    region_active = 1;
+
+    pthread_mutex_lock(&pool_lock);
+    job = j;
+    busy = pool_size - 1;
+    running = pool_size;
+    generation++;
+    pthread_cond_broadcast(&work_ready);
+    pthread_mutex_unlock(&pool_lock);
+
+    work(0);
+
+    pthread_mutex_lock(&pool_lock);
+    while (busy > 0) {
+        if (collect_pending && parked == running) collect_parked();
+        else pthread_cond_wait(&work_done, &pool_lock);
+    }
+    job = NULL;
+    __atomic_store_n(&collect_pending, 0, __ATOMIC_RELAXED); // The next allocation collects instead
+    pthread_mutex_unlock(&pool_lock);
+
+    region_active = 0;
+    gc_parallel_end();
+}
+
+// Parallel only from the main thread, outside another parallel call, and
+// with more than one worker; otherwise the caller does the work itself
+static int use_pool(int count) {
+    if (region_active || count < 2) return 0;
+    if (pool_size == 0) start_pool();
+    return pool_size > 1;
+}
+
+static int chunk_size_for(int count) {
+    int size = count / (pool_size * CHUNKS_PER_WORKER);
+    return size < 1 ? 1 : size;
+}
+
+// --- Natives ---
+
+static int expect_function_list(const char *name, Value *args, int argc, int expected) {
+    if (argc != expected) {
+        fprintf(stderr, "Runtime Error: '%s' expects %d argument(s), got %d.\n", name, expected, argc);
+        return 0;
+    }
+    if ((args[0].type != VAL_FUNCTION && args[0].type != VAL_CLOSURE && args[0].type != VAL_NATIVE) ||
+        args[1].type != VAL_LIST) {
+        fprintf(stderr, "Runtime Error: '%s' expects a function and a list.\n", name);
+        return 0;
+    }
+    return 1;
+}
+
+// peta_paralel(f, xs): new list of f(x) for every x, computed on the pool
+static int bi_peta_paralel(Value *args, int argc, Value *out) {
+    if (!expect_function_list("peta_paralel", args, argc, 2)) return 0;
+    ObjList *input = args[1].as.list;
+    int count = input->count;
+
+    ObjList *result = list_new(count);
+    gc_push_root(make_list(result));
+
+    if (use_pool(count)) {
+        Job j = {JOB_MAP, args[0], input, count, chunk_size_for(count), NULL};
+        j.results = malloc(sizeof(Value) * count);
+        for (int i = 0; i < count; i++) j.results[i] = make_null();
+        run_job(&j);
+        for (int i = 0; i < count; i++) list_append(result, j.results[i]); // Never collects
+        free(j.results);
+    } else {
+        for (int i = 0; i < count; i++) {
+            Value x;
+            list_get(input, i, &x);
+            list_append(result, call_or_null(args[0], &x, 1));
+        }
+    }
+
+    gc_pop_roots(1);
+    *out = make_list(result);
+    return 1;
+}
+
+// reduksi_paralel(f, xs, awal): folds xs with f starting from awal. Chunks
+// are folded in parallel and their results folded in order afterwards, so f
+// must be associative.
+static int bi_reduksi_paralel(Value *args, int argc, Value *out) {
+    if (!expect_function_list("reduksi_paralel", args, argc, 3)) return 0;
+    ObjList *input = args[1].as.list;
+    int count = input->count;
+
+    Value pair[2];
+    pair[0] = args[2];
+    if (use_pool(count)) {
+        Job j = {JOB_REDUCE, args[0], input, count, chunk_size_for(count), NULL};
+        int chunks = (count + j.chunk_size - 1) / j.chunk_size;
+        j.results = malloc(sizeof(Value) * chunks);
+        for (int c = 0; c < chunks; c++) j.results[c] = make_null();
+        run_job(&j);
+
+        for (int c = 0; c < chunks; c++) gc_push_root(j.results[c]);
+        for (int c = 0; c < chunks; c++) {
+            pair[1] = j.results[c];
+            gc_push_root(pair[0]);
+            pair[0] = call_or_null(args[0], pair, 2);
+            gc_pop_roots(1);
+        }
+        gc_pop_roots(chunks);
+        free(j.results);
+    } else {
+        for (int i = 0; i < count; i++) {
+            list_get(input, i, &pair[1]);
+            gc_push_root(pair[0]);
+            gc_push_root(pair[1]);
+            pair[0] = call_or_null(args[0], pair, 2);
+            gc_pop_roots(2);
+        }
+    }
+
+    *out = pair[0];
+    return 1;
+}
+
+void parallel_init(void) {
+    native_register("peta_paralel", bi_peta_paralel);
+    native_register("reduksi_paralel", bi_reduksi_paralel);
+}
+
+void parallel_shutdown(void) {
+    if (pool_size == 0) return;
+    pthread_mutex_lock(&pool_lock);
+    shutting_down = 1;
+    pthread_cond_broadcast(&work_ready);
+    pthread_mutex_unlock(&pool_lock);
+    for (int i = 1; i < pool_size; i++) pthread_join(threads[i], NULL);
+    for (int i = 0; i < pool_size; i++) pthread_mutex_destroy(&deques[i].lock);
+
+    free(threads);
+    free(deques);
+    threads = NULL;
+    deques = NULL;
+    pool_size = 0;
+    shutting_down = 0;
+}
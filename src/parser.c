@@ -1,40 +1,167 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <setjmp.h>
+#include <pthread.h>
 #include "parser.h"
 #include "lexer.h"
+#include "resolve.h"
+#include "gc.h"
 
 // Forward declarations
 static ASTNode* parse_statement();
 static ASTNode* parse_expression();
 static ASTNode* parse_block();
-static ASTNode* parse_logic_or();
+
+static int lazy_mode = 0;
+static FuncDeclNode **lazy_functions = NULL; // Pre-parsed in the current program
+static int lazy_count = 0;
+static int lazy_capacity = 0;
+
+// A chunk parsed on a worker thread (parse_parallel) writes its messages to
+// a buffer and gives up with a longjmp instead of exiting, so that errors
+// come out in source order once every chunk is done. parse_statements()
+// gives up the same way, printing as it goes.
+static _Thread_local FILE *chunk_diagnostics = NULL;
+static _Thread_local jmp_buf *chunk_bailout = NULL;
+
+static FILE* diagnostics(void) {
+    return chunk_diagnostics ? chunk_diagnostics : stderr;
+}
+
+_Noreturn static void fail(void) {
+    if (chunk_bailout) longjmp(*chunk_bailout, 1);
+    exit(1);
+}
 
 void init_parser(const char *source) {
     init_lexer(source);
+    lazy_count = 0;
+}
+
+void parser_set_lazy(int enabled) {
+    lazy_mode = enabled;
 }
 
 static Token consume(TokenType type, const char *err_msg) {
     Token t = next_token();
     if (t.type == type) return t;
 
-    fprintf(stderr, "Parser Error Line %d: %s. Found token type %d ('%s')\n", t.line, err_msg, t.type, t.value);
-    exit(1);
+    fprintf(diagnostics(), "Parser Error Line %d: %s. Found token type %d ('%s')\n", t.line, err_msg, t.type, t.value);
+    fail();
+}
+
+// Contextual words such as 'dari'/'sampai' stay usable as identifiers elsewhere
+static void consume_word(const char *word, const char *err_msg) {
+    Token t = next_token();
+    if (t.type == TOKEN_IDENTIFIER && strcmp(t.value, word) == 0) {
+        free(t.value);
+        return;
+    }
+
+    fprintf(diagnostics(), "Parser Error Line %d: %s. Found token type %d ('%s')\n", t.line, err_msg, t.type, t.value);
+    fail();
 }
 
 // --- Expression Parsing (Precedence) ---
 
+// Parses the text between an interpolation's braces as one expression, with
+// the lexer pointed at it for the duration
+static ASTNode* parse_embedded(const char *start, size_t length, int line) {
+    char *source = strndup(start, length);
+    LexerState saved;
+    lexer_save(&saved);
+    init_lexer_at(source, line);
+
+    if (peek_token().type == TOKEN_EOF) {
+        fprintf(diagnostics(), "Parser Error Line %d: Interpolasi '{}' kosong\n", line);
+        fail();
+    }
+    ASTNode *expr = parse_expression();
+    Token end = consume(TOKEN_EOF, "Diharapkan '}' setelah ekspresi interpolasi");
+    if(end.value) free(end.value);
+
+    lexer_restore(&saved);
+    free(source);
+    return expr;
+}
+
+// "Halo {nama}, skor {n}": literal runs and embedded expressions become the
+// parts of one NODE_INTERP, so evaluation formats them in a single pass.
+// '{{' and '}}' stand for literal braces; a string without '{' stays a literal.
+static ASTNode* parse_string(const char *text, int line) {
+    if (!strchr(text, '{')) return new_literal_string(text);
+
+    NodeList parts = {NULL, NULL};
+    char *run = malloc(strlen(text) + 1); // Literal text since the last expression
+    size_t run_length = 0;
+    int embedded = 0;
+    const char *p = text;
+    while (*p) {
+        if ((p[0] == '{' || p[0] == '}') && p[1] == p[0]) {
+            run[run_length++] = *p;
+            p += 2;
+            continue;
+        }
+        if (*p != '{') {
+            run[run_length++] = *p++;
+            continue;
+        }
+
+        const char *start = ++p;
+        int depth = 1; // Map literals nest braces
+        for (; *p; p++) {
+            if (*p == '{') depth++;
+            else if (*p == '}' && --depth == 0) break;
+        }
+        if (!*p) {
+            fprintf(diagnostics(), "Parser Error Line %d: '{' dalam teks tidak ditutup\n", line);
+            fail();
+        }
+        if (run_length > 0) {
+            run[run_length] = '\0';
+            node_list_push(&parts, new_literal_string(run));
+            run_length = 0;
+        }
+        node_list_push(&parts, parse_embedded(start, (size_t)(p - start), line));
+        embedded = 1;
+        p++;
+    }
+
+    run[run_length] = '\0';
+    ASTNode *node;
+    if (!embedded) {
+        node = new_literal_string(run); // Only escaped braces
+    } else {
+        if (run_length > 0) node_list_push(&parts, new_literal_string(run));
+        node = new_interp(parts.head);
+    }
+    free(run);
+    return node;
+}
+
 // Primary: Literal, Var, Grouping, Call
 static ASTNode* parse_primary() {
     Token t = next_token();
 
     if (t.type == TOKEN_STRING) {
-        ASTNode *node = new_literal_string(t.value);
+        ASTNode *node = parse_string(t.value, t.line);
         free(t.value);
         return node;
     }
     else if (t.type == TOKEN_NUMBER) {
-        ASTNode *node = new_literal_number(atoi(t.value));
+        errno = 0;
+        long long n = strtoll(t.value, NULL, 10);
+        // Too large for 64 bits: the literal is a decimal, like an overflowing result
+        ASTNode *node = errno == ERANGE ? new_literal_decimal(strtod(t.value, NULL))
+                                        : new_literal_number(n);
+        free(t.value);
+        return node;
+    }
+    else if (t.type == TOKEN_DECIMAL) {
+        ASTNode *node = new_literal_decimal(strtod(t.value, NULL));
         free(t.value);
         return node;
     }
@@ -47,22 +174,23 @@ static ASTNode* parse_primary() {
             Token lp = consume(TOKEN_LPAREN, "Expected '('");
             if(lp.value) free(lp.value);
 
-            ASTNode *args = NULL;
+            NodeList args = {NULL, NULL};
             if (peek_token().type != TOKEN_RPAREN) {
-                args = parse_expression();
+                node_list_push(&args, parse_expression());
                 while (peek_token().type == TOKEN_COMMA) {
                     Token cm = next_token(); // consume ,
                     if(cm.value) free(cm.value);
 
-                    ASTNode *next_arg = parse_expression();
-                    append_node(args, next_arg);
+                    node_list_push(&args, parse_expression());
                 }
             }
 
             Token rp = consume(TOKEN_RPAREN, "Expected ')'");
             if(rp.value) free(rp.value);
 
-            return new_call_expr(callee, args);
+            ASTNode *call = new_call_expr(callee, args.head);
+            free(callee);
+            return call;
         } else {
             // Just Variable Access
             ASTNode *node = new_var_access(t.value);
@@ -77,86 +205,97 @@ static ASTNode* parse_primary() {
         if(rp.value) free(rp.value);
         return expr;
     }
+    else if (t.type == TOKEN_LBRACKET) {
+        // List literal: [a, b, c]
+        free(t.value);
+        NodeList elements = {NULL, NULL};
+        if (peek_token().type != TOKEN_RBRACKET) {
+            node_list_push(&elements, parse_expression());
+            while (peek_token().type == TOKEN_COMMA) {
+                Token cm = next_token();
+                if(cm.value) free(cm.value);
+                node_list_push(&elements, parse_expression());
+            }
+        }
+        Token rb = consume(TOKEN_RBRACKET, "Diharapkan ']'");
+        if(rb.value) free(rb.value);
+        return new_list(elements.head);
+    }
+    else if (t.type == TOKEN_LBRACE) {
+        // Map literal: {k: v, ...}
+        free(t.value);
+        NodeList keys = {NULL, NULL};
+        NodeList values = {NULL, NULL};
+        int first = 1;
+        while (peek_token().type != TOKEN_RBRACE) {
+            if (!first) {
+                Token cm = consume(TOKEN_COMMA, "Diharapkan ',' atau '}'");
+                if(cm.value) free(cm.value);
+            }
+            first = 0;
+            node_list_push(&keys, parse_expression());
+            Token colon = consume(TOKEN_COLON, "Diharapkan ':'");
+            if(colon.value) free(colon.value);
+            node_list_push(&values, parse_expression());
+        }
+        Token rb = consume(TOKEN_RBRACE, "Diharapkan '}'");
+        if(rb.value) free(rb.value);
+        return new_map(keys.head, values.head);
+    }
 
-    fprintf(stderr, "Parser Error Line %d: Unexpected primary token type %d\n", t.line, t.type);
+    fprintf(diagnostics(), "Parser Error Line %d: Unexpected primary token type %d\n", t.line, t.type);
     if(t.value) free(t.value);
     return NULL;
 }
 
-// Unary: - (Negation), ! (Not) - Skip for now, straight to Mult
-
-// Multiplication: * /
-static ASTNode* parse_factor() {
+// Pratt parsing: one loop handles every infix and postfix operator, driven by
+// this binding-power table (0 = not an operator). A left-associative chain
+// such as a + b + c + ... is built iteratively; recursion only happens to
+// parse a tighter-binding right operand, so C stack depth is bounded by the
+// number of precedence levels, not by the length of the expression.
+static const int binding_power[TOKEN_UNKNOWN + 1] = {
+    [TOKEN_EQ_EQ] = 10, [TOKEN_BANG_EQ] = 10,
+    [TOKEN_LT] = 20, [TOKEN_GT] = 20, [TOKEN_LT_EQ] = 20, [TOKEN_GT_EQ] = 20,
+    [TOKEN_PLUS] = 30, [TOKEN_MINUS] = 30,
+    [TOKEN_STAR] = 40, [TOKEN_SLASH] = 40,
+    [TOKEN_LBRACKET] = 50, // Postfix indexing xs[i], chainable
+};
+
+static ASTNode* parse_expression_bp(int min_bp) {
     ASTNode *expr = parse_primary();
 
-    while (peek_token().type == TOKEN_STAR || peek_token().type == TOKEN_SLASH) {
-        Token op = next_token();
-        TokenType type = op.type;
-        if(op.value) free(op.value);
-
-        ASTNode *right = parse_primary();
-        expr = new_binary_expr(expr, type, right);
-    }
-    return expr;
-}
-
-// Addition: + -
-static ASTNode* parse_term() {
-    ASTNode *expr = parse_factor();
-
-    while (peek_token().type == TOKEN_PLUS || peek_token().type == TOKEN_MINUS) {
-        Token op = next_token();
-        TokenType type = op.type;
-        if(op.value) free(op.value);
-
-        ASTNode *right = parse_factor();
-        expr = new_binary_expr(expr, type, right);
-    }
-    return expr;
-}
-
-// Comparison: < > <= >=
-static ASTNode* parse_comparison() {
-    ASTNode *expr = parse_term();
+    for (;;) {
+        TokenType op = peek_token().type;
+        int bp = binding_power[op];
+        if (bp <= min_bp) break; // Equal power stops too: left-associative
 
-    while (peek_token().type == TOKEN_LT || peek_token().type == TOKEN_GT ||
-           peek_token().type == TOKEN_LT_EQ || peek_token().type == TOKEN_GT_EQ) {
-        Token op = next_token();
-        TokenType type = op.type;
-        if(op.value) free(op.value);
+        Token t = next_token();
+        if(t.value) free(t.value);
 
-        ASTNode *right = parse_term();
-        expr = new_binary_expr(expr, type, right);
-    }
-    return expr;
-}
-
-// Equality: == !=
-static ASTNode* parse_equality() {
-    ASTNode *expr = parse_comparison();
-
-    while (peek_token().type == TOKEN_EQ_EQ || peek_token().type == TOKEN_BANG_EQ) {
-        Token op = next_token();
-        TokenType type = op.type;
-        if(op.value) free(op.value);
+        if (op == TOKEN_LBRACKET) {
+            ASTNode *index = parse_expression();
+            Token rb = consume(TOKEN_RBRACKET, "Diharapkan ']'");
+            if(rb.value) free(rb.value);
+            expr = new_index(expr, index);
+            continue;
+        }
 
-        ASTNode *right = parse_comparison();
-        expr = new_binary_expr(expr, type, right);
+        ASTNode *right = parse_expression_bp(bp);
+        expr = new_binary_expr(expr, op, right);
     }
     return expr;
 }
 
 // Entry Point for Expressions
 static ASTNode* parse_expression() {
-    return parse_equality(); // Start from lowest precedence
+    return parse_expression_bp(0);
 }
 
 
 // --- Statement Parsing ---
 
 static ASTNode* parse_block() {
-    ASTNode *head = NULL;
-    ASTNode *current = NULL;
+    NodeList stmts = {NULL, NULL};
 
     // Block stops at AKHIR. But does it stop at KEMBALI?
     // A block inside a function might contain KEMBALI as one of its statements.
@@ -169,15 +308,125 @@ static ASTNode* parse_block() {
         ASTNode *stmt = parse_statement();
         if (!stmt) break; // Should not happen unless error
 
-        if (head == NULL) {
-            head = stmt;
-            current = head;
-        } else {
-            current->next = stmt;
-            current = stmt;
+        node_list_push(&stmts, stmt);
+    }
+    return new_block(stmts.head);
+}
+
+static void note_use(FuncDeclNode *f, int *capacity, const char *text, int length) {
+    if (f->lazy_use_count >= *capacity) {
+        *capacity = *capacity < 16 ? 16 : *capacity * 2;
+        f->lazy_uses = realloc(f->lazy_uses, sizeof(char*) * *capacity);
+    }
+    f->lazy_uses[f->lazy_use_count++] = strndup(text, length);
+}
+
+// Words inside the '{...}' parts of a string literal; taking every word,
+// keywords and map keys included, can only keep more functions alive
+static void note_interpolated_uses(FuncDeclNode *f, int *capacity, const char *text, int length) {
+    int depth = 0;
+    for (int i = 0; i < length; i++) {
+        char c = text[i];
+        if (depth == 0 && (c == '{' || c == '}') && i + 1 < length && text[i + 1] == c) {
+            i++; // Escaped brace
+        } else if (c == '{') {
+            depth++;
+        } else if (c == '}') {
+            if (depth > 0) depth--;
+        } else if (depth > 0 && (isalpha((unsigned char)c) || c == '_')) {
+            int start = i;
+            while (i + 1 < length && (isalnum((unsigned char)text[i + 1]) || text[i + 1] == '_')) i++;
+            note_use(f, capacity, text + start, i + 1 - start);
         }
     }
-    return new_block(head);
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Pre-parse: finds the 'akhir' that closes a body from block nesting alone,
+// without building anything, and keeps the span for parser_materialize.
+// The names it passes are kept too, so optimize.c can still tell which
+// functions are used.
+static void skip_body(FuncDeclNode *f) {
+    int line;
+    const char *start = lexer_mark(&line);
+    int depth = 0;
+    int capacity = 0;
+    for (;;) {
+        const char *text;
+        int length;
+        TokenType t = skip_token_text(&text, &length);
+        if (t == TOKEN_IDENTIFIER) {
+            note_use(f, &capacity, text, length);
+        } else if (t == TOKEN_STRING) {
+            if (memchr(text, '{', length)) note_interpolated_uses(f, &capacity, text, length);
+        } else if (t == TOKEN_JIKA || t == TOKEN_ULANG || t == TOKEN_SELAMA || t == TOKEN_FUNGSI) {
+            depth++;
+        } else if (t == TOKEN_AKHIR) {
+            if (depth-- == 0) break;
+        } else if (t == TOKEN_EOF) {
+            consume(TOKEN_AKHIR, "Diharapkan 'akhir' setelah fungsi"); // Reports and exits
+        }
+    }
+
+    if (f->lazy_use_count > 1) {
+        qsort(f->lazy_uses, f->lazy_use_count, sizeof(char*), compare_names);
+        int out = 1;
+        for (int i = 1; i < f->lazy_use_count; i++) {
+            if (strcmp(f->lazy_uses[i], f->lazy_uses[out - 1]) == 0) free(f->lazy_uses[i]);
+            else f->lazy_uses[out++] = f->lazy_uses[i];
+        }
+        f->lazy_use_count = out;
+    }
+
+    int end_line;
+    f->lazy_body = start;
+    f->lazy_length = (size_t)(lexer_mark(&end_line) - start);
+    f->lazy_line = line;
+}
+
+// fungsi name(params) ... akhir. A lazy body is only skipped over here.
+static ASTNode* parse_function(int lazy) {
+    Token tok = next_token();
+    if(tok.value) free(tok.value);
+
+    Token name = consume(TOKEN_IDENTIFIER, "Diharapkan nama fungsi");
+    Token lp = consume(TOKEN_LPAREN, "Diharapkan '('");
+    if(lp.value) free(lp.value);
+
+    NodeList params = {NULL, NULL};
+    if (peek_token().type != TOKEN_RPAREN) {
+        Token p = consume(TOKEN_IDENTIFIER, "Diharapkan nama parameter");
+        node_list_push(&params, new_var_access(p.value)); // Use VarAccess as Param Node holder
+        free(p.value);
+
+        while (peek_token().type == TOKEN_COMMA) {
+            Token cm = next_token();
+            if(cm.value) free(cm.value);
+
+            Token pn = consume(TOKEN_IDENTIFIER, "Diharapkan nama parameter");
+            node_list_push(&params, new_var_access(pn.value));
+            free(pn.value);
+        }
+    }
+
+    Token rp = consume(TOKEN_RPAREN, "Diharapkan ')'");
+    if(rp.value) free(rp.value);
+
+    ASTNode *node = new_func_decl(name.value, params.head, NULL);
+    free(name.value);
+    if (lazy) {
+        skip_body((FuncDeclNode*)node);
+        return node;
+    }
+
+    ((FuncDeclNode*)node)->body = parse_block();
+
+    Token akhir = consume(TOKEN_AKHIR, "Diharapkan 'akhir' setelah fungsi");
+    if(akhir.value) free(akhir.value);
+    return node;
 }
 
 static ASTNode* parse_statement() {
@@ -223,44 +472,50 @@ static ASTNode* parse_statement() {
         return new_if(cond, then_block);
     }
 
-    // 4. Fungsi
-    if (t.type == TOKEN_FUNGSI) {
+    // 3b. Ulang (Counted loop): ulang i dari a sampai b maka ... akhir
+    if (t.type == TOKEN_ULANG) {
         Token tok = next_token();
         if(tok.value) free(tok.value);
 
-        Token name = consume(TOKEN_IDENTIFIER, "Diharapkan nama fungsi");
-        Token lp = consume(TOKEN_LPAREN, "Diharapkan '('");
-        if(lp.value) free(lp.value);
+        Token id = consume(TOKEN_IDENTIFIER, "Diharapkan nama variabel penghitung");
+        consume_word("dari", "Diharapkan 'dari'");
+        ASTNode *start = parse_expression();
+        consume_word("sampai", "Diharapkan 'sampai'");
+        ASTNode *end = parse_expression();
+
+        Token maka = consume(TOKEN_MAKA, "Diharapkan 'maka'");
+        if(maka.value) free(maka.value);
+
+        ASTNode *body = parse_block();
 
-        ASTNode *params = NULL;
-        if (peek_token().type != TOKEN_RPAREN) {
-            Token p = consume(TOKEN_IDENTIFIER, "Diharapkan nama parameter");
-            params = new_var_access(p.value); // Use VarAccess as Param Node holder
-            free(p.value);
+        Token akhir = consume(TOKEN_AKHIR, "Diharapkan 'akhir'");
+        if(akhir.value) free(akhir.value);
 
-            while (peek_token().type == TOKEN_COMMA) {
-                Token cm = next_token();
-                if(cm.value) free(cm.value);
+        ASTNode *node = new_repeat(id.value, start, end, body);
+        free(id.value);
+        return node;
+    }
 
-                Token pn = consume(TOKEN_IDENTIFIER, "Diharapkan nama parameter");
-                append_node(params, new_var_access(pn.value));
-                free(pn.value);
-            }
-        }
+    // 3c. Selama (While loop)
+    if (t.type == TOKEN_SELAMA) {
+        Token tok = next_token();
+        if(tok.value) free(tok.value);
 
-        Token rp = consume(TOKEN_RPAREN, "Diharapkan ')'");
-        if(rp.value) free(rp.value);
+        ASTNode *cond = parse_expression();
+        Token maka = consume(TOKEN_MAKA, "Diharapkan 'maka'");
+        if(maka.value) free(maka.value);
 
         ASTNode *body = parse_block();
 
-        Token akhir = consume(TOKEN_AKHIR, "Diharapkan 'akhir' setelah fungsi");
+        Token akhir = consume(TOKEN_AKHIR, "Diharapkan 'akhir'");
         if(akhir.value) free(akhir.value);
 
-        ASTNode *node = new_func_decl(name.value, params, body);
-        free(name.value);
-        return node;
+        return new_while(cond, body);
     }
 
+    // 4. Fungsi
+    if (t.type == TOKEN_FUNGSI) return parse_function(0);
+
     // 5. Kembali (Return)
     if (t.type == TOKEN_KEMBALI) {
         Token tok = next_token();
@@ -276,19 +531,200 @@ static ASTNode* parse_statement() {
     // Note: This effectively allows "1+1" as a statement (no-op but parsed).
 }
 
-ASTNode* parse() {
-    ASTNode *head = NULL;
-    ASTNode *current = NULL;
+static ASTNode* parse_top_level(void) {
+    NodeList stmts = {NULL, NULL};
 
     while (peek_token().type != TOKEN_EOF) {
-        ASTNode *stmt = parse_statement();
-        if (head == NULL) {
-            head = stmt;
-            current = head;
-        } else {
-            current->next = stmt;
-            current = stmt;
+        // Only top-level functions are left lazy: they capture nothing
+        if (lazy_mode && peek_token().type == TOKEN_FUNGSI) node_list_push(&stmts, parse_function(1));
+        else node_list_push(&stmts, parse_statement());
+    }
+    return stmts.head;
+}
+
+// Lists the lazy top-level functions for parser_materialize_all
+static void track_lazy(ASTNode *stmts) {
+    for (ASTNode *n = stmts; n; n = n->next) {
+        if (n->type != NODE_FUNC_DECL || !((FuncDeclNode*)n)->lazy_body) continue;
+        if (lazy_count >= lazy_capacity) {
+            lazy_capacity = lazy_capacity < 64 ? 64 : lazy_capacity * 2;
+            lazy_functions = realloc(lazy_functions, sizeof(FuncDeclNode*) * lazy_capacity);
         }
+        lazy_functions[lazy_count++] = (FuncDeclNode*)n;
+    }
+}
+
+static ASTNode* finish_program(ASTNode *stmts) {
+    track_lazy(stmts);
+    return new_program(stmts);
+}
+
+ASTNode* parse() {
+    return finish_program(parse_top_level());
+}
+
+// --- Parallel Parsing ---
+
+#define CHUNK_MIN_SIZE (64 * 1024) // Smaller pieces are not worth a thread
+
+typedef struct {
+    SourceSpan span;
+    ASTNode *statements;
+    char *messages;       // Diagnostics, printed in chunk order afterwards
+    size_t messages_size;
+    int failed;
+    pthread_t thread;
+} Chunk;
+
+static void* parse_chunk(void *arg) {
+    Chunk *c = arg;
+    jmp_buf bailout;
+    chunk_diagnostics = open_memstream(&c->messages, &c->messages_size);
+    if (setjmp(bailout) == 0) {
+        chunk_bailout = &bailout;
+        init_lexer_span(c->span.start, c->span.length, c->span.line);
+        c->statements = parse_top_level();
+    } else {
+        c->failed = 1; // What it built so far is dropped with the process
+    }
+    chunk_bailout = NULL;
+    fclose(chunk_diagnostics);
+    chunk_diagnostics = NULL;
+    gc_parallel_flush();
+    return NULL;
+}
+
+// Cheap scan over the whole source, lexing without copying token text. A
+// statement keyword at block depth 0 can only start a top-level statement
+// (keywords never occur inside expressions).
+int parser_split(const char *source, size_t length, size_t share, SourceSpan **out) {
+    int capacity = 16;
+    SourceSpan *spans = malloc(sizeof(SourceSpan) * capacity);
+    spans[0].start = source;
+    spans[0].line = 1;
+    int count = 1;
+    int depth = 0;
+    init_lexer_span(source, length, 1);
+    for (;;) {
+        int line;
+        const char *at = lexer_mark(&line);
+        TokenType t = skip_token();
+        if (t == TOKEN_EOF) break;
+
+        int opens = t == TOKEN_JIKA || t == TOKEN_ULANG || t == TOKEN_SELAMA || t == TOKEN_FUNGSI;
+        int starts = opens || t == TOKEN_TULIS || t == TOKEN_BIAR || t == TOKEN_KEMBALI;
+        size_t offset = (size_t)(at - source);
+        if (starts && depth == 0 && at > spans[count - 1].start && offset >= share * count) {
+            if (count >= capacity) {
+                capacity *= 2;
+                spans = realloc(spans, sizeof(SourceSpan) * capacity);
+            }
+            spans[count - 1].length = (size_t)(at - spans[count - 1].start);
+            spans[count].start = at;
+            spans[count].line = line;
+            count++;
+        }
+        if (opens) depth++;
+        else if (t == TOKEN_AKHIR && depth > 0) depth--;
+    }
+    spans[count - 1].length = length - (size_t)(spans[count - 1].start - source);
+    *out = spans;
+    return count;
+}
+
+ASTNode* parse_parallel(const char *source, int threads) {
+    init_parser(source);
+    size_t length = strlen(source);
+    int max_chunks = threads;
+    if ((size_t)max_chunks > length / CHUNK_MIN_SIZE) max_chunks = (int)(length / CHUNK_MIN_SIZE);
+    if (max_chunks < 2) return parse();
+
+    // Rounded up so the last share ends at the end: at most max_chunks cuts
+    SourceSpan *spans;
+    int count = parser_split(source, length, (length + max_chunks - 1) / max_chunks, &spans);
+    if (count < 2) {
+        free(spans);
+        init_parser(source);
+        return parse();
+    }
+    Chunk *chunks = calloc(count, sizeof(Chunk));
+    for (int i = 0; i < count; i++) chunks[i].span = spans[i];
+    free(spans);
+
+    // Chunk 0 runs here; allocation is deferred like in parallel calls (gc.h)
+    gc_parallel_begin();
+    int started = 1;
+    for (int i = 1; i < count; i++, started++) {
+        if (pthread_create(&chunks[i].thread, NULL, parse_chunk, &chunks[i]) != 0) break;
+    }
+    for (int i = started; i < count; i++) parse_chunk(&chunks[i]); // Out of threads
+    parse_chunk(&chunks[0]);
+    for (int i = 1; i < started; i++) pthread_join(chunks[i].thread, NULL);
+    gc_parallel_end();
+
+    // Stitch the statement lists in source order, reporting as a sequential
+    // parse would have: everything up to the first failing chunk
+    ASTNode *stmts = NULL;
+    ASTNode **tail = &stmts;
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        if (!failed) {
+            fwrite(chunks[i].messages, 1, chunks[i].messages_size, stderr);
+            failed = chunks[i].failed;
+        }
+        free(chunks[i].messages);
+        *tail = chunks[i].statements;
+        while (*tail) tail = &(*tail)->next;
+    }
+    free(chunks);
+    if (failed) exit(1);
+    return finish_program(stmts);
+}
+
+int parse_statements(const char *source, size_t length, int line, ASTNode **out) {
+    jmp_buf bailout;
+    int was_lazy = lazy_mode;
+    int ok = 1;
+    *out = NULL;
+    lazy_mode = 0;
+    if (setjmp(bailout) == 0) {
+        chunk_bailout = &bailout;
+        init_lexer_span(source, length, line);
+        *out = parse_top_level();
+    } else {
+        ok = 0; // What it built so far is leaked
+    }
+    chunk_bailout = NULL;
+    lazy_mode = was_lazy;
+    return ok;
+}
+
+void parser_materialize(FuncDeclNode *decl) {
+    LexerState saved;
+    lexer_save(&saved);
+    init_lexer_span(decl->lazy_body, decl->lazy_length, decl->lazy_line);
+    decl->lazy_body = NULL;
+
+    ASTNode *body = parse_block();
+    Token akhir = consume(TOKEN_AKHIR, "Diharapkan 'akhir' setelah fungsi");
+    if(akhir.value) free(akhir.value);
+    lexer_restore(&saved);
+
+    decl->body = body;
+    for (int i = 0; i < decl->lazy_use_count; i++) free(decl->lazy_uses[i]);
+    free(decl->lazy_uses);
+    decl->lazy_uses = NULL;
+    decl->lazy_use_count = 0;
+    resolve_function(decl);
+}
+
+void parser_track_lazy(ASTNode *program) {
+    lazy_count = 0;
+    track_lazy(((ProgramNode*)program)->statements);
+}
+
+void parser_materialize_all(void) {
+    for (int i = 0; i < lazy_count; i++) {
+        if (lazy_functions[i]->lazy_body) parser_materialize(lazy_functions[i]);
     }
-    return new_program(head);
 }
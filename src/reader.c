@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "reader.h"
+#include "evaluator.h"
+
+ObjReader* reader_open(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    return gc_new_reader(file, 1);
+}
+
+ObjReader* reader_stdin(void) {
+    return gc_new_reader(stdin, 0);
+}
+
+// Lets other tasks run until the file has input. Another task may read from
+// or close the same reader meanwhile, so callers look at its state only
+// afterwards. Returns 0 when there is nothing left to read.
+static int wait_input(ObjReader *reader) {
+    if (!reader->file || reader->eof) return 0;
+    evaluator_wait_readable(fileno(reader->file));
+    return reader->file && !reader->eof;
+}
+
+// read() rather than fread(): a pipe or terminal returns what it has, so a
+// task is never stuck waiting for a full chunk. Returns 0 at end of input.
+static size_t read_some(ObjReader *reader, char *buf, size_t size) {
+    ssize_t n;
+    while ((n = read(fileno(reader->file), buf, size)) < 0 && errno == EINTR) {}
+    return n > 0 ? (size_t)n : 0;
+}
+
+// Appends new input after the valid bytes while the chunk has room (lines
+// handed out only cover bytes before 'pos', so they are untouched).
+// Otherwise starts a fresh chunk holding the unread tail of the old one; the
+// lines already handed out keep the old chunk alive.
+static void refill(ObjReader *reader) {
+    if (!wait_input(reader)) {
+        reader->eof = 1;
+        return;
+    }
+    if (reader->chunk && reader->end < reader->chunk->length) {
+        size_t n = read_some(reader, reader->chunk->chars + reader->end,
+                             reader->chunk->length - reader->end);
+        if (n == 0) reader->eof = 1;
+        reader->end += n;
+        return;
+    }
+
+    size_t carry = reader->end - reader->pos;
+    size_t size = READER_CHUNK;
+    while (size < carry * 2) size *= 2;
+
+    ObjString *chunk = gc_alloc_string(size); // 'reader' is rooted, the old chunk through it
+    if (carry > 0) memcpy(chunk->chars, reader->chunk->chars + reader->pos, carry);
+    reader->chunk = chunk;
+    reader->pos = 0;
+    reader->end = carry;
+
+    size_t n = read_some(reader, chunk->chars + carry, size - carry);
+    if (n == 0) reader->eof = 1;
+    reader->end += n;
+}
+
+int reader_next_line(ObjReader *reader, Value *out) {
+    for (;;) {
+        if (reader->chunk) {
+            char *start = reader->chunk->chars + reader->pos;
+            size_t avail = reader->end - reader->pos;
+            char *nl = memchr(start, '\n', avail);
+
+            if (nl || (reader->eof && avail > 0)) {
+                size_t len = nl ? (size_t)(nl - start) : avail;
+                size_t next = reader->pos + len + (nl ? 1 : 0);
+                if (len > 0 && start[len - 1] == '\r') len--;
+
+                *out = make_string_slice(reader->chunk, reader->pos, len);
+                reader->pos = next;
+                return 1;
+            }
+        }
+        if (reader->eof) return 0;
+        refill(reader);
+    }
+}
+
+long long reader_count_lines(ObjReader *reader) {
+    long long lines = 0;
+    int pending = 0; // Bytes seen after the last newline
+
+    if (reader->chunk) {
+        const char *p = reader->chunk->chars + reader->pos;
+        const char *end = reader->chunk->chars + reader->end;
+        while ((p = memchr(p, '\n', end - p)) != NULL) {
+            lines++;
+            p++;
+        }
+        pending = reader->end > reader->pos && reader->chunk->chars[reader->end - 1] != '\n';
+        reader->pos = reader->end;
+    }
+
+    if (!reader->eof && reader->file) {
+        // Nothing returned from here on is visible, so a single buffer is reused
+        ObjString *buf = gc_alloc_string(READER_CHUNK);
+        reader->chunk = buf;
+        gc_push_root(make_string_obj(buf)); // Still ours if another task refills the reader
+        size_t n;
+        while (wait_input(reader) && (n = read_some(reader, buf->chars, READER_CHUNK)) > 0) {
+            const char *p = buf->chars;
+            const char *end = buf->chars + n;
+            while ((p = memchr(p, '\n', end - p)) != NULL) {
+                lines++;
+                p++;
+            }
+            pending = buf->chars[n - 1] != '\n';
+        }
+        gc_pop_roots(1);
+        reader->pos = reader->end = 0;
+        reader->eof = 1;
+    }
+    return lines + pending;
+}
+
+void reader_close(ObjReader *reader) {
+    if (reader->file && reader->owns_file) fclose(reader->file);
+    reader->file = NULL;
+    reader->eof = 1;
+}
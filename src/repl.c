@@ -0,0 +1,647 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "repl.h"
+#include "parser.h"
+#include "lexer.h"
+#include "resolve.h"
+#include "evaluator.h"
+#include "builtins.h"
+#include "gc.h"
+
+#define WATCH_POLL_MS 50
+
+// --- Running Statement Lists ---
+
+// Resolves and runs a statement list in the global environment. The list
+// is borrowed: the wrapper is freed without it.
+static void run_statements(ASTNode *stmts) {
+    ASTNode *program = new_program(stmts);
+    resolve_program(program);
+    evaluate(program);
+    ((ProgramNode*)program)->statements = NULL;
+    free_ast(program);
+}
+
+// Blocks the text opens and has not closed yet
+static int open_blocks(const char *text, size_t length) {
+    int depth = 0;
+    init_lexer_span(text, length, 1);
+    for (TokenType t; (t = skip_token()) != TOKEN_EOF; ) {
+        if (t == TOKEN_JIKA || t == TOKEN_ULANG || t == TOKEN_SELAMA || t == TOKEN_FUNGSI) depth++;
+        else if (t == TOKEN_AKHIR) depth--;
+    }
+    return depth;
+}
+
+// --- Watch ---
+
+// Top-level statements from one split point to the next (parser_split)
+typedef struct {
+    SourceSpan span;  // Into the source it was last seen in
+    const char *text; // The span without surrounding whitespace
+    size_t length;
+    uint64_t hash;
+    ASTNode *statements;
+    ASTNode *tail;
+    int reused;       // Same text as a segment of the previous version
+    int ran;          // In this version's run, not skipped
+    int bound;        // Its functions were bound by a run that got past it
+    int kept;         // Skipped: its functions are still bound from before
+} Segment;
+
+typedef struct {
+    char *source;
+    size_t length;
+    Segment *segments;
+    int count;
+    NameTable names;  // Bound by top-level code in this version
+    ASTNode **retired; // Statement lists of replaced segments, not freed yet
+    int retired_count;
+    int retired_capacity;
+} Watch;
+
+static uint64_t text_hash(const char *text, size_t length) {
+    uint64_t h = 14695981039346656037ull; // FNV-1a
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)text[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static char* load_source(const char *path, struct stat *st) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Gagal membuka file: %s\n", path);
+        return NULL;
+    }
+    fstat(fileno(file), st);
+    char *buffer = malloc(st->st_size + 1);
+    size_t length = fread(buffer, 1, st->st_size, file);
+    buffer[length] = '\0';
+    fclose(file);
+    return buffer;
+}
+
+static void retire(Watch *w, ASTNode *stmts) {
+    if (!stmts) return;
+    if (w->retired_count >= w->retired_capacity) {
+        w->retired_capacity = w->retired_capacity < 16 ? 16 : w->retired_capacity * 2;
+        w->retired = realloc(w->retired, sizeof(ASTNode*) * w->retired_capacity);
+    }
+    w->retired[w->retired_count++] = stmts;
+}
+
+static int only_functions(const Segment *s) {
+    if (!s->statements) return 0;
+    for (ASTNode *n = s->statements; n; n = n->next) {
+        if (n->type != NODE_FUNC_DECL) return 0;
+    }
+    return 1;
+}
+
+static int has_return(const Segment *s) {
+    for (ASTNode *n = s->statements; n; n = n->next) {
+        if (n->type == NODE_RETURN) return 1;
+    }
+    return 0;
+}
+
+// Its bindings from the last run still hold when it is unchanged and each
+// of its functions was, and is, the only binding of that name
+static int still_bound(const Segment *s, const NameTable *before, const NameTable *now) {
+    if (!s->reused || !s->bound || !only_functions(s)) return 0;
+    for (ASTNode *n = s->statements; n; n = n->next) {
+        const char *name = ((FuncDeclNode*)n)->name;
+        if (name_table_count(before, name) != 1 || name_table_count(now, name) != 1) return 0;
+    }
+    return 1;
+}
+
+// A fresh run would find a function unbound until its 'fungsi' statement,
+// so a still bound segment is only kept when nothing that runs before it
+// can reach one of its names: a statement mentioning it, or a call to a
+// function bound by then whose body does, and so on. Only names top-level
+// code binds matter, so they are tracked by position in that table.
+typedef struct {
+    const NameTable *names; // Bound by top-level code in this version
+    char *reached;
+    FuncDeclNode **latest;  // Last bound under that name so far
+    NameTable pending;      // Mentioned, not followed yet
+} Reach;
+
+static void follow_pending(Reach *r) {
+    while (r->pending.count > 0) {
+        NameCount *name = name_table_find(r->names, r->pending.items[--r->pending.count].name);
+        if (!name) continue; // Local, native or never bound
+        int i = (int)(name - r->names->items);
+        if (r->reached[i]) continue;
+        r->reached[i] = 1;
+        if (r->latest[i]) name_table_collect_function_uses(&r->pending, r->latest[i], NULL);
+    }
+}
+
+static void find_kept(Segment *segments, int count, const NameTable *before, const NameTable *now) {
+    int candidates = 0;
+    for (int i = 0; i < count; i++) {
+        segments[i].kept = still_bound(&segments[i], before, now);
+        candidates += segments[i].kept;
+    }
+    if (candidates == 0) return;
+
+    Reach r = {now, NULL, NULL, {NULL, 0, 0}};
+    r.reached = calloc(now->count + 1, 1);
+    r.latest = calloc(now->count + 1, sizeof(FuncDeclNode*));
+    for (int i = 0; i < count; i++) {
+        Segment *s = &segments[i];
+        for (ASTNode *n = s->statements; n; n = n->next) {
+            if (n->type == NODE_FUNC_DECL) {
+                FuncDeclNode *f = (FuncDeclNode*)n;
+                int k = (int)(name_table_find(now, f->name) - now->items);
+                if (r.reached[k]) {
+                    s->kept = 0;
+                    name_table_collect_function_uses(&r.pending, f, NULL);
+                }
+                r.latest[k] = f;
+            } else {
+                ASTNode *next = n->next;
+                n->next = NULL; // One statement at a time
+                name_table_collect_uses(&r.pending, n, NULL);
+                n->next = next;
+            }
+            follow_pending(&r);
+        }
+    }
+    free(r.reached);
+    free(r.latest);
+    free(r.pending.items);
+}
+
+// A fresh run starts from the natives alone: whatever the last run bound
+// goes, except the functions of kept segments
+static void unbind_previous(const Segment *segments, int count, const NameTable *before) {
+    char *keep = calloc(before->count + 1, 1);
+    for (int i = 0; i < count; i++) {
+        if (!segments[i].kept) continue;
+        for (ASTNode *n = segments[i].statements; n; n = n->next) {
+            keep[name_table_find(before, ((FuncDeclNode*)n)->name) - before->items] = 1;
+        }
+    }
+    Environment *globals = evaluator_global_env();
+    for (int i = 0; i < before->count; i++) {
+        if (keep[i]) continue;
+        const NativeDef *native = native_lookup(before->items[i].name);
+        if (native) env_set(globals, before->items[i].name, make_native(native));
+        else env_unbind(globals, before->items[i].name);
+    }
+    free(keep);
+}
+
+// --- Freeing Replaced Code ---
+
+// Function declarations values still refer to, sorted by address
+typedef struct {
+    ASTNode **items;
+    int count;
+    int capacity;
+} DeclSet;
+
+static void add_declaration(void *ctx, ASTNode *decl) {
+    DeclSet *set = ctx;
+    if (set->count >= set->capacity) {
+        set->capacity = set->capacity < 64 ? 64 : set->capacity * 2;
+        set->items = realloc(set->items, sizeof(ASTNode*) * set->capacity);
+    }
+    set->items[set->count++] = decl;
+}
+
+static int compare_addresses(const void *a, const void *b) {
+    uintptr_t x = (uintptr_t)*(ASTNode* const*)a, y = (uintptr_t)*(ASTNode* const*)b;
+    return x < y ? -1 : x > y;
+}
+
+typedef struct {
+    const DeclSet *live;
+    int referenced;
+} DeclCheck;
+
+static void check_declaration(void *ctx, ASTNode *node) {
+    DeclCheck *check = ctx;
+    if (node->type != NODE_FUNC_DECL || check->referenced || check->live->count == 0) return;
+    check->referenced = bsearch(&node, check->live->items, check->live->count,
+                                sizeof(ASTNode*), compare_addresses) != NULL;
+}
+
+// Replaced statements go once no global, closure or task result holds a
+// function declared in them. Calls in the current version may have cached
+// one of those declarations, which a later parse could reuse the memory of.
+static void free_unreferenced(Watch *w) {
+    if (w->retired_count == 0) return;
+    DeclSet live = {NULL, 0, 0};
+    gc_find_declarations(add_declaration, &live);
+    if (live.count > 0) qsort(live.items, live.count, sizeof(ASTNode*), compare_addresses);
+
+    int remaining = 0;
+    for (int i = 0; i < w->retired_count; i++) {
+        DeclCheck check = {&live, 0};
+        ast_visit(w->retired[i], check_declaration, &check);
+        if (check.referenced) {
+            w->retired[remaining++] = w->retired[i];
+        } else {
+            evaluator_release_code(w->retired[i]);
+            free_ast(w->retired[i]);
+        }
+    }
+    if (remaining < w->retired_count) {
+        for (int i = 0; i < w->count; i++) evaluator_forget_targets(w->segments[i].statements);
+    }
+    w->retired_count = remaining;
+    free(live.items);
+}
+
+// --- Finding Changes ---
+
+#define COMPARE_BLOCK 4096 // memcmp whole blocks, bytes only in the first that differs
+
+static size_t common_prefix(const char *a, const char *b, size_t max) {
+    size_t n = 0;
+    while (n + COMPARE_BLOCK <= max && memcmp(a + n, b + n, COMPARE_BLOCK) == 0) n += COMPARE_BLOCK;
+    while (n < max && a[n] == b[n]) n++;
+    return n;
+}
+
+static size_t common_suffix(const char *a, size_t a_length, const char *b, size_t b_length, size_t max) {
+    const char *a_end = a + a_length, *b_end = b + b_length;
+    size_t n = 0;
+    while (n + COMPARE_BLOCK <= max &&
+           memcmp(a_end - n - COMPARE_BLOCK, b_end - n - COMPARE_BLOCK, COMPARE_BLOCK) == 0) {
+        n += COMPARE_BLOCK;
+    }
+    while (n < max && a_end[-(ptrdiff_t)n - 1] == b_end[-(ptrdiff_t)n - 1]) n++;
+    return n;
+}
+
+static size_t count_byte(const char *text, size_t length, char c) {
+    size_t count = 0;
+    for (const char *p = text, *end = text + length; (p = memchr(p, c, end - p)); p++) count++;
+    return count;
+}
+
+// Splits 'source' into segment spans, scanning only what lies between the
+// parts it shares with the previous source. The first *front and last
+// *back old segments lie wholly in those parts, with a byte to spare on
+// the changed side so no token of theirs can have grown, and are left out
+// of 'spans'. The lexer's state where the rescan ends depends only on the
+// block depth and on being inside a string or not (there are no comments),
+// so when the rescanned text opens no block and keeps the quote parity the
+// old split points after it still hold. Otherwise everything is rescanned.
+static int split_changes(const Watch *w, const char *source, size_t length,
+                         SourceSpan **spans, int *front, int *back) {
+    *front = *back = 0;
+    size_t from = 0, to = length;
+    if (w->count > 0) {
+        size_t max = w->length < length ? w->length : length;
+        size_t prefix = common_prefix(w->source, source, max);
+        size_t suffix = common_suffix(w->source, w->length, source, length, max - prefix);
+
+        int f = 0, b = 0;
+        while (f < w->count &&
+               (size_t)(w->segments[f].span.start - w->source) + w->segments[f].span.length < prefix) {
+            f++;
+        }
+        while (b < w->count - f &&
+               (size_t)(w->segments[w->count - 1 - b].span.start - w->source) > w->length - suffix) {
+            b++;
+        }
+        size_t old_from = f > 0 ? (size_t)(w->segments[f - 1].span.start - w->source) + w->segments[f - 1].span.length : 0;
+        size_t old_to = b > 0 ? (size_t)(w->segments[w->count - b].span.start - w->source) : w->length;
+        size_t new_to = old_to + length - w->length;
+
+        if (count_byte(w->source + old_from, old_to - old_from, '"') % 2 ==
+                count_byte(source + old_from, new_to - old_from, '"') % 2 &&
+            open_blocks(source + old_from, new_to - old_from) == 0) {
+            *front = f;
+            *back = b;
+            from = old_from;
+            to = new_to;
+        }
+    }
+
+    if (from == to && w->count > 0) {
+        *spans = NULL; // Only whole segments went
+        return 0;
+    }
+    int count = parser_split(source + from, to - from, 0, spans);
+    int base_line = (int)count_byte(source, from, '\n');
+    for (int i = 0; i < count; i++) (*spans)[i].line += base_line;
+    return count;
+}
+
+// Spans start where the previous statement's last token ended, so the
+// whitespace around a statement moves between spans as lines are added
+static void trim(Segment *s) {
+    const char *start = s->span.start, *end = s->span.start + s->span.length;
+    while (start < end && isspace((unsigned char)*start)) start++;
+    while (end > start && isspace((unsigned char)end[-1])) end--;
+    s->text = start;
+    s->length = (size_t)(end - start);
+}
+
+static int compare_hashes(const void *a, const void *b) {
+    uint64_t x = ((const Segment*)a)->hash, y = ((const Segment*)b)->hash;
+    return x < y ? -1 : x > y;
+}
+
+// The unused old segment with the same text, if any. 'sorted' is the old
+// segments ordered by hash.
+static Segment* find_old(Segment *sorted, int count, const Segment *s) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (sorted[mid].hash < s->hash) lo = mid + 1;
+        else hi = mid;
+    }
+    for (int i = lo; i < count && sorted[i].hash == s->hash; i++) {
+        Segment *old = &sorted[i];
+        if (!old->reused && old->length == s->length && memcmp(old->text, s->text, s->length) == 0) {
+            return old;
+        }
+    }
+    return NULL;
+}
+
+// Moves an unchanged old segment to the same bytes at 'shift' in 'source'
+static Segment rebase(const Watch *w, const Segment *old, const char *source, ptrdiff_t shift) {
+    Segment s = *old;
+    s.span.start = source + (old->span.start - w->source) + shift;
+    s.text = source + (old->text - w->source) + shift;
+    s.reused = 1;
+    s.ran = 0;
+    return s;
+}
+
+// --- Reloading ---
+
+// Brings the watch to 'source' (taking it over) and runs it. Returns 0 and
+// frees 'source' when it has a syntax error.
+static int reload(Watch *w, char *source, int *parsed_out, int *skipped_out) {
+    size_t length = strlen(source);
+    SourceSpan *spans;
+    int front, back;
+    int middle = split_changes(w, source, length, &spans, &front, &back);
+    int count = front + middle + back;
+    Segment *segments = calloc(count, sizeof(Segment));
+    for (int i = 0; i < front; i++) segments[i] = rebase(w, &w->segments[i], source, 0);
+    for (int i = 0; i < back; i++) {
+        segments[count - back + i] = rebase(w, &w->segments[w->count - back + i], source,
+                                            (ptrdiff_t)length - (ptrdiff_t)w->length);
+    }
+
+    // The rest is matched by text; 'reused' marks taken old segments
+    int old_count = w->count - front - back;
+    Segment *sorted = malloc(sizeof(Segment) * (old_count > 0 ? old_count : 1));
+    if (old_count > 0) memcpy(sorted, w->segments + front, sizeof(Segment) * old_count);
+    qsort(sorted, old_count, sizeof(Segment), compare_hashes);
+    for (int i = 0; i < old_count; i++) sorted[i].reused = 0;
+
+    int parsed = 0;
+    int ok = 1;
+    for (int i = 0; i < middle; i++) {
+        Segment *s = &segments[front + i];
+        s->span = spans[i];
+        trim(s);
+        s->hash = text_hash(s->text, s->length);
+        Segment *old = find_old(sorted, old_count, s);
+        if (old) {
+            old->reused = 1;
+            s->statements = old->statements;
+            s->tail = old->tail;
+            s->bound = old->bound;
+            s->reused = 1;
+            continue;
+        }
+        if (!parse_statements(s->span.start, s->span.length, s->span.line, &s->statements)) {
+            ok = 0; // Keep going: every changed statement gets reported
+            continue;
+        }
+        parsed++;
+        for (s->tail = s->statements; s->tail && s->tail->next; s->tail = s->tail->next);
+    }
+    free(spans);
+
+    if (!ok) {
+        for (int i = front; i < front + middle; i++) {
+            if (!segments[i].reused && segments[i].statements) free_ast(segments[i].statements);
+        }
+        free(segments);
+        free(sorted);
+        free(source);
+        return 0;
+    }
+
+    for (int i = 0; i < old_count; i++) {
+        if (!sorted[i].reused) retire(w, sorted[i].statements);
+    }
+    free(sorted);
+    free(w->segments);
+    free(w->source);
+    w->source = source;
+    w->length = length;
+    w->segments = segments;
+    w->count = count;
+
+    NameTable before = w->names;
+    NameTable now = {NULL, 0, 0};
+    for (int i = 0; i < count; i++) name_table_collect(&now, segments[i].statements);
+    name_table_finish(&now);
+
+    find_kept(segments, count, &before, &now);
+    unbind_previous(segments, count, &before);
+    free_unreferenced(w);
+
+    // Chain what has to run; segment tails are relinked for the duration
+    ASTNode *run = NULL;
+    ASTNode *run_tail = NULL;
+    int skipped = 0;
+    for (int i = 0; i < count; i++) {
+        Segment *s = &segments[i];
+        if (!s->statements) continue;
+        if (s->kept) {
+            skipped++;
+            continue;
+        }
+        s->ran = 1;
+        if (run) run_tail->next = s->statements;
+        else run = s->statements;
+        run_tail = s->tail;
+    }
+    free(before.items);
+    w->names = now;
+
+    run_statements(run);
+
+    int cut = 0; // Past a top-level 'kembali' nothing ran
+    for (int i = 0; i < count; i++) {
+        Segment *s = &segments[i];
+        if (s->tail) s->tail->next = NULL;
+        if (s->ran) s->bound = !cut;
+        if (has_return(s)) cut = 1;
+    }
+    *parsed_out = parsed;
+    *skipped_out = skipped;
+    return 1;
+}
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void on_interrupt(int sig) {
+    (void)sig;
+    interrupted = 1;
+}
+
+// Sleeps until the file's size or modification time differ from 'seen',
+// or an interrupt. Runs of the program keep the default handler, so a
+// program stuck in a loop can still be stopped.
+static int wait_for_change(const char *path, struct stat *seen) {
+    struct sigaction action, saved;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_interrupt;
+    sigaction(SIGINT, &action, &saved);
+
+    int changed = 0;
+    while (!interrupted && !changed) {
+        struct timespec pause = {0, WATCH_POLL_MS * 1000000L};
+        nanosleep(&pause, NULL);
+        struct stat st;
+        if (stat(path, &st) != 0) continue; // Mid-save by an editor
+        changed = st.st_size != seen->st_size ||
+                  st.st_mtim.tv_sec != seen->st_mtim.tv_sec ||
+                  st.st_mtim.tv_nsec != seen->st_mtim.tv_nsec;
+    }
+    sigaction(SIGINT, &saved, NULL);
+    return changed;
+}
+
+int watch_run(const char *path) {
+    Watch w = {NULL, 0, NULL, 0, {NULL, 0, 0}, NULL, 0, 0};
+    struct stat seen;
+    char *source = load_source(path, &seen);
+    if (!source) return 1;
+
+    int parsed, skipped;
+    if (!reload(&w, source, &parsed, &skipped)) {
+        fprintf(stderr, "--- Menunggu perubahan pada %s ---\n", path);
+    }
+
+    while (wait_for_change(path, &seen)) {
+        struct stat st;
+        source = load_source(path, &st);
+        if (!source) continue;
+        seen = st;
+
+        double start = now_ms();
+        if (reload(&w, source, &parsed, &skipped)) {
+            fprintf(stderr, "--- Dimuat ulang: %d bagian diparse, %d fungsi tetap (%.1f ms) ---\n",
+                    parsed, skipped, now_ms() - start);
+        } else {
+            fprintf(stderr, "--- Galat sintaks, versi sebelumnya tetap dipakai ---\n");
+        }
+    }
+
+    for (int i = 0; i < w.count; i++) retire(&w, w.segments[i].statements);
+    for (int i = 0; i < w.retired_count; i++) free_ast(w.retired[i]);
+    free(w.retired);
+    free(w.segments);
+    free(w.names.items);
+    free(w.source);
+    return 0;
+}
+
+// --- REPL ---
+
+// Only calls and binary expressions run as statements; at the prompt any
+// other expression, and a binary one, is there to be looked at
+static ASTNode* show_values(ASTNode *stmts) {
+    NodeList out = {NULL, NULL};
+    for (ASTNode *n = stmts, *next; n; n = next) {
+        next = n->next;
+        n->next = NULL;
+        switch (n->type) {
+            case NODE_LITERAL: case NODE_VAR_ACCESS: case NODE_BINARY_EXPR:
+            case NODE_LIST: case NODE_MAP: case NODE_INDEX: case NODE_INTERP:
+                node_list_push(&out, new_print(n));
+                break;
+            default:
+                node_list_push(&out, n);
+                break;
+        }
+    }
+    return out.head;
+}
+
+void repl_run(void) {
+    int interactive = isatty(STDIN_FILENO);
+    char **entries = NULL;     // Sources stay alive with their ASTs
+    ASTNode *kept = NULL;      // Every entry's statements, chained
+    ASTNode **kept_tail = &kept;
+    int entry_count = 0;
+
+    char *pending = NULL;
+    size_t pending_length = 0;
+    int line = 1;       // Of the next entry's first line
+    int pending_lines = 0;
+    char buffer[4096];
+
+    for (;;) {
+        if (interactive) {
+            fputs(pending ? "...... " : "morph> ", stdout);
+            fflush(stdout);
+        }
+        if (!fgets(buffer, sizeof(buffer), stdin)) break;
+
+        size_t n = strlen(buffer);
+        pending = realloc(pending, pending_length + n + 1);
+        memcpy(pending + pending_length, buffer, n + 1);
+        pending_length += n;
+        if (n > 0 && buffer[n - 1] == '\n') pending_lines++;
+        else if (!feof(stdin)) continue; // The rest of a long line
+
+        if (open_blocks(pending, pending_length) > 0) continue;
+
+        ASTNode *stmts;
+        if (parse_statements(pending, pending_length, line, &stmts) && stmts) {
+            stmts = show_values(stmts);
+            run_statements(stmts);
+            entries = realloc(entries, sizeof(char*) * (entry_count + 1));
+            entries[entry_count++] = pending;
+            *kept_tail = stmts;
+            while (*kept_tail) kept_tail = &(*kept_tail)->next;
+        } else {
+            free(pending);
+        }
+        pending = NULL;
+        pending_length = 0;
+        line += pending_lines;
+        pending_lines = 0;
+    }
+    if (interactive) putchar('\n');
+
+    if (kept) free_ast(kept);
+    for (int i = 0; i < entry_count; i++) free(entries[i]);
+    free(entries);
+    free(pending);
+}
@@ -0,0 +1,128 @@
+#include <stdlib.h>
+#include <string.h>
+#include "resolve.h"
+
+// One per function body being resolved; top-level code has none
+typedef struct FnScope {
+    FuncDeclNode *decl;
+    struct FnScope *parent;
+    NameSet locals;
+    NameSet bound; // Locals certainly bound at the node being visited
+    NameSet captures;
+} FnScope;
+
+// A name 's' may read before binding it itself, or never binds, is
+// captured if some enclosing function binds it: until its own 'biar' runs
+// the read sees the enclosing value (biar n = n + 1)
+static void use(FnScope *s, const char *name) {
+    if (!s || name_set_has(&s->bound, name) || name_set_has(&s->captures, name)) return;
+    for (FnScope *outer = s->parent; outer; outer = outer->parent) {
+        if (name_set_has(&outer->locals, name)) {
+            name_set_add(&s->captures, name);
+            return;
+        }
+    }
+}
+
+static void visit(FnScope *s, ASTNode *node);
+
+static void visit_list(FnScope *s, ASTNode *head) {
+    for (ASTNode *n = head; n; n = n->next) visit(s, n);
+}
+
+// Statements in order, each binding counting for the ones after it. A block
+// may not run at all, so what it binds no longer counts after it.
+static void visit_block(FnScope *s, ASTNode *stmts) {
+    int bound = s ? s->bound.count : 0;
+    for (ASTNode *n = stmts; n; n = n->next) {
+        visit(s, n);
+        if (!s) continue;
+        if (n->type == NODE_VAR_DECL) name_set_add(&s->bound, ((VarDeclNode*)n)->name);
+        else if (n->type == NODE_FUNC_DECL) name_set_add(&s->bound, ((FuncDeclNode*)n)->name);
+    }
+    if (s) s->bound.count = bound;
+}
+
+static void resolve_function_in(FnScope *parent, FuncDeclNode *f) {
+    if (!f->body) return; // Lazy: resolved once parsed
+    FnScope scope = {f, parent, {NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}};
+    for (ASTNode *p = f->params; p; p = p->next) {
+        name_set_add(&scope.locals, ((VarAccessNode*)p)->name);
+        name_set_add(&scope.bound, ((VarAccessNode*)p)->name);
+    }
+    name_set_collect(&scope.locals, ((BlockNode*)f->body)->statements);
+    visit(&scope, f->body);
+
+    for (int i = 0; i < f->capture_count; i++) free(f->captures[i]);
+    free(f->captures);
+    f->captures = NULL;
+    f->capture_count = scope.captures.count;
+    if (scope.captures.count > 0) {
+        f->captures = malloc(sizeof(char*) * scope.captures.count);
+        for (int i = 0; i < scope.captures.count; i++) {
+            f->captures[i] = strdup(scope.captures.items[i]);
+            use(parent, scope.captures.items[i]); // The parent must hold it to copy it
+        }
+    }
+    free(scope.locals.items);
+    free(scope.bound.items);
+    free(scope.captures.items);
+}
+
+static void visit(FnScope *s, ASTNode *node) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_PROGRAM: visit_list(s, ((ProgramNode*)node)->statements); break;
+        case NODE_BLOCK: visit_block(s, ((BlockNode*)node)->statements); break;
+        case NODE_VAR_DECL: visit(s, ((VarDeclNode*)node)->value); break;
+        case NODE_PRINT: visit(s, ((PrintNode*)node)->expression); break;
+        case NODE_IF:
+            visit(s, ((IfNode*)node)->condition);
+            visit(s, ((IfNode*)node)->then_branch);
+            break;
+        case NODE_REPEAT: {
+            RepeatNode *r = (RepeatNode*)node;
+            visit(s, r->start);
+            visit(s, r->end);
+            int bound = s ? s->bound.count : 0;
+            if (s) name_set_add(&s->bound, r->var_name); // Within the body only
+            visit(s, r->body);
+            if (s) s->bound.count = bound;
+            break;
+        }
+        case NODE_WHILE:
+            visit(s, ((WhileNode*)node)->condition);
+            visit(s, ((WhileNode*)node)->body);
+            break;
+        case NODE_LITERAL: break;
+        case NODE_VAR_ACCESS: use(s, ((VarAccessNode*)node)->name); break;
+        case NODE_BINARY_EXPR:
+            visit(s, ((BinaryExprNode*)node)->left);
+            visit(s, ((BinaryExprNode*)node)->right);
+            break;
+        case NODE_CALL_EXPR:
+            use(s, ((CallExprNode*)node)->callee);
+            visit_list(s, ((CallExprNode*)node)->arguments);
+            break;
+        case NODE_LIST: visit_list(s, ((ListNode*)node)->elements); break;
+        case NODE_MAP:
+            visit_list(s, ((MapNode*)node)->keys);
+            visit_list(s, ((MapNode*)node)->values);
+            break;
+        case NODE_INDEX:
+            visit(s, ((IndexNode*)node)->target);
+            visit(s, ((IndexNode*)node)->index);
+            break;
+        case NODE_INTERP: visit_list(s, ((InterpNode*)node)->parts); break;
+        case NODE_FUNC_DECL: resolve_function_in(s, (FuncDeclNode*)node); break;
+        case NODE_RETURN: visit(s, ((ReturnNode*)node)->value); break;
+    }
+}
+
+void resolve_program(ASTNode *program) {
+    visit(NULL, program);
+}
+
+void resolve_function(FuncDeclNode *decl) {
+    resolve_function_in(NULL, decl);
+}
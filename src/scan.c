@@ -0,0 +1,334 @@
+#include <string.h>
+#include "scan.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define SCAN_X86 1
+#endif
+
+// --- Scalar ---
+
+static int is_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r'); // Same set as isspace() in the C locale
+}
+
+static int is_ident(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static size_t whitespace_scalar(const char *src, size_t pos, size_t len, int *lines) {
+    while (pos < len && is_space((unsigned char)src[pos])) {
+        if (src[pos] == '\n') (*lines)++;
+        pos++;
+    }
+    return pos;
+}
+
+static size_t identifier_scalar(const char *src, size_t pos, size_t len) {
+    while (pos < len && is_ident((unsigned char)src[pos])) pos++;
+    return pos;
+}
+
+static size_t string_scalar(const char *src, size_t pos, size_t len, int *lines) {
+    while (pos < len && src[pos] != '"') {
+        if (src[pos] == '\n') (*lines)++;
+        pos++;
+    }
+    return pos;
+}
+
+static size_t digits_scalar(const char *src, size_t pos, size_t len) {
+    while (pos < len && src[pos] >= '0' && src[pos] <= '9') pos++;
+    return pos;
+}
+
+static size_t find_scalar(const char *src, size_t pos, size_t len, const char *needle, size_t n) {
+    while (pos + n <= len) {
+        const char *hit = memchr(src + pos, needle[0], len - n + 1 - pos);
+        if (!hit) break;
+        pos = (size_t)(hit - src);
+        if (memcmp(src + pos + 1, needle + 1, n - 1) == 0) return pos;
+        pos++;
+    }
+    return len;
+}
+
+static unsigned char fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+static int equal_fold_scalar(const char *a, const char *b, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (fold((unsigned char)a[i]) != fold((unsigned char)b[i])) return 0;
+    }
+    return 1;
+}
+
+#ifdef SCAN_X86
+
+// --- SSE2 (baseline on x86-64), 16 bytes per step ---
+// Byte classes are built from equality tests and unsigned range tests:
+// x in [lo, hi]  <=>  min(x - lo, hi - lo) == x - lo  (unsigned bytes).
+
+static inline __m128i in_range16(__m128i x, char lo, char hi) {
+    __m128i shifted = _mm_sub_epi8(x, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8((char)(hi - lo))), shifted);
+}
+
+static inline __m128i space16(__m128i x) {
+    return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), in_range16(x, '\t', '\r'));
+}
+
+static inline __m128i ident16(__m128i x) {
+    __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20)); // Folds A-Z onto a-z
+    __m128i alpha = in_range16(lower, 'a', 'z');
+    __m128i digit = in_range16(x, '0', '9');
+    __m128i under = _mm_cmpeq_epi8(x, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(alpha, digit), under);
+}
+
+static size_t whitespace_sse2(const char *src, size_t pos, size_t len, int *lines) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    while (pos + 16 <= len) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + pos));
+        unsigned stop = ~_mm_movemask_epi8(space16(x)) & 0xFFFF;
+        unsigned newlines = _mm_movemask_epi8(_mm_cmpeq_epi8(x, nl));
+        if (stop) {
+            int i = __builtin_ctz(stop);
+            *lines += __builtin_popcount(newlines & ((1u << i) - 1));
+            return pos + i;
+        }
+        *lines += __builtin_popcount(newlines);
+        pos += 16;
+    }
+    return whitespace_scalar(src, pos, len, lines);
+}
+
+static size_t identifier_sse2(const char *src, size_t pos, size_t len) {
+    while (pos + 16 <= len) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + pos));
+        unsigned stop = ~_mm_movemask_epi8(ident16(x)) & 0xFFFF;
+        if (stop) return pos + __builtin_ctz(stop);
+        pos += 16;
+    }
+    return identifier_scalar(src, pos, len);
+}
+
+static size_t string_sse2(const char *src, size_t pos, size_t len, int *lines) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i nl = _mm_set1_epi8('\n');
+    while (pos + 16 <= len) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + pos));
+        unsigned stop = _mm_movemask_epi8(_mm_cmpeq_epi8(x, quote));
+        unsigned newlines = _mm_movemask_epi8(_mm_cmpeq_epi8(x, nl));
+        if (stop) {
+            int i = __builtin_ctz(stop);
+            *lines += __builtin_popcount(newlines & ((1u << i) - 1));
+            return pos + i;
+        }
+        *lines += __builtin_popcount(newlines);
+        pos += 16;
+    }
+    return string_scalar(src, pos, len, lines);
+}
+
+static size_t digits_sse2(const char *src, size_t pos, size_t len) {
+    while (pos + 16 <= len) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + pos));
+        unsigned stop = ~_mm_movemask_epi8(in_range16(x, '0', '9')) & 0xFFFF;
+        if (stop) return pos + __builtin_ctz(stop);
+        pos += 16;
+    }
+    return digits_scalar(src, pos, len);
+}
+
+// Candidates are where both the needle's first and last byte match, 16 start
+// positions per step; only those are compared in full
+static size_t find_sse2(const char *src, size_t pos, size_t len, const char *needle, size_t n) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[n - 1]);
+    while (pos + n - 1 + 16 <= len) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + pos));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + pos + n - 1));
+        unsigned candidates = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (candidates) {
+            int i = __builtin_ctz(candidates);
+            if (n <= 2 || memcmp(src + pos + i + 1, needle + 1, n - 2) == 0) return pos + i;
+            candidates &= candidates - 1;
+        }
+        pos += 16;
+    }
+    return find_scalar(src, pos, len, needle, n);
+}
+
+static inline __m128i fold16(__m128i x) {
+    return _mm_or_si128(x, _mm_and_si128(in_range16(x, 'A', 'Z'), _mm_set1_epi8(0x20)));
+}
+
+static int equal_fold_sse2(const char *a, const char *b, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = fold16(_mm_loadu_si128((const __m128i*)(a + i)));
+        __m128i y = fold16(_mm_loadu_si128((const __m128i*)(b + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF) return 0;
+    }
+    return equal_fold_scalar(a + i, b + i, len - i);
+}
+
+// --- AVX2, 32 bytes per step, selected at runtime ---
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline __m256i in_range32(__m256i x, char lo, char hi) {
+    __m256i shifted = _mm256_sub_epi8(x, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8((char)(hi - lo))), shifted);
+}
+
+AVX2 static size_t whitespace_avx2(const char *src, size_t pos, size_t len, int *lines) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    const __m256i sp = _mm256_set1_epi8(' ');
+    while (pos + 32 <= len) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(src + pos));
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(x, sp), in_range32(x, '\t', '\r'));
+        unsigned stop = ~(unsigned)_mm256_movemask_epi8(space);
+        unsigned newlines = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, nl));
+        if (stop) {
+            int i = __builtin_ctz(stop);
+            *lines += __builtin_popcount(i ? newlines & (0xFFFFFFFFu >> (32 - i)) : 0);
+            return pos + i;
+        }
+        *lines += __builtin_popcount(newlines);
+        pos += 32;
+    }
+    return whitespace_sse2(src, pos, len, lines);
+}
+
+AVX2 static size_t identifier_avx2(const char *src, size_t pos, size_t len) {
+    while (pos + 32 <= len) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(src + pos));
+        __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        __m256i ident = _mm256_or_si256(
+            _mm256_or_si256(in_range32(lower, 'a', 'z'), in_range32(x, '0', '9')),
+            _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')));
+        unsigned stop = ~(unsigned)_mm256_movemask_epi8(ident);
+        if (stop) return pos + __builtin_ctz(stop);
+        pos += 32;
+    }
+    return identifier_sse2(src, pos, len);
+}
+
+AVX2 static size_t string_avx2(const char *src, size_t pos, size_t len, int *lines) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i nl = _mm256_set1_epi8('\n');
+    while (pos + 32 <= len) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(src + pos));
+        unsigned stop = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, quote));
+        unsigned newlines = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, nl));
+        if (stop) {
+            int i = __builtin_ctz(stop);
+            *lines += __builtin_popcount(i ? newlines & (0xFFFFFFFFu >> (32 - i)) : 0);
+            return pos + i;
+        }
+        *lines += __builtin_popcount(newlines);
+        pos += 32;
+    }
+    return string_sse2(src, pos, len, lines);
+}
+
+AVX2 static size_t find_avx2(const char *src, size_t pos, size_t len, const char *needle, size_t n) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[n - 1]);
+    while (pos + n - 1 + 32 <= len) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(src + pos));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + pos + n - 1));
+        unsigned candidates = _mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+        while (candidates) {
+            int i = __builtin_ctz(candidates);
+            if (n <= 2 || memcmp(src + pos + i + 1, needle + 1, n - 2) == 0) return pos + i;
+            candidates &= candidates - 1;
+        }
+        pos += 32;
+    }
+    return find_sse2(src, pos, len, needle, n);
+}
+
+AVX2 static int equal_fold_avx2(const char *a, const char *b, size_t len) {
+    const __m256i bit = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        x = _mm256_or_si256(x, _mm256_and_si256(in_range32(x, 'A', 'Z'), bit));
+        y = _mm256_or_si256(y, _mm256_and_si256(in_range32(y, 'A', 'Z'), bit));
+        if ((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) != 0xFFFFFFFFu) return 0;
+    }
+    return equal_fold_sse2(a + i, b + i, len - i);
+}
+
+#endif // SCAN_X86
+
+// --- Dispatch ---
+
+typedef size_t (*CountingScan)(const char*, size_t, size_t, int*);
+typedef size_t (*PlainScan)(const char*, size_t, size_t);
+typedef size_t (*FindScan)(const char*, size_t, size_t, const char*, size_t);
+typedef int (*EqualScan)(const char*, const char*, size_t);
+
+#ifdef SCAN_X86
+static CountingScan whitespace_impl = whitespace_sse2;
+static PlainScan identifier_impl = identifier_sse2;
+static CountingScan string_impl = string_sse2;
+static PlainScan digits_impl = digits_sse2;
+static FindScan find_impl = find_sse2;
+static EqualScan equal_fold_impl = equal_fold_sse2;
+#else
+static CountingScan whitespace_impl = whitespace_scalar;
+static PlainScan identifier_impl = identifier_scalar;
+static CountingScan string_impl = string_scalar;
+static PlainScan digits_impl = digits_scalar;
+static FindScan find_impl = find_scalar;
+static EqualScan equal_fold_impl = equal_fold_scalar;
+#endif
+
+void scan_init(void) {
+#ifdef SCAN_X86
+    static int initialized = 0;
+    if (initialized) return;
+    initialized = 1;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        whitespace_impl = whitespace_avx2;
+        identifier_impl = identifier_avx2;
+        string_impl = string_avx2;
+        find_impl = find_avx2;
+        equal_fold_impl = equal_fold_avx2;
+    }
+#endif
+}
+
+size_t scan_whitespace(const char *src, size_t pos, size_t len, int *lines) {
+    return whitespace_impl(src, pos, len, lines);
+}
+
+size_t scan_identifier(const char *src, size_t pos, size_t len) {
+    return identifier_impl(src, pos, len);
+}
+
+size_t scan_string_body(const char *src, size_t pos, size_t len, int *lines) {
+    return string_impl(src, pos, len, lines);
+}
+
+size_t scan_digits(const char *src, size_t pos, size_t len) {
+    return digits_impl(src, pos, len);
+}
+
+size_t scan_find(const char *src, size_t pos, size_t len, const char *needle, size_t n) {
+    if (n == 0) return pos <= len ? pos : len;
+    if (n > len || pos > len - n) return len;
+    return find_impl(src, pos, len, needle, n);
+}
+
+int scan_equal_fold(const char *a, const char *b, size_t len) {
+    return equal_fold_impl(a, b, len);
+}
@@ -0,0 +1,755 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+#include "parser.h"
+#include "gc.h"
+#include "map.h"
+#include "builtins.h"
+
+// Image layout (native byte order, the image is tied to the build that wrote it):
+//   header    magic, version, TOKEN_UNKNOWN, counts and section offsets
+//   functions name, params, captures, body size, encoded body
+//   objects   lists, maps and closures; values inside refer to objects and functions by id
+//   entries   global name + value
+// Strings are a u32 length followed by the bytes and a NUL, so the loader
+// can hand them to the AST constructors straight from the mapping.
+
+#define IMAGE_MAGIC "MORPHIMG"
+#define IMAGE_VERSION 4
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t token_count;  // Operators are stored as TokenType values
+    uint32_t function_count;
+    uint32_t object_count;
+    uint32_t entry_count;
+    uint32_t functions_offset;
+    uint32_t objects_offset;
+    uint32_t entries_offset;
+} ImageHeader;
+
+enum { TAG_NUMBER, TAG_STRING, TAG_LIST, TAG_MAP, TAG_FUNCTION, TAG_NATIVE, TAG_NULL, TAG_CLOSURE,
+       TAG_DECIMAL };
+
+enum { LITERAL_NUMBER, LITERAL_STRING, LITERAL_DECIMAL };
+enum { OBJ_KIND_LIST, OBJ_KIND_MAP, OBJ_KIND_CLOSURE };
+#define NODE_NONE 0xFF
+
+// --- Writing ---
+
+typedef struct {
+    unsigned char *data;
+    size_t length;
+    size_t capacity;
+} Buf;
+
+static void put_bytes(Buf *b, const void *bytes, size_t n) {
+    if (b->length + n > b->capacity) {
+        b->capacity = b->capacity ? b->capacity * 2 : 4096;
+        while (b->capacity < b->length + n) b->capacity *= 2;
+        b->data = realloc(b->data, b->capacity);
+    }
+    memcpy(b->data + b->length, bytes, n);
+    b->length += n;
+}
+
+static void put_u8(Buf *b, uint8_t v) { put_bytes(b, &v, 1); }
+static void put_u32(Buf *b, uint32_t v) { put_bytes(b, &v, 4); }
+static void put_i64(Buf *b, int64_t v) { put_bytes(b, &v, 8); }
+static void put_f64(Buf *b, double v) { put_bytes(b, &v, 8); }
+
+static void put_str(Buf *b, const char *chars, size_t length) {
+    put_u32(b, (uint32_t)length);
+    put_bytes(b, chars, length);
+    put_u8(b, 0);
+}
+
+static void put_cstr(Buf *b, const char *s) {
+    put_str(b, s, strlen(s));
+}
+
+// Pointer -> id, so shared and cyclic objects are written once
+typedef struct {
+    const void **keys;
+    uint32_t *ids;
+    size_t capacity;
+    const void **order; // By id
+    uint32_t count;
+} IdTable;
+
+static size_t ptr_slot(IdTable *t, const void *p) {
+    size_t mask = t->capacity - 1;
+    size_t i = ((uintptr_t)p >> 4) * 0x9E3779B97F4A7C15ull & mask;
+    while (t->keys[i] && t->keys[i] != p) i = (i + 1) & mask;
+    return i;
+}
+
+// Returns the id of p, assigning the next one on first sight
+static uint32_t intern(IdTable *t, const void *p) {
+    if ((t->count + 1) * 2 > t->capacity) {
+        IdTable old = *t;
+        t->capacity = old.capacity ? old.capacity * 2 : 64;
+        t->keys = calloc(t->capacity, sizeof(void*));
+        t->ids = malloc(sizeof(uint32_t) * t->capacity);
+        for (size_t i = 0; i < old.capacity; i++) {
+            if (!old.keys[i]) continue;
+            size_t s = ptr_slot(t, old.keys[i]);
+            t->keys[s] = old.keys[i];
+            t->ids[s] = old.ids[i];
+        }
+        free(old.keys);
+        free(old.ids);
+        t->order = realloc(t->order, sizeof(void*) * t->capacity);
+    }
+    size_t s = ptr_slot(t, p);
+    if (t->keys[s]) return t->ids[s];
+    t->keys[s] = p;
+    t->ids[s] = t->count;
+    t->order[t->count] = p;
+    return t->count++;
+}
+
+static void free_table(IdTable *t) {
+    free(t->keys);
+    free(t->ids);
+    free(t->order);
+}
+
+static IdTable objects_seen;
+static IdTable functions_seen;
+static int readers_dropped;
+
+static void put_value(Buf *b, Value v) {
+    switch (v.type) {
+        case VAL_NUMBER:
+            put_u8(b, TAG_NUMBER);
+            put_i64(b, v.as.number);
+            break;
+        case VAL_DECIMAL:
+            put_u8(b, TAG_DECIMAL);
+            put_f64(b, v.as.decimal);
+            break;
+        case VAL_STRING:
+            put_u8(b, TAG_STRING);
+            put_str(b, string_chars(&v), string_length(&v));
+            break;
+        case VAL_LIST:
+            put_u8(b, TAG_LIST);
+            put_u32(b, intern(&objects_seen, v.as.list));
+            break;
+        case VAL_MAP:
+            put_u8(b, TAG_MAP);
+            put_u32(b, intern(&objects_seen, v.as.map));
+            break;
+        case VAL_FUNCTION:
+            put_u8(b, TAG_FUNCTION);
+            put_u32(b, intern(&functions_seen, v.as.function.declaration));
+            break;
+        case VAL_CLOSURE:
+            put_u8(b, TAG_CLOSURE);
+            put_u32(b, intern(&objects_seen, v.as.closure));
+            break;
+        case VAL_NATIVE:
+            put_u8(b, TAG_NATIVE);
+            put_cstr(b, v.as.native->name);
+            break;
+        case VAL_READER:
+            readers_dropped++; // Open files do not survive the process
+            put_u8(b, TAG_NULL);
+            break;
+        case VAL_NULL:
+            put_u8(b, TAG_NULL);
+            break;
+    }
+}
+
+static void put_node(Buf *b, ASTNode *node);
+
+static void put_captures(Buf *b, const FuncDeclNode *f) {
+    put_u32(b, (uint32_t)f->capture_count);
+    for (int i = 0; i < f->capture_count; i++) put_cstr(b, f->captures[i]);
+}
+
+static void put_node_list(Buf *b, ASTNode *head) {
+    uint32_t count = 0;
+    for (ASTNode *n = head; n; n = n->next) count++;
+    put_u32(b, count);
+    for (ASTNode *n = head; n; n = n->next) put_node(b, n);
+}
+
+// Inference results are not stored: they only hold for the program that
+// was analysed, and later scripts may call these functions differently.
+static void put_node(Buf *b, ASTNode *node) {
+    if (!node) {
+        put_u8(b, NODE_NONE);
+        return;
+    }
+    put_u8(b, (uint8_t)node->type);
+    switch (node->type) {
+        case NODE_PROGRAM: put_node_list(b, ((ProgramNode*)node)->statements); break;
+        case NODE_BLOCK: put_node_list(b, ((BlockNode*)node)->statements); break;
+        case NODE_VAR_DECL:
+            put_cstr(b, ((VarDeclNode*)node)->name);
+            put_node(b, ((VarDeclNode*)node)->value);
+            break;
+        case NODE_PRINT: put_node(b, ((PrintNode*)node)->expression); break;
+        case NODE_IF:
+            put_node(b, ((IfNode*)node)->condition);
+            put_node(b, ((IfNode*)node)->then_branch);
+            break;
+        case NODE_REPEAT: {
+            RepeatNode *r = (RepeatNode*)node;
+            put_cstr(b, r->var_name);
+            put_node(b, r->start);
+            put_node(b, r->end);
+            put_node(b, r->body);
+            break;
+        }
+        case NODE_WHILE:
+            put_node(b, ((WhileNode*)node)->condition);
+            put_node(b, ((WhileNode*)node)->body);
+            break;
+        case NODE_LITERAL: {
+            LiteralNode *l = (LiteralNode*)node;
+            if (l->type == TOKEN_STRING) {
+                put_u8(b, LITERAL_STRING);
+                put_cstr(b, l->string_val);
+            } else if (l->type == TOKEN_DECIMAL) {
+                put_u8(b, LITERAL_DECIMAL);
+                put_f64(b, l->decimal_val);
+            } else {
+                put_u8(b, LITERAL_NUMBER);
+                put_i64(b, l->int_val);
+            }
+            break;
+        }
+        case NODE_VAR_ACCESS: put_cstr(b, ((VarAccessNode*)node)->name); break;
+        case NODE_BINARY_EXPR: {
+            BinaryExprNode *e = (BinaryExprNode*)node;
+            put_node(b, e->left);
+            put_u32(b, (uint32_t)e->op);
+            put_node(b, e->right);
+            break;
+        }
+        case NODE_CALL_EXPR:
+            put_cstr(b, ((CallExprNode*)node)->callee);
+            put_node_list(b, ((CallExprNode*)node)->arguments);
+            break;
+        case NODE_LIST: put_node_list(b, ((ListNode*)node)->elements); break;
+        case NODE_MAP:
+            put_node_list(b, ((MapNode*)node)->keys);
+            put_node_list(b, ((MapNode*)node)->values);
+            break;
+        case NODE_INDEX:
+            put_node(b, ((IndexNode*)node)->target);
+            put_node(b, ((IndexNode*)node)->index);
+            break;
+        case NODE_INTERP: put_node_list(b, ((InterpNode*)node)->parts); break;
+        case NODE_FUNC_DECL: {
+            FuncDeclNode *f = (FuncDeclNode*)node;
+            if (f->image_body) snapshot_materialize(f);
+            if (f->lazy_body) parser_materialize(f);
+            put_cstr(b, f->name);
+            put_node_list(b, f->params);
+            put_captures(b, f);
+            put_node(b, f->body);
+            break;
+        }
+        case NODE_RETURN: put_node(b, ((ReturnNode*)node)->value); break;
+    }
+}
+
+static void put_object(Buf *b, const Obj *obj) {
+    Buf payload = {NULL, 0, 0};
+    if (obj->type == OBJ_LIST) {
+        const ObjList *list = (const ObjList*)obj;
+        put_u8(&payload, OBJ_KIND_LIST);
+        put_u8(&payload, (uint8_t)list->numeric);
+        put_u32(&payload, (uint32_t)list->count);
+        for (int i = 0; i < list->count; i++) {
+            if (list->numeric) put_i64(&payload, list->as.numbers[i]);
+            else put_value(&payload, list->as.items[i]);
+        }
+    } else if (obj->type == OBJ_CLOSURE) {
+        const ObjClosure *closure = (const ObjClosure*)obj;
+        put_u8(&payload, OBJ_KIND_CLOSURE);
+        put_u32(&payload, (uint32_t)closure->count);
+        put_u32(&payload, intern(&functions_seen, closure->declaration));
+        for (int i = 0; i < closure->count; i++) put_value(&payload, closure->captured[i]);
+    } else {
+        const ObjMap *map = (const ObjMap*)obj;
+        put_u8(&payload, OBJ_KIND_MAP);
+        put_u32(&payload, (uint32_t)map->count);
+        for (int i = 0; i < map->entry_count; i++) {
+            if (map->entries[i].key.type == VAL_NULL) continue; // Deleted
+            put_value(&payload, map->entries[i].key);
+            put_value(&payload, map->entries[i].value);
+        }
+    }
+    // Sized, so the loader can create every object before filling any
+    put_u32(b, (uint32_t)payload.length);
+    put_bytes(b, payload.data, payload.length);
+    free(payload.data);
+}
+
+static void put_function(Buf *b, FuncDeclNode *f) {
+    if (f->image_body) snapshot_materialize(f);
+    if (f->lazy_body) parser_materialize(f);
+    put_cstr(b, f->name);
+    uint32_t count = 0;
+    for (ASTNode *p = f->params; p; p = p->next) count++;
+    put_u32(b, count);
+    for (ASTNode *p = f->params; p; p = p->next) put_cstr(b, ((VarAccessNode*)p)->name);
+    put_captures(b, f);
+
+    Buf body = {NULL, 0, 0};
+    put_node(&body, f->body);
+    put_u32(b, (uint32_t)body.length);
+    put_bytes(b, body.data, body.length);
+    free(body.data);
+}
+
+int snapshot_save(Environment *globals, const char *path) {
+    memset(&objects_seen, 0, sizeof(IdTable));
+    memset(&functions_seen, 0, sizeof(IdTable));
+    readers_dropped = 0;
+
+    // Oldest first: the loader pushes each entry on the head, so a shadowed
+    // binding ends up behind the one that shadows it, as it was here
+    size_t total = 0;
+    for (Entry *e = globals->head; e; e = e->next) total++;
+    Entry **order = malloc(sizeof(Entry*) * (total ? total : 1));
+    size_t n = total;
+    for (Entry *e = globals->head; e; e = e->next) order[--n] = e;
+
+    Buf entries = {NULL, 0, 0};
+    uint32_t entry_count = 0;
+    for (size_t i = 0; i < total; i++) {
+        Entry *e = order[i];
+        // Natives under their own name are installed by every run anyway
+        if (e->value.type == VAL_UNBOUND) continue;
+        if (e->value.type == VAL_NATIVE && strcmp(e->value.as.native->name, e->key) == 0) continue;
+        put_cstr(&entries, e->key);
+        put_value(&entries, e->value);
+        entry_count++;
+    }
+    free(order);
+
+    // Objects reached from other objects are appended to the table as we go
+    Buf objects = {NULL, 0, 0};
+    for (uint32_t i = 0; i < objects_seen.count; i++) {
+        put_object(&objects, (const Obj*)objects_seen.order[i]);
+    }
+
+    // Bodies can declare nested functions but never reference values
+    Buf functions = {NULL, 0, 0};
+    for (uint32_t i = 0; i < functions_seen.count; i++) {
+        put_function(&functions, (FuncDeclNode*)functions_seen.order[i]);
+    }
+
+    ImageHeader h;
+    memcpy(h.magic, IMAGE_MAGIC, 8);
+    h.version = IMAGE_VERSION;
+    h.token_count = TOKEN_UNKNOWN;
+    h.function_count = functions_seen.count;
+    h.object_count = objects_seen.count;
+    h.entry_count = entry_count;
+    h.functions_offset = sizeof(ImageHeader);
+    h.objects_offset = h.functions_offset + (uint32_t)functions.length;
+    h.entries_offset = h.objects_offset + (uint32_t)objects.length;
+
+    int status = 0;
+    FILE *out = fopen(path, "wb");
+    if (!out) {
+        fprintf(stderr, "Gagal membuka file: %s\n", path);
+        status = 1;
+    } else {
+        fwrite(&h, sizeof(h), 1, out);
+        fwrite(functions.data, 1, functions.length, out);
+        fwrite(objects.data, 1, objects.length, out);
+        fwrite(entries.data, 1, entries.length, out);
+        if (fclose(out) != 0) {
+            fprintf(stderr, "Gagal menulis image: %s\n", path);
+            status = 1;
+        }
+    }
+    if (readers_dropped) {
+        fprintf(stderr, "Peringatan: %d pembaca disimpan sebagai kosong di image.\n", readers_dropped);
+    }
+
+    free(functions.data);
+    free(objects.data);
+    free(entries.data);
+    free_table(&objects_seen);
+    free_table(&functions_seen);
+    return status;
+}
+
+// --- Reading ---
+
+typedef struct {
+    const unsigned char *p;
+    const unsigned char *end;
+    int bad; // Set on any out-of-bounds or malformed read
+} Cursor;
+
+static const unsigned char *image_base;
+static size_t image_size;
+static FuncDeclNode **loaded_functions;
+static uint32_t loaded_count;
+static Value *loaded_objects;
+static uint32_t object_count;
+
+static int need(Cursor *c, size_t n) {
+    if (c->bad || (size_t)(c->end - c->p) < n) {
+        c->bad = 1;
+        return 0;
+    }
+    return 1;
+}
+
+static uint8_t get_u8(Cursor *c) {
+    if (!need(c, 1)) return 0;
+    return *c->p++;
+}
+
+static uint32_t get_u32(Cursor *c) {
+    uint32_t v = 0;
+    if (!need(c, 4)) return 0;
+    memcpy(&v, c->p, 4);
+    c->p += 4;
+    return v;
+}
+
+static int64_t get_i64(Cursor *c) {
+    int64_t v = 0;
+    if (!need(c, 8)) return 0;
+    memcpy(&v, c->p, 8);
+    c->p += 8;
+    return v;
+}
+
+static double get_f64(Cursor *c) {
+    double v = 0;
+    if (!need(c, 8)) return 0;
+    memcpy(&v, c->p, 8);
+    c->p += 8;
+    return v;
+}
+
+// Points into the mapping; the bytes are NUL-terminated there
+static const char* get_str(Cursor *c, size_t *length) {
+    uint32_t n = get_u32(c);
+    if (!need(c, (size_t)n + 1) || c->p[n] != '\0') {
+        c->bad = 1;
+        if (length) *length = 0;
+        return "";
+    }
+    const char *s = (const char*)c->p;
+    c->p += n + 1;
+    if (length) *length = n;
+    return s;
+}
+
+static Value get_value(Cursor *c) {
+    switch (get_u8(c)) {
+        case TAG_NUMBER: return make_number(get_i64(c));
+        case TAG_DECIMAL: return make_decimal(get_f64(c));
+        case TAG_STRING: {
+            size_t length;
+            const char *s = get_str(c, &length);
+            return make_string_n(s, length); // Long strings go to the heap
+        }
+        case TAG_LIST:
+        case TAG_MAP:
+        case TAG_CLOSURE: {
+            uint32_t id = get_u32(c);
+            if (id >= object_count) break;
+            return loaded_objects[id];
+        }
+        case TAG_FUNCTION: {
+            uint32_t id = get_u32(c);
+            if (id >= loaded_count) break;
+            return make_function((ASTNode*)loaded_functions[id]);
+        }
+        case TAG_NATIVE: {
+            const NativeDef *def = native_lookup(get_str(c, NULL));
+            if (def) return make_native(def);
+            break;
+        }
+        case TAG_NULL:
+            return make_null();
+    }
+    c->bad = 1;
+    return make_null();
+}
+
+static ASTNode* get_node(Cursor *c);
+
+static void get_captures(Cursor *c, FuncDeclNode *f) {
+    uint32_t count = get_u32(c);
+    if (c->bad || count > (size_t)(c->end - c->p)) { // Every name takes at least 5 bytes
+        c->bad = 1;
+        return;
+    }
+    f->captures = count ? malloc(sizeof(char*) * count) : NULL;
+    for (uint32_t i = 0; i < count && !c->bad; i++) {
+        f->captures[f->capture_count++] = strdup(get_str(c, NULL));
+    }
+}
+
+static ASTNode* get_node_list(Cursor *c) {
+    uint32_t count = get_u32(c);
+    NodeList list = {NULL, NULL};
+    for (uint32_t i = 0; i < count && !c->bad; i++) node_list_push(&list, get_node(c));
+    return list.head;
+}
+
+static ASTNode* get_node(Cursor *c) {
+    uint8_t type = get_u8(c);
+    if (c->bad || type == NODE_NONE) return NULL;
+
+    switch (type) {
+        case NODE_PROGRAM: return new_program(get_node_list(c));
+        case NODE_BLOCK: return new_block(get_node_list(c));
+        case NODE_VAR_DECL: {
+            const char *name = get_str(c, NULL);
+            return new_var_decl(name, get_node(c));
+        }
+        case NODE_PRINT: return new_print(get_node(c));
+        case NODE_IF: {
+            ASTNode *cond = get_node(c);
+            return new_if(cond, get_node(c));
+        }
+        case NODE_REPEAT: {
+            const char *var = get_str(c, NULL);
+            ASTNode *start = get_node(c);
+            ASTNode *end = get_node(c);
+            return new_repeat(var, start, end, get_node(c));
+        }
+        case NODE_WHILE: {
+            ASTNode *cond = get_node(c);
+            return new_while(cond, get_node(c));
+        }
+        case NODE_LITERAL:
+            switch (get_u8(c)) {
+                case LITERAL_STRING: return new_literal_string(get_str(c, NULL));
+                case LITERAL_DECIMAL: return new_literal_decimal(get_f64(c));
+                default: return new_literal_number(get_i64(c));
+            }
+        case NODE_VAR_ACCESS: return new_var_access(get_str(c, NULL));
+        case NODE_BINARY_EXPR: {
+            ASTNode *left = get_node(c);
+            uint32_t op = get_u32(c);
+            return new_binary_expr(left, (TokenType)op, get_node(c));
+        }
+        case NODE_CALL_EXPR: {
+            const char *callee = get_str(c, NULL);
+            return new_call_expr(callee, get_node_list(c));
+        }
+        case NODE_LIST: return new_list(get_node_list(c));
+        case NODE_MAP: {
+            ASTNode *keys = get_node_list(c);
+            return new_map(keys, get_node_list(c));
+        }
+        case NODE_INDEX: {
+            ASTNode *target = get_node(c);
+            return new_index(target, get_node(c));
+        }
+        case NODE_INTERP: return new_interp(get_node_list(c));
+        case NODE_FUNC_DECL: {
+            const char *name = get_str(c, NULL);
+            ASTNode *params = get_node_list(c);
+            FuncDeclNode *f = (FuncDeclNode*)new_func_decl(name, params, NULL);
+            get_captures(c, f);
+            f->body = get_node(c);
+            return (ASTNode*)f;
+        }
+        case NODE_RETURN: return new_return(get_node(c));
+    }
+    c->bad = 1;
+    return NULL;
+}
+
+void snapshot_materialize(FuncDeclNode *decl) {
+    Cursor c = {decl->image_body, image_base + image_size, 0};
+    decl->image_body = NULL;
+    ASTNode *body = get_node(&c);
+    if (c.bad || !body || body->type != NODE_BLOCK) {
+        fprintf(stderr, "Runtime Error: Image rusak pada fungsi '%s'.\n", decl->name);
+        if (body) free_ast(body);
+        body = new_block(NULL);
+    }
+    decl->body = body;
+}
+
+void snapshot_materialize_all(void) {
+    for (uint32_t i = 0; i < loaded_count; i++) {
+        if (loaded_functions[i]->image_body) snapshot_materialize(loaded_functions[i]);
+    }
+}
+
+static int load_functions(Cursor *c, uint32_t count) {
+    loaded_functions = malloc(sizeof(FuncDeclNode*) * (count ? count : 1));
+    for (uint32_t i = 0; i < count; i++) {
+        const char *name = get_str(c, NULL);
+        uint32_t param_count = get_u32(c);
+        NodeList params = {NULL, NULL};
+        for (uint32_t p = 0; p < param_count && !c->bad; p++) {
+            node_list_push(&params, new_var_access(get_str(c, NULL)));
+        }
+        FuncDeclNode *f = (FuncDeclNode*)new_func_decl(name, params.head, NULL);
+        get_captures(c, f);
+        uint32_t body_size = get_u32(c);
+        if (c->bad || !need(c, body_size)) {
+            free_ast((ASTNode*)f);
+            return 0;
+        }
+
+        f->image_body = c->p; // Decoded on first call
+        c->p += body_size;
+        loaded_functions[loaded_count++] = f;
+    }
+    return 1;
+}
+
+// Every object exists (and is rooted) before any is filled, so values may
+// refer forward, to each other, or to themselves.
+static int load_objects(Cursor *c, uint32_t count) {
+    loaded_objects = malloc(sizeof(Value) * (count ? count : 1));
+    Cursor *payloads = malloc(sizeof(Cursor) * (count ? count : 1));
+    uint32_t *lengths = malloc(sizeof(uint32_t) * (count ? count : 1));
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t size = get_u32(c);
+        if (!need(c, size)) break;
+        Cursor p = {c->p, c->p + size, 0};
+        c->p += size;
+
+        uint8_t kind = get_u8(&p);
+        int numeric = kind == OBJ_KIND_LIST ? get_u8(&p) : 0;
+        uint32_t n = get_u32(&p);
+        uint32_t function = kind == OBJ_KIND_CLOSURE ? get_u32(&p) : 0;
+        int valid = kind == OBJ_KIND_CLOSURE
+            ? function < loaded_count && (int)n == loaded_functions[function]->capture_count
+            : kind == OBJ_KIND_LIST || kind == OBJ_KIND_MAP;
+        if (p.bad || n > size || !valid) {
+            c->bad = 1; // Every element takes at least a byte
+            break;
+        }
+        payloads[i] = p; // Positioned at the elements
+        lengths[i] = n;
+        if (kind == OBJ_KIND_LIST) loaded_objects[i] = make_list(gc_new_list((int)n, numeric));
+        else if (kind == OBJ_KIND_MAP) loaded_objects[i] = make_map(map_new((int)n));
+        else loaded_objects[i] = make_closure(gc_new_closure((ASTNode*)loaded_functions[function], (int)n));
+        gc_push_root(loaded_objects[i]);
+        object_count++;
+    }
+
+    for (uint32_t i = 0; i < object_count && !c->bad; i++) {
+        Cursor p = payloads[i];
+        if (loaded_objects[i].type == VAL_LIST) {
+            ObjList *list = loaded_objects[i].as.list;
+            for (uint32_t n = 0; n < lengths[i] && !p.bad; n++) {
+                if (list->numeric) list->as.numbers[n] = get_i64(&p);
+                else list->as.items[n] = get_value(&p);
+                list->count++;
+            }
+        } else if (loaded_objects[i].type == VAL_CLOSURE) {
+            ObjClosure *closure = loaded_objects[i].as.closure;
+            for (uint32_t n = 0; n < lengths[i] && !p.bad; n++) {
+                closure->captured[n] = get_value(&p);
+            }
+        } else {
+            ObjMap *map = loaded_objects[i].as.map;
+            for (uint32_t e = 0; e < lengths[i] && !p.bad; e++) {
+                Value key = get_value(&p);
+                gc_push_root(key); // The value may allocate
+                Value value = get_value(&p);
+                if (map_valid_key(key)) map_set(map, key, value);
+                else p.bad = 1;
+                gc_pop_roots(1);
+            }
+        }
+        if (p.bad) c->bad = 1;
+    }
+    free(payloads);
+    free(lengths);
+    return !c->bad;
+}
+
+int snapshot_load(Environment *globals, const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Gagal membuka file: %s\n", path);
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ImageHeader)) {
+        fprintf(stderr, "Image tidak valid: %s\n", path);
+        close(fd);
+        return 1;
+    }
+    void *mem = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        fprintf(stderr, "Gagal memetakan image: %s\n", path);
+        return 1;
+    }
+    image_base = mem;
+    image_size = st.st_size;
+
+    ImageHeader h;
+    memcpy(&h, image_base, sizeof(h));
+    if (memcmp(h.magic, IMAGE_MAGIC, 8) != 0 || h.version != IMAGE_VERSION ||
+        h.token_count != TOKEN_UNKNOWN) {
+        fprintf(stderr, "Image tidak valid atau dari versi lain: %s\n", path);
+        return 1;
+    }
+    if (h.functions_offset > image_size || h.objects_offset > image_size || h.entries_offset > image_size) {
+        fprintf(stderr, "Image rusak: %s\n", path);
+        return 1;
+    }
+
+    const unsigned char *end = image_base + image_size;
+    Cursor functions = {image_base + h.functions_offset, image_base + h.objects_offset, 0};
+    Cursor objects = {image_base + h.objects_offset, image_base + h.entries_offset, 0};
+    Cursor entries = {image_base + h.entries_offset, end, 0};
+
+    int ok = load_functions(&functions, h.function_count) &&
+             load_objects(&objects, h.object_count);
+    for (uint32_t i = 0; ok && i < h.entry_count; i++) {
+        const char *key = get_str(&entries, NULL);
+        Value value = get_value(&entries);
+        if (entries.bad) break;
+        env_push(globals, key, value); // Keys are unique within an image
+    }
+    gc_pop_roots(object_count);
+    free(loaded_objects);
+    loaded_objects = NULL;
+    object_count = 0;
+
+    if (!ok || entries.bad) {
+        fprintf(stderr, "Image rusak: %s\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+void snapshot_close(void) {
+    for (uint32_t i = 0; i < loaded_count; i++) free_ast((ASTNode*)loaded_functions[i]);
+    free(loaded_functions);
+    loaded_functions = NULL;
+    loaded_count = 0;
+
+    if (image_base) munmap((void*)image_base, image_size);
+    image_base = NULL;
+    image_size = 0;
+}
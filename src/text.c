@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <string.h>
+#include "text.h"
+#include "builtins.h"
+#include "gc.h"
+#include "list.h"
+#include "scan.h"
+
+// --- Argument checks ---
+
+static int expect_strings(const char *name, Value *args, int argc, int expected) {
+    if (argc != expected) {
+        fprintf(stderr, "Runtime Error: '%s' expects %d argument(s), got %d.\n", name, expected, argc);
+        return 0;
+    }
+    for (int i = 0; i < argc; i++) {
+        if (args[i].type != VAL_STRING) {
+            fprintf(stderr, "Runtime Error: '%s' expects strings.\n", name);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int expect_needle(const char *name, Value needle) {
+    if (string_length(&needle) == 0) {
+        fprintf(stderr, "Runtime Error: '%s' expects a non-empty search string.\n", name);
+        return 0;
+    }
+    return 1;
+}
+
+// s[offset, offset + length) as a value; 's' must be rooted (in args[]).
+// An inline source only ever yields pieces short enough to inline.
+static Value piece(Value *s, size_t offset, size_t length) {
+    if (s->inline_len) return make_string_n(string_chars(s) + offset, length);
+    return make_string_slice(s->as.string, offset, length);
+}
+
+static size_t count_matches(const char *s, size_t s_len, const char *t, size_t t_len) {
+    size_t count = 0;
+    for (size_t pos = 0; (pos = scan_find(s, pos, s_len, t, t_len)) < s_len; pos += t_len) count++;
+    return count;
+}
+
+// --- Search ---
+
+// cari(s, t): index of the first t in s, -1 when there is none
+static int bi_cari(Value *args, int argc, Value *out) {
+    if (!expect_strings("cari", args, argc, 2)) return 0;
+    size_t s_len = string_length(&args[0]);
+    size_t t_len = string_length(&args[1]);
+    size_t at = scan_find(string_chars(&args[0]), 0, s_len, string_chars(&args[1]), t_len);
+    *out = make_number(at < s_len || t_len == 0 ? (int64_t)at : -1);
+    return 1;
+}
+
+// hitung_teks(s, t): occurrences of t in s, counted left to right without overlap
+static int bi_hitung_teks(Value *args, int argc, Value *out) {
+    if (!expect_strings("hitung_teks", args, argc, 2) || !expect_needle("hitung_teks", args[1])) return 0;
+    *out = make_number((int64_t)count_matches(string_chars(&args[0]), string_length(&args[0]),
+                                              string_chars(&args[1]), string_length(&args[1])));
+    return 1;
+}
+
+static int bi_diawali(Value *args, int argc, Value *out) {
+    if (!expect_strings("diawali", args, argc, 2)) return 0;
+    size_t s_len = string_length(&args[0]);
+    size_t t_len = string_length(&args[1]);
+    *out = make_number(t_len <= s_len && memcmp(string_chars(&args[0]), string_chars(&args[1]), t_len) == 0);
+    return 1;
+}
+
+static int bi_diakhiri(Value *args, int argc, Value *out) {
+    if (!expect_strings("diakhiri", args, argc, 2)) return 0;
+    size_t s_len = string_length(&args[0]);
+    size_t t_len = string_length(&args[1]);
+    *out = make_number(t_len <= s_len &&
+                       memcmp(string_chars(&args[0]) + s_len - t_len, string_chars(&args[1]), t_len) == 0);
+    return 1;
+}
+
+// setara(a, b): equal when A-Z and a-z are taken as the same letters
+static int bi_setara(Value *args, int argc, Value *out) {
+    if (!expect_strings("setara", args, argc, 2)) return 0;
+    size_t length = string_length(&args[0]);
+    *out = make_number(length == string_length(&args[1]) &&
+                       scan_equal_fold(string_chars(&args[0]), string_chars(&args[1]), length));
+    return 1;
+}
+
+// --- Building ---
+
+// pisah(s, delim): list of fields, as views into s or inline strings
+static int bi_pisah(Value *args, int argc, Value *out) {
+    if (!expect_strings("pisah", args, argc, 2) || !expect_needle("pisah", args[1])) return 0;
+    // Both stay in args[], so chars of an inline string remain valid
+    const char *s = string_chars(&args[0]);
+    size_t s_len = string_length(&args[0]);
+    const char *delim = string_chars(&args[1]);
+    size_t delim_len = string_length(&args[1]);
+
+    ObjList *fields = list_new(0);
+    gc_push_root(make_list(fields)); // 's' is rooted through args[]
+
+    size_t pos = 0;
+    for (;;) {
+        size_t hit = scan_find(s, pos, s_len, delim, delim_len);
+        list_append(fields, piece(&args[0], pos, hit - pos));
+        if (hit == s_len) break;
+        pos = hit + delim_len;
+    }
+
+    gc_pop_roots(1);
+    *out = make_list(fields);
+    return 1;
+}
+
+// ganti(s, lama, baru): every 'lama' in s, left to right, replaced by
+// 'baru'. Built in one allocation, and s itself when 'lama' does not occur.
+static int bi_ganti(Value *args, int argc, Value *out) {
+    if (!expect_strings("ganti", args, argc, 3) || !expect_needle("ganti", args[1])) return 0;
+    const char *s = string_chars(&args[0]);
+    size_t s_len = string_length(&args[0]);
+    const char *from = string_chars(&args[1]);
+    size_t from_len = string_length(&args[1]);
+    const char *to = string_chars(&args[2]);
+    size_t to_len = string_length(&args[2]);
+
+    size_t count = count_matches(s, s_len, from, from_len);
+    if (count == 0) {
+        *out = args[0];
+        return 1;
+    }
+
+    size_t total = s_len - count * from_len + count * to_len;
+    char small[VALUE_INLINE_MAX];
+    ObjString *result = total > VALUE_INLINE_MAX ? gc_alloc_string(total) : NULL; // Arguments are rooted
+    char *dst = result ? result->chars : small;
+    size_t pos = 0;
+    for (size_t hit; (hit = scan_find(s, pos, s_len, from, from_len)) < s_len; pos = hit + from_len) {
+        memcpy(dst, s + pos, hit - pos);
+        dst += hit - pos;
+        memcpy(dst, to, to_len);
+        dst += to_len;
+    }
+    memcpy(dst, s + pos, s_len - pos);
+
+    *out = result ? make_string_obj(result) : make_string_n(small, total);
+    return 1;
+}
+
+static int is_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// pangkas(s): s without leading and trailing whitespace, as a view
+static int bi_pangkas(Value *args, int argc, Value *out) {
+    if (!expect_strings("pangkas", args, argc, 1)) return 0;
+    const char *s = string_chars(&args[0]);
+    size_t end = string_length(&args[0]);
+    int lines = 0;
+    size_t start = scan_whitespace(s, 0, end, &lines);
+    while (end > start && is_space((unsigned char)s[end - 1])) end--;
+    *out = start == 0 && end == string_length(&args[0]) ? args[0] : piece(&args[0], start, end - start);
+    return 1;
+}
+
+void text_init(void) {
+    scan_init();
+    native_register("cari", bi_cari);
+    native_register("hitung_teks", bi_hitung_teks);
+    native_register("diawali", bi_diawali);
+    native_register("diakhiri", bi_diakhiri);
+    native_register("setara", bi_setara);
+    native_register("pisah", bi_pisah);
+    native_register("ganti", bi_ganti);
+    native_register("pangkas", bi_pangkas);
+}
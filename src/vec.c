@@ -0,0 +1,68 @@
+#include "vec.h"
+
+// The sum is kept exact in three overflow-free accumulators: the high and
+// low 32-bit halves of every element read as unsigned, and the number of
+// negative elements (each of which the unsigned reading overstates by 2^64).
+// With n < 2^31 none of them can wrap.
+int vec_sum(const int64_t *xs, int n, int64_t *out, double *approx) {
+    uint64_t high = 0, low = 0, negative = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t x = (uint64_t)xs[i];
+        high += x >> 32;
+        low += x & 0xFFFFFFFFu;
+        negative += x >> 63;
+    }
+    __int128 total = ((__int128)high << 32) + (__int128)low - ((__int128)negative << 64);
+    if (total < INT64_MIN || total > INT64_MAX) {
+        *approx = (double)total;
+        return 0;
+    }
+    *out = (int64_t)total;
+    return 1;
+}
+
+int64_t vec_min(const int64_t *xs, int n) {
+    int64_t m = xs[0];
+    for (int i = 1; i < n; i++) {
+        m = xs[i] < m ? xs[i] : m;
+    }
+    return m;
+}
+
+int64_t vec_max(const int64_t *xs, int n) {
+    int64_t m = xs[0];
+    for (int i = 1; i < n; i++) {
+        m = xs[i] > m ? xs[i] : m;
+    }
+    return m;
+}
+
+int vec_count_eq(const int64_t *xs, int n, int64_t value) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        count += xs[i] == value;
+    }
+    return count;
+}
+
+// Overflow flags are OR-ed rather than branched on, keeping the loop
+// straight-line
+int vec_scale(int64_t *restrict dst, const int64_t *restrict src, int n, int64_t factor) {
+    int overflow = 0;
+    for (int i = 0; i < n; i++) {
+        overflow |= __builtin_mul_overflow(src[i], factor, &dst[i]);
+    }
+    return !overflow;
+}
+
+int vec_dot(const int64_t *xs, const int64_t *ys, int n, int64_t *out) {
+    int64_t acc = 0;
+    int overflow = 0;
+    for (int i = 0; i < n; i++) {
+        int64_t product;
+        overflow |= __builtin_mul_overflow(xs[i], ys[i], &product);
+        overflow |= __builtin_add_overflow(acc, product, &acc);
+    }
+    *out = acc;
+    return !overflow;
+}